@@ -0,0 +1,215 @@
+#include <boost/program_options.hpp>
+
+#include "../src/json_loader.h"
+#include "../src/random.h"
+#include "../src/tick_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+ *  Замер стоимости тика без HTTP-сервера и базы данных: загружает конфигурацию игры,
+ *  заводит на каждой карте заданное число собак и гоняет Game::UpdateGameState,
+ *  случайно меняя направление собак между тиками.
+ */
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    std::string config;
+    unsigned dogs_per_map = 1000;
+    unsigned ticks = 1000;
+    int tick_period = 50;
+    // Вероятность, что собака сменит направление (или остановится) перед тиком
+    double turn_probability = 0.05;
+    unsigned sim_threads = 1;
+    std::size_t max_players_per_session = 0;
+    std::uint64_t seed = 1;
+    // Писать тики в TickProfiler, как сервер с --tick-stats
+    bool tick_stats = false;
+};
+
+// Время фаз за весь прогон, мс
+struct PhaseTotals {
+    double spawn = 0.0;
+    double move = 0.0;
+    double collect = 0.0;
+    double retire = 0.0;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+    po::options_description desc{"Allowed options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value(&args.config)->value_name("file"s), "set config file path")
+        ("dogs", po::value(&args.dogs_per_map)->value_name("count"s), "set number of dogs per map")
+        ("ticks", po::value(&args.ticks)->value_name("count"s), "set number of ticks")
+        ("tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"s), "set tick period")
+        ("turn-probability", po::value(&args.turn_probability)->value_name("p"s), "set probability that a dog changes direction before a tick")
+        ("sim-threads", po::value(&args.sim_threads)->value_name("count"s), "set number of threads to compute game tick")
+        ("max-players-per-session", po::value(&args.max_players_per_session)->value_name("count"s), "set max number of players in one session instance of a map")
+        ("seed", po::value(&args.seed)->value_name("number"s), "set seed of random number generators")
+        ("tick-stats", po::bool_switch(&args.tick_stats), "record ticks in the tick profiler as the server does");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config files have not been specified"s);
+    }
+    return args;
+}
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double Percentile(std::vector<double> sorted_values, double p) {
+    if (sorted_values.empty()) {
+        return 0.0;
+    }
+    const std::size_t idx = std::min(sorted_values.size() - 1, static_cast<std::size_t>(p * (sorted_values.size() - 1) + 0.5));
+    return sorted_values[idx];
+}
+
+void SpawnDogs(model::Game& game, unsigned dogs_per_map, rng::Xoshiro256& random) {
+    for (const auto& map : game.GetMaps()) {
+        for (unsigned i = 0; i < dogs_per_map; ++i) {
+            GameSession* session = game.FindJoinableSession(*map.GetId());
+            LostObjectPosition spawn_point;
+            map.SampleRoadPoints(random, std::span{&spawn_point, 1});
+            // Имена уникальны: ушедшие игроки собираются по имени
+            game.AddPlayerToSession(*map.GetId() + "_dog_"s + std::to_string(i), *session, spawn_point.x, spawn_point.y,
+                                    map.GetRoadIndex().FindRoadAt(spawn_point.x, spawn_point.y));
+        }
+    }
+}
+
+// Как Application::MakePlayerAction: четыре направления со скоростью карты или остановка
+void TurnDogs(model::Game& game, double turn_probability, rng::Xoshiro256& random) {
+    for (auto& session : *game.GetSessions()) {
+        const double speed = session.GetMap()->GetSpeed();
+        for (auto& [id, dog] : *session.GetDogs()) {
+            if (random.NextDouble() >= turn_probability) {
+                continue;
+            }
+            switch (random.NextInt(0, 4)) {
+            case 0:
+                dog->SetSpeedAndDirection(DogSpeed{-speed, .0}, Direction::WEST);
+                break;
+            case 1:
+                dog->SetSpeedAndDirection(DogSpeed{speed, .0}, Direction::EAST);
+                break;
+            case 2:
+                dog->SetSpeedAndDirection(DogSpeed{.0, -speed}, Direction::NORTH);
+                break;
+            case 3:
+                dog->SetSpeedAndDirection(DogSpeed{.0, speed}, Direction::SOUTH);
+                break;
+            default:
+                dog->SetSpeedAndDirection(DogSpeed{.0, .0}, Direction{});
+                break;
+            }
+        }
+    }
+}
+
+void PrintReport(const Args& args, const model::Game& game, std::vector<double> tick_times, const PhaseTotals& phases,
+                 std::size_t retired) {
+    // Пропускная способность считается по времени самих тиков, без смены направлений между ними
+    const double total_ms = std::accumulate(tick_times.begin(), tick_times.end(), 0.0);
+    std::sort(tick_times.begin(), tick_times.end());
+    const double ticks = static_cast<double>(tick_times.size());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "maps: " << game.GetMaps().size() << ", dogs per map: " << args.dogs_per_map
+              << ", ticks: " << tick_times.size() << ", tick period: " << args.tick_period << " ms"
+              << ", sim threads: " << args.sim_threads << ", tick stats: " << (args.tick_stats ? "on" : "off") << '\n';
+    std::cout << "ticks per second: " << (total_ms > 0.0 ? ticks * 1000.0 / total_ms : 0.0) << '\n';
+    std::cout << "tick time, ms: p50 " << Percentile(tick_times, 0.5) << ", p99 " << Percentile(tick_times, 0.99)
+              << ", max " << (tick_times.empty() ? 0.0 : tick_times.back()) << '\n';
+    std::cout << "phase time per tick, ms: spawn " << phases.spawn / ticks << ", move " << phases.move / ticks
+              << ", collect " << phases.collect / ticks << ", retire " << phases.retire / ticks << '\n';
+    std::cout << "retired players: " << retired << '\n';
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+        rng::SetSeed(args->seed);
+        rng::Xoshiro256 random = rng::MakeStream(rng::StreamId("game_sim_bench"));
+
+        model::Game game;
+        json_loader::LoadGame(game, std::filesystem::path(args->config));
+        game.SetSimulationThreads(args->sim_threads);
+        game.SetMaxPlayersPerSession(args->max_players_per_session);
+        SpawnDogs(game, args->dogs_per_map, random);
+        std::optional<TickProfiler> profiler;
+        if (args->tick_stats) {
+            profiler.emplace();
+        }
+
+        std::vector<double> tick_times;
+        tick_times.reserve(args->ticks);
+        PhaseTotals phases;
+        std::size_t retired = 0;
+        for (unsigned tick = 0; tick < args->ticks; ++tick) {
+            TurnDogs(game, args->turn_probability, random);
+
+            const auto start = Clock::now();
+            game.UpdateGameState(args->tick_period);
+            const auto updated = Clock::now();
+            retired += game.RetirePlayers().size();
+            if (profiler) {
+                // Запись профиля входит во время тика, как в Application::TickSession
+                for (const auto& session : *game.GetSessions()) {
+                    profiler->GetSessionProfile(session).RecordTick(session.GetLastTickPhases(), session.GetDogsCount(),
+                                                                    session.GetMovingDogsCount(),
+                                                                    session.GetLostObjectsCount(),
+                                                                    session.GetPlayersCount());
+                }
+            }
+            const auto finished = Clock::now();
+
+            tick_times.push_back(ToMilliseconds(finished - start));
+            phases.retire += ToMilliseconds(finished - updated);
+            for (const auto& session : *game.GetSessions()) {
+                const TickPhaseTimes& session_phases = session.GetLastTickPhases();
+                phases.spawn += session_phases.spawn;
+                phases.move += session_phases.move;
+                phases.collect += session_phases.collect;
+            }
+        }
+        PrintReport(*args, game, std::move(tick_times), phases, retired);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
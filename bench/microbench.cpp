@@ -0,0 +1,309 @@
+#include <benchmark/benchmark.h>
+
+#include "../src/collision_detector.h"
+#include "../src/json_loader.h"
+#include "../src/request_handler.h"
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+ *  Микробенчмарки горячих функций модели и сериализации.
+ *  Результаты в машиночитаемом виде для сравнения прогонов:
+ *      game_server_microbench --benchmark_out=result.json --benchmark_out_format=json
+ *  Аргументы бенчмарков — размер данных (число дорог, собак, вещей, игроков).
+ */
+
+using namespace std::literals;
+
+namespace {
+
+const std::uint64_t SEED = 1;
+const int TICK_PERIOD = 50;
+const int ROAD_STEP = 10;
+
+Loot MakeLoot(std::string name, int value) {
+    return Loot{boost::json::object{{"name", std::move(name)}, {"file", "assets/loot.obj"}, {"type", "obj"},
+                                    {"rotation", 0}, {"color", "#338844"}, {"scale", 0.03}, {"value", value}}};
+}
+
+// Сетка из roads_count дорог: половина горизонтальных, половина вертикальных, с шагом ROAD_STEP.
+// На каждом втором перекрёстке диагонали стоит офис, в каждой клетке вдоль диагонали — здание.
+Map MakeGridMap(int roads_count, int bag_capacity = 3) {
+    const int lines = std::max(1, roads_count / 2);
+    const int length = (lines - 1) * ROAD_STEP;
+
+    Map map{Map::Id{"grid_"s + std::to_string(roads_count)}, "Grid"s, 3.0, bag_capacity};
+    map.AddLootTypes(MakeLoot("key"s, 10));
+    map.AddLootTypes(MakeLoot("wallet"s, 30));
+    for (int i = 0; i < lines; ++i) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i * ROAD_STEP}, length});
+        map.AddRoad(Road{Road::VERTICAL, Point{i * ROAD_STEP, 0}, length});
+    }
+    for (int i = 0; i + 1 < lines; ++i) {
+        map.AddBuilding(Building{Rectangle{Point{i * ROAD_STEP + 2, i * ROAD_STEP + 2}, Size{ROAD_STEP - 4, ROAD_STEP - 4}}});
+    }
+    for (int i = 0; i < lines; i += 2) {
+        map.AddOffice(Office{Office::Id{"o"s + std::to_string(i)}, Point{i * ROAD_STEP, i * ROAD_STEP}, Offset{5, 0}});
+    }
+    map.BuildIndexes(model::OFFICE_REACH);
+    return map;
+}
+
+// Игра с одной картой-сеткой и одной сессией, в которой dogs_count собак и loot_count вещей
+struct GridGame {
+    GridGame(int roads_count, int dogs_count, int loot_count, int bag_capacity = 3) {
+        rng::SetSeed(SEED);
+        game.AddMap(MakeGridMap(roads_count, bag_capacity));
+        const Map& map = game.GetMaps().front();
+        session = game.FindJoinableSession(*map.GetId());
+
+        std::vector<LostObjectPosition> points(dogs_count + loot_count);
+        map.SampleRoadPoints(session->GetRandom(), points);
+        for (int i = 0; i < dogs_count; ++i) {
+            const auto [x, y] = points[i];
+            auto [player, token] = game.AddPlayerToSession("dog_"s + std::to_string(i), *session, x, y,
+                                                           map.GetRoadIndex().FindRoadAt(x, y));
+            tokens.push_back(std::move(token));
+        }
+        for (int i = 0; i < loot_count; ++i) {
+            const auto [x, y] = points[dogs_count + i];
+            session->AddLostObject(x, y, const_cast<Map&>(map).GetLootTypeByPos(i % 2));
+        }
+    }
+
+    // Разгоняет собак в случайных направлениях вдоль их дорог
+    void StartDogs() {
+        const double speed = session->GetMap()->GetSpeed();
+        auto& random = session->GetRandom();
+        for (auto& [id, dog] : *session->GetDogs()) {
+            const double sign = random.NextInt(0, 1) == 0 ? -1.0 : 1.0;
+            const Road& road = session->GetMap()->GetRoads()[dog->GetRoadId()];
+            if (road.IsHorizontal()) {
+                dog->SetSpeedAndDirection(DogSpeed{sign * speed, .0}, sign < 0 ? Direction::WEST : Direction::EAST);
+            } else {
+                dog->SetSpeedAndDirection(DogSpeed{.0, sign * speed}, sign < 0 ? Direction::NORTH : Direction::SOUTH);
+            }
+        }
+    }
+
+    model::Game game;
+    GameSession* session = nullptr;
+    std::vector<Token> tokens;
+};
+
+//! ------ collision_detector ------
+
+void BM_TryCollectPoint(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    rng::Xoshiro256 random{SEED};
+    std::vector<LostObjectPosition> points(count);
+    for (auto& point : points) {
+        point = LostObjectPosition{random.NextDouble(-10.0, 10.0), random.NextDouble(-1.0, 1.0)};
+    }
+    const DogPosition a{-5.0, 0.0};
+    const DogPosition b{5.0, 0.0};
+
+    for (auto _ : state) {
+        for (const auto& point : points) {
+            benchmark::DoNotOptimize(model::collision_detector::TryCollectPoint(a, b, point));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_TryCollectPoint)->RangeMultiplier(8)->Range(8, 4096);
+
+// Пакетная проверка тех же точек — для сравнения со скалярной
+void BM_TryCollectPoints(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    rng::Xoshiro256 random{SEED};
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    random.FillDoubles(xs, -10.0, 10.0);
+    random.FillDoubles(ys, -1.0, 1.0);
+    std::vector<double> proj_ratios(count);
+    std::vector<double> sq_distances(count);
+
+    for (auto _ : state) {
+        model::collision_detector::TryCollectPoints(DogPosition{-5.0, 0.0}, DogPosition{5.0, 0.0}, xs, ys, proj_ratios, sq_distances);
+        benchmark::DoNotOptimize(proj_ratios.data());
+        benchmark::DoNotOptimize(sq_distances.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_TryCollectPoints)->RangeMultiplier(8)->Range(8, 4096);
+
+//! ------ Dog::Move ------
+
+// Аргумент — число дорог карты. За итерацию сдвигаются 1024 собаки.
+// Упёршаяся в край дороги собака возвращается в начальную точку и снова разгоняется.
+void BM_DogMove(benchmark::State& state) {
+    const int dogs_count = 1024;
+    GridGame grid{static_cast<int>(state.range(0)), dogs_count, 0};
+    grid.StartDogs();
+
+    const Map& map = *grid.session->GetMap();
+    std::deque<Dog>& dogs = grid.session->GetDogsList();
+    std::vector<DogPosition> start_pos;
+    std::vector<DogSpeed> start_speed;
+    std::vector<Direction> start_dir;
+    std::vector<std::size_t> start_road;
+    for (const auto& dog : dogs) {
+        start_pos.push_back(dog.GetPosition());
+        start_speed.push_back(dog.GetSpeed());
+        start_dir.push_back(dog.GetDirection());
+        start_road.push_back(dog.GetRoadId());
+    }
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < dogs.size(); ++i) {
+            Dog& dog = dogs[i];
+            dog.Move(TICK_PERIOD, map);
+            if (dog.GetSpeed().x == .0 && dog.GetSpeed().y == .0) {
+                dog.SetPosition(start_pos[i]);
+                dog.SetRoadId(start_road[i]);
+                dog.SetSpeedAndDirection(start_speed[i], start_dir[i]);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * dogs_count);
+}
+BENCHMARK(BM_DogMove)->RangeMultiplier(4)->Range(4, 1024);
+
+//! ------ Game::CollectLostObjects ------
+
+// Аргументы — число собак и число вещей. Собаки сделали один шаг тика.
+// Вместимость рюкзака 0: вещи не подбираются, поэтому сессия между итерациями не меняется
+// и замеряется поиск событий сбора, а не изменение состояния.
+void BM_CollectLostObjects(benchmark::State& state) {
+    GridGame grid{64, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 0};
+    grid.StartDogs();
+    grid.session->MoveDogs(TICK_PERIOD);
+
+    for (auto _ : state) {
+        grid.game.CollectLostObjects(*grid.session);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollectLostObjects)->ArgsProduct({{10, 100, 1000}, {10, 100, 1000}});
+
+//! ------ Serialization ------
+
+// Тело ответа /api/v1/game/state, аргумент — число собак (вещей столько же)
+void BM_SerializeSessionState(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    GridGame grid{64, count, count};
+    grid.StartDogs();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(json_loader::GetSerializedSessionState(*grid.session));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SerializeSessionState)->RangeMultiplier(10)->Range(10, 10000);
+
+// Тело ответа /api/v1/maps/{id}, аргумент — число дорог
+void BM_GetSerializedMap(benchmark::State& state) {
+    const Map map = MakeGridMap(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(json_loader::GetSerializedMap(map));
+    }
+}
+BENCHMARK(BM_GetSerializedMap)->RangeMultiplier(8)->Range(8, 4096);
+
+//! ------ PlayerTokens ------
+
+// Аргумент — число выданных токенов; ищутся существующие токены вразбивку
+void BM_FindPlayerByToken(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::deque<Player> players;
+    PlayerTokens tokens;
+    std::vector<Token> issued;
+    issued.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        players.emplace_back(nullptr, nullptr);
+        issued.push_back(tokens.AddPlayer(players.back()));
+    }
+    rng::Xoshiro256 random{SEED};
+    std::vector<int> order(1024);
+    random.FillInts(order, 0, static_cast<int>(count) - 1);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tokens.FindPlayerByToken(issued[order[i++ % order.size()]]));
+    }
+}
+BENCHMARK(BM_FindPlayerByToken)->RangeMultiplier(10)->Range(10, 1000000);
+
+//! ------ SerializationListener ------
+
+std::filesystem::path GetStatePath() {
+    return std::filesystem::temp_directory_path() / "game_server_microbench.state";
+}
+
+// Снимок сессии в том же виде, что Application::MakeSessionSnapshot
+std::vector<SessionSnapshot> MakeSnapshots(GridGame& grid) {
+    SessionSnapshot snapshot;
+    snapshot.map_id = *grid.session->GetMap()->GetId();
+    snapshot.instance = grid.session->GetInstance();
+    for (const auto& [id, lost_obj] : grid.session->GetLostObjects()) {
+        snapshot.lost_objects[id] = LostObjectRepr{lost_obj.pos, lost_obj.loot->GetLootType()};
+    }
+    for (const auto& [id, dog] : *grid.session->GetDogs()) {
+        if (auto token = grid.game.GetPlayers()->FindTokenByDog(dog)) {
+            snapshot.tokens_dog[**token] = DogRepr{*dog};
+        }
+    }
+    return {std::move(snapshot)};
+}
+
+// Аргумент — число собак (вещей столько же). Состояние пишется во временный файл.
+void BM_SaveState(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    GridGame grid{64, count, count};
+    const auto snapshots = MakeSnapshots(grid);
+    auto listener = std::make_shared<http_handler::SerializationListener>();
+    listener->SetPathToSaveFile(GetStatePath().string());
+
+    for (auto _ : state) {
+        listener->SaveState(snapshots);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::filesystem::remove(GetStatePath());
+}
+BENCHMARK(BM_SaveState)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+// Загрузка сохранённого BM_SaveState состояния в новую игру с той же картой
+void BM_LoadState(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto listener = std::make_shared<http_handler::SerializationListener>();
+    listener->SetPathToSaveFile(GetStatePath().string());
+    {
+        GridGame grid{64, count, count};
+        listener->SaveState(MakeSnapshots(grid));
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto game = std::make_unique<model::Game>();
+        game->AddMap(MakeGridMap(64));
+        state.ResumeTiming();
+
+        listener->LoadState(game.get());
+
+        state.PauseTiming();
+        game.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::filesystem::remove(GetStatePath());
+}
+BENCHMARK(BM_LoadState)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,62 @@
+#include "alias_table.h"
+
+#include <algorithm>
+
+AliasTable::AliasTable(std::span<const double> weights)
+    : probability_(weights.size(), 1.0),
+    alias_(weights.size())
+{
+    const std::size_t n = weights.size();
+    double total = 0.0;
+    for (double weight : weights) {
+        total += std::max(weight, 0.0);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        alias_[i] = static_cast<std::uint32_t>(i);
+    }
+    if (n == 0 || total <= 0.0) {
+        return;
+    }
+
+    // Веса нормируются так, что средняя ячейка равна 1; недополненные ячейки
+    // добираются из переполненных
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small;
+    std::vector<std::uint32_t> large;
+    for (std::size_t i = 0; i < n; ++i) {
+        scaled[i] = std::max(weights[i], 0.0) * static_cast<double>(n) / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t s = small.back();
+        small.pop_back();
+        const std::uint32_t l = large.back();
+        probability_[s] = scaled[s];
+        alias_[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Остатки из-за погрешности округления заполняют ячейку целиком
+    for (std::uint32_t i : large) {
+        probability_[i] = 1.0;
+    }
+    for (std::uint32_t i : small) {
+        probability_[i] = 1.0;
+    }
+}
+
+std::size_t AliasTable::Size() const noexcept {
+    return probability_.size();
+}
+
+bool AliasTable::Empty() const noexcept {
+    return probability_.empty();
+}
+
+std::size_t AliasTable::Sample(rng::Xoshiro256& random) const noexcept {
+    const std::size_t column = static_cast<std::size_t>(random.NextInt(0, static_cast<int>(probability_.size()) - 1));
+    return random.NextDouble() < probability_[column] ? column : alias_[column];
+}
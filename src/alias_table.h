@@ -0,0 +1,31 @@
+#pragma once
+
+#include "random.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ *  Таблица псевдонимов (метод Уолкера—Воуза) для выбора индекса с вероятностью,
+ *  пропорциональной его весу. Строится за O(n) один раз, выбор стоит O(1):
+ *  одно случайное число указывает ячейку, второе — взять её индекс или псевдоним.
+ */
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    // Отрицательные веса считаются нулевыми. Если все веса нулевые, выбор равномерный.
+    explicit AliasTable(std::span<const double> weights);
+
+    std::size_t Size() const noexcept;
+
+    bool Empty() const noexcept;
+
+    std::size_t Sample(rng::Xoshiro256& random) const noexcept;
+
+private:
+    // Вероятность остаться в ячейке; иначе выбирается alias_[i]
+    std::vector<double> probability_;
+    std::vector<std::uint32_t> alias_;
+};
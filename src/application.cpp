@@ -1,5 +1,18 @@
 #include "application.h"
-#include "application.h"
+#include "metrics.h"
+
+#include <chrono>
+#include <random>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
 
 //! ------------------------- Application --------------------------------
 
@@ -19,30 +32,32 @@ Player* Application::FindPlayerByToken(const Token token) {
     return const_cast<Players*>(game_->GetPlayers())->FindByToken(token);
 }
 
-std::pair<Player*, Token> Application::JoinPlayer(std::string& username, std::string& map_id) {
-    auto roads = game_->FindMap(Map::Id{map_id})->GetRoads();
+GameSession* Application::FindJoinableSession(const std::string& map_id) {
+    return game_->FindJoinableSession(map_id);
+}
+
+std::pair<Player*, Token> Application::JoinPlayer(std::string& username, GameSession& session) {
+    const Map* map = session.GetMap();
+    const auto& roads = map->GetRoads();
     double start_x, start_y;
-    Road* road_to_move = nullptr;
     if (is_random_spawn_set_) {
-        int r_road = sdk::GetRandomInt(0, roads.size());
-        auto start = roads[r_road].GetStart();
-        auto end = roads[r_road].GetEnd();
-        road_to_move = &roads[r_road];
-
-        auto [min_x, max_x] = sdk::GetMinMax(start.x, end.x);
-        auto [min_y, max_y] = sdk::GetMinMax(start.y, end.y);
-
-        start_x = sdk::GetRandomDouble(min_x, max_x);
-        start_y = sdk::GetRandomDouble(min_y, max_y);
+        // Вход выполняется в strand сессии, поэтому её поток случайных чисел не делится с другими.
+        // Точка выбирается равномерно по длине дорог, как и для потерянных вещей.
+        LostObjectPosition spawn_point;
+        map->SampleRoadPoints(session.GetRandom(), std::span{&spawn_point, 1});
+        start_x = spawn_point.x;
+        start_y = spawn_point.y;
     } else {
         start_x = roads.begin()->GetStart().x;
         start_y = roads.begin()->GetStart().y;
-        road_to_move = &*roads.begin();
     }
-    return game_->AddPlayerToSession(username, map_id, start_x, start_y, road_to_move); 
+    // Дорогу под точкой появления берём из индекса дорог карты
+    std::size_t road_id = map->GetRoadIndex().FindRoadAt(start_x, start_y);
+    return game_->AddPlayerToSession(username, session, start_x, start_y, road_id); 
 }
 
 void Application::MakePlayerAction(Player* player, std::string dir) {
+    player->GetSession()->MarkDogChanged(player->GetDog()->GetId());
     if (dir == "") {
         player->GetDog()->SetSpeedAndDirection(DogSpeed{.0, .0}, Direction{});
     } else {
@@ -69,13 +84,48 @@ void Application::MakePlayerAction(Player* player, std::string dir) {
     }
 }
 
+std::shared_ptr<const StateSnapshot> Application::GetStateSnapshot(GameSession& session) {
+    if (const auto& snapshot = session.GetStateSnapshot()) {
+        return snapshot;
+    }
+    auto snapshot = std::make_shared<const StateSnapshot>(StateSnapshot{
+        .tick = session.GetTick(),
+        .body = json_loader::GetSerializedSessionState(session)
+    });
+    session.SetStateSnapshot(snapshot);
+    return snapshot;
+}
+
+std::uint64_t Application::GetStateEpoch() const noexcept {
+    return state_epoch_;
+}
+
+std::uint64_t Application::MakeStateEpoch() {
+    std::random_device random;
+    const std::uint64_t value = (static_cast<std::uint64_t>(random()) << 32) | random();
+    return value ^ static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+std::shared_ptr<const StateSnapshot> Application::GetStateChanges(GameSession& session, std::uint64_t since) {
+    if (auto snapshot = session.FindChangesSnapshot(since)) {
+        return snapshot;
+    }
+    const auto changes = session.GetChangesSince(since);
+    if (!changes) {
+        return nullptr;
+    }
+    auto snapshot = std::make_shared<const StateSnapshot>(StateSnapshot{
+        .tick = session.GetTick(),
+        .since = since,
+        .body = json_loader::GetSerializedSessionChanges(session, *changes)
+    });
+    session.AddChangesSnapshot(snapshot);
+    return snapshot;
+}
+
 void Application::UpdateState(int tick) {
-    game_->UpdateGameState(tick);
-    auto retire_players = game_->RetirePlayers();
-    if (retire_players.size() != 0) {
-        for (const auto& [name, score_play_time] : retire_players) {
-            db_.Save(name, score_play_time.first, score_play_time.second);
-        }
+    for (auto& session : *game_->GetSessions()) {
+        TickSession(session, tick);
     }
 }
 
@@ -100,20 +150,111 @@ void Application::SetApplicationListener(std::shared_ptr<ApplicationListener> li
     listener_ = listener;
 }
 
+void Application::SetTickProfiler(std::shared_ptr<TickProfiler> profiler)
+{
+    profiler_ = std::move(profiler);
+}
+
+const TickProfiler* Application::GetTickProfiler() const noexcept
+{
+    return profiler_.get();
+}
+
 void Application::Tick(double delta)
 {
     UpdateState(delta);
-    if(listener_) {
-        listener_->OnTick(delta, game_);
+    if (AdvanceGameTime(delta)) {
+        SaveState();
+    }
+}
+
+void Application::TickSession(GameSession& session, double delta)
+{
+    static metrics::Histogram& tick_duration = metrics::GetRegistry().GetHistogram("game_tick_duration_seconds",
+        "Time to compute one tick of a session, including retirement and database writes");
+
+    const auto start = Clock::now();
+    game_->UpdateSession(session, delta);
+    const auto updated = Clock::now();
+    auto retire_players = game_->RetirePlayers(session);
+    const auto retired = Clock::now();
+    for (const auto& [name, score_play_time] : retire_players) {
+        db_.Save(name, score_play_time.first, score_play_time.second);
     }
+    const auto finished = Clock::now();
+    tick_duration.Observe(finished - start);
+
+    if (profiler_) {
+        // Фазы модели уже замерены в UpdateSession, здесь добавляются уход игроков и запись в базу
+        TickPhaseTimes phases = session.GetLastTickPhases();
+        phases.retire = ToMilliseconds(retired - updated);
+        phases.db_write = ToMilliseconds(finished - retired);
+        session.SetLastTickPhases(phases);
+        profiler_->GetSessionProfile(session).RecordTick(phases, session.GetDogsCount(), session.GetMovingDogsCount(),
+                                                         session.GetLostObjectsCount(), session.GetPlayersCount());
+    }
+}
+
+bool Application::AdvanceGameTime(double delta)
+{
+    game_->IncreaseGameTime(delta);
     last_save_time_ += delta;
+    return listener_ && listener_->OnTick(delta, game_);
+}
+
+SessionSnapshot Application::MakeSessionSnapshot(GameSession& session)
+{
+    const auto start = Clock::now();
+    SessionSnapshot snapshot;
+    const Map* map = session.GetMap();
+    snapshot.map_id = *map->GetId();
+    snapshot.instance = session.GetInstance();
+
+    for (const auto& [id, lost_obj] : session.GetLostObjects()) {
+        LostObjectRepr lor;
+        lor.pos = lost_obj.pos;
+        lor.type = lost_obj.loot->GetLootType();
+        snapshot.lost_objects[id] = lor;
+    }
+
+    // Сохраняются только собаки игроков, у которых ещё есть токен
+    for (const auto& [id, dog] : *session.GetDogs()) {
+        if (auto token = game_->GetPlayers()->FindTokenByDog(dog)) {
+            snapshot.tokens_dog[**token] = DogRepr{*dog};
+        }
+    }
+    static metrics::Histogram& snapshot_duration = metrics::GetRegistry().GetHistogram("game_snapshot_duration_seconds",
+        "Time to take a snapshot of one session for saving");
+    const auto duration = Clock::now() - start;
+    snapshot_duration.Observe(duration);
+    if (profiler_) {
+        profiler_->GetSessionProfile(session).RecordSnapshot(ToMilliseconds(duration));
+    }
+    return snapshot;
+}
+
+void Application::SaveSnapshots(const std::vector<SessionSnapshot>& snapshots)
+{
+    static metrics::Histogram& save_duration = metrics::GetRegistry().GetHistogram("game_state_save_duration_seconds",
+        "Time to write session snapshots to the state file");
+    if (listener_) {
+        const auto start = Clock::now();
+        listener_->SaveState(snapshots);
+        const auto duration = Clock::now() - start;
+        save_duration.Observe(duration);
+        if (profiler_) {
+            profiler_->RecordSave(ToMilliseconds(duration));
+        }
+    }
 }
 
 void Application::SaveState()
 {
-    if(listener_) {
-        listener_->SaveState(game_);
+    std::vector<SessionSnapshot> snapshots;
+    for (auto& session : *game_->GetSessions()) {
+        snapshots.push_back(MakeSessionSnapshot(session));
     }
+    SaveSnapshots(snapshots);
 }
 
 std::unordered_map<std::string, std::pair<int, int>> Application::GetRecords(int start_elem, int elem_count)
@@ -1,7 +1,19 @@
 #pragma once
 
 #include "json_loader.h"
-
+#include "tick_profiler.h"
+
+#include <vector>
+
+// Сохраняемое состояние одной сессии. Снимается в strand сессии,
+// поэтому сессии не нужно останавливать на время сохранения.
+struct SessionSnapshot {
+    std::string map_id;
+    // Номер экземпляра сессии среди сессий той же карты
+    std::size_t instance = 0;
+    std::unordered_map<int, LostObjectRepr> lost_objects;
+    std::unordered_map<std::string, DogRepr> tokens_dog;
+};
 
 class ApplicationListener {
 public:
@@ -12,16 +24,18 @@ public:
     ApplicationListener(const ApplicationListener&) = default; // support copying
     ApplicationListener& operator=(const ApplicationListener&) = default;
     
-    virtual void OnTick(double delta, model::Game* game) = 0;
+    // Возвращает true, если пора сохранить состояние
+    virtual bool OnTick(double delta, model::Game* game) = 0;
 
-    virtual void SaveState(model::Game* game) = 0;
+    virtual void SaveState(const std::vector<SessionSnapshot>& snapshots) = 0;
 };
 
 class Application {
 public:
     explicit Application(model::Game* game, ConnectionPool* conn_pool) 
     :game_(game),
-    db_{conn_pool}
+    db_{conn_pool},
+    state_epoch_(MakeStateEpoch())
     {}
 
     Application& operator=(const Application&) = delete;
@@ -34,10 +48,26 @@ public:
 
     Player* FindPlayerByToken(const Token token);
 
-    std::pair<Player *, Token> JoinPlayer(std::string& username, std::string& map_id);
+    // Экземпляр сессии карты map_id со свободным местом, в нём занимается место для игрока.
+    // Место освобождается при уходе игрока; если вход не состоялся, его возвращает SeatGuard. nullptr, если карты нет.
+    GameSession* FindJoinableSession(const std::string& map_id);
+
+    std::pair<Player *, Token> JoinPlayer(std::string& username, GameSession& session);
 
     void MakePlayerAction(Player* player, std::string dir);
 
+    // Состояние сессии для запросов состояния. Сериализуется один раз после каждого изменения
+    // сессии, дальше все запросы получают тот же снимок. Вызывается в strand сессии.
+    std::shared_ptr<const StateSnapshot> GetStateSnapshot(GameSession& session);
+
+    // Только изменения после тика since, тоже один раз на изменение сессии.
+    // nullptr — клиент отстал больше, чем помнит сессия: нужно полное состояние.
+    std::shared_ptr<const StateSnapshot> GetStateChanges(GameSession& session, std::uint64_t since);
+
+    // Эпоха состояния, своя у каждого запуска сервера. Тики сессий после перезапуска начинаются
+    // заново, поэтому клиент получает тик вместе с эпохой и по ней отличает тик прошлого запуска.
+    std::uint64_t GetStateEpoch() const noexcept;
+
     void UpdateState(int tick);
 
     void SetTickAvailable();
@@ -50,17 +80,40 @@ public:
 
     void SetApplicationListener(std::shared_ptr<ApplicationListener> listener);
 
+    // Включает замер фаз тика. Профилировщик общий для копий Application.
+    void SetTickProfiler(std::shared_ptr<TickProfiler> profiler);
+
+    // nullptr, если замер выключен
+    const TickProfiler* GetTickProfiler() const noexcept;
+
+    // Тик всех сессий в текущем потоке
     void Tick(double delta);
 
+    // Тик одной сессии, вызывается в её strand
+    void TickSession(GameSession& session, double delta);
+
+    // Продвигает общее время игры после тика всех сессий.
+    // Возвращает true, если пора сохранить состояние.
+    bool AdvanceGameTime(double delta);
+
+    SessionSnapshot MakeSessionSnapshot(GameSession& session);
+
+    void SaveSnapshots(const std::vector<SessionSnapshot>& snapshots);
+
+    // Сохраняет все сессии в текущем потоке
     void SaveState();
 
     std::unordered_map<std::string, std::pair<int, int>> GetRecords(int start_elem, int elem_count);
 
 private:
+    static std::uint64_t MakeStateEpoch();
+
     postgres::Database db_;
     model::Game* game_;
     std::shared_ptr<ApplicationListener> listener_ = nullptr;
+    std::shared_ptr<TickProfiler> profiler_ = nullptr;
     bool is_command_tick_set_ = false;
     bool is_random_spawn_set_ = false;
     double last_save_time_ = .0;
+    std::uint64_t state_epoch_;
 };
\ No newline at end of file
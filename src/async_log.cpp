@@ -0,0 +1,314 @@
+#include "async_log.h"
+
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/json.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+namespace async_log {
+
+namespace {
+
+using namespace std::literals;
+namespace json = boost::json;
+
+// Записей в одной пачке: одна операция записи на пачку
+const std::size_t BATCH = 512;
+// Пауза потока записи, когда буфер пуст. Писатели не будят поток, чтобы не платить за это на каждом запросе.
+const auto IDLE_SLEEP = 5ms;
+
+std::int64_t NowMicros() noexcept {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Местное время, как у атрибута TimeStamp в Boost.Log
+std::string FormatTimestamp(std::int64_t timestamp_us) {
+    namespace pt = boost::posix_time;
+    const pt::ptime utc = pt::ptime(boost::gregorian::date(1970, 1, 1)) + pt::microseconds(timestamp_us);
+    return pt::to_iso_extended_string(boost::date_time::c_local_adjustor<pt::ptime>::utc_to_local(utc));
+}
+
+std::filesystem::path GetRotatedPath(const std::filesystem::path& path, unsigned index) {
+    std::filesystem::path result = path;
+    result += "." + std::to_string(index);
+    return result;
+}
+
+} // namespace
+
+std::optional<Level> ParseLevel(std::string_view name) noexcept {
+    if (name == "debug"sv) {
+        return Level::DEBUG;
+    }
+    if (name == "info"sv) {
+        return Level::INFO;
+    }
+    if (name == "warning"sv) {
+        return Level::WARNING;
+    }
+    if (name == "error"sv) {
+        return Level::ERROR;
+    }
+    if (name == "off"sv) {
+        return Level::OFF;
+    }
+    return std::nullopt;
+}
+
+std::string FormatRecord(const Record& record) {
+    json::object data;
+    std::string_view message;
+    switch (record.event) {
+    case Event::SERVER_STARTED:
+        data["port"] = record.port;
+        data["address"] = record.address.View();
+        message = "server started"sv;
+        break;
+    case Event::SERVER_EXITED:
+        data["code"] = record.code;
+        if (record.text.size != 0) {
+            data["exception"] = record.text.View();
+        }
+        message = "server exited"sv;
+        break;
+    case Event::REQUEST_RECEIVED:
+        data["ip"] = record.address.View();
+        data["URI"] = record.uri.View();
+        data["method"] = record.method.View();
+        message = "request received"sv;
+        break;
+    case Event::RESPONSE_SENT:
+        data["ip"] = record.address.View();
+        data["response_time"] = record.response_time;
+        data["code"] = record.code;
+        data["content_type"] = record.text.View();
+        message = "response sent"sv;
+        break;
+    case Event::NETWORK_ERROR:
+        data["code"] = record.code;
+        data["text"] = record.text.View();
+        data["where"] = record.method.View();
+        message = "error"sv;
+        break;
+    }
+
+    return json::serialize(json::object{
+        {"timestamp", FormatTimestamp(record.timestamp_us)},
+        {"data", std::move(data)},
+        {"message", message}
+    });
+}
+
+//! ------ Logger ------
+
+Logger::Logger()
+    : dropped_(metrics::GetRegistry().GetCounter("game_log_records_dropped_total",
+                                                 "Log records dropped because the log buffer was full"))
+{
+}
+
+Logger::~Logger() {
+    Stop();
+}
+
+void Logger::Start(const Options& options) {
+    Stop();
+    options_ = options;
+    if (options_.sample_rate >= 1.0) {
+        sample_period_ = 1;
+    } else if (options_.sample_rate <= 0.0) {
+        // Запросы не пишутся вовсе
+        sample_period_ = 0;
+    } else {
+        sample_period_ = static_cast<std::uint64_t>(1.0 / options_.sample_rate + 0.5);
+    }
+    if (!ring_ || ring_->GetCapacity() < options_.capacity) {
+        ring_ = std::make_unique<MpscRing<Record>>(options_.capacity);
+    }
+    if (!options_.file.empty()) {
+        OpenFile();
+    }
+    writer_ = std::jthread([this](std::stop_token stop) {
+        Run(stop);
+    });
+    // Запись уровня публикует буфер и настройки для потоков запросов
+    level_.store(options_.level, std::memory_order_release);
+}
+
+void Logger::Stop() {
+    level_.store(Level::OFF, std::memory_order_relaxed);
+    if (!writer_.joinable()) {
+        return;
+    }
+    writer_.request_stop();
+    writer_.join();
+    // Дописываем то, что успели положить до остановки
+    std::string buffer;
+    while (WriteBatch(buffer) != 0) {
+    }
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool Logger::SampleRequest() const noexcept {
+    if (sample_period_ == 1) {
+        return true;
+    }
+    if (sample_period_ == 0) {
+        return false;
+    }
+    thread_local std::uint64_t requests = 0;
+    return requests++ % sample_period_ == 0;
+}
+
+void Logger::Push(const Record& record) noexcept {
+    const Level level = level_.load(std::memory_order_acquire);
+    if (level == Level::OFF || record.level < level) {
+        return;
+    }
+    if (!ring_->TryPush(record)) {
+        dropped_.Increment();
+    }
+}
+
+std::uint64_t Logger::GetDroppedCount() const noexcept {
+    return dropped_.GetValue();
+}
+
+void Logger::Run(std::stop_token stop) {
+    std::string buffer;
+    while (!stop.stop_requested()) {
+        if (WriteBatch(buffer) == 0) {
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+}
+
+std::size_t Logger::WriteBatch(std::string& buffer) {
+    buffer.clear();
+    Record record;
+    std::size_t count = 0;
+    while (count < BATCH && ring_->TryPop(record)) {
+        buffer += FormatRecord(record);
+        buffer += '\n';
+        ++count;
+    }
+    if (count != 0) {
+        Write(buffer);
+    }
+    return count;
+}
+
+void Logger::Write(std::string_view data) {
+    if (!file_.is_open()) {
+        std::clog.write(data.data(), static_cast<std::streamsize>(data.size()));
+        std::clog.flush();
+        return;
+    }
+    if (file_size_ != 0 && file_size_ + data.size() > options_.max_file_size) {
+        RotateFiles();
+    }
+    file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file_.flush();
+    file_size_ += data.size();
+}
+
+void Logger::OpenFile() {
+    file_.open(options_.file, std::ios::binary | std::ios::app);
+    if (!file_) {
+        throw std::runtime_error("Failed to open log file " + options_.file.string());
+    }
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(options_.file, ec);
+    file_size_ = ec ? 0 : size;
+}
+
+void Logger::RotateFiles() {
+    file_.close();
+    std::error_code ec;
+    if (options_.max_files == 0) {
+        std::filesystem::remove(options_.file, ec);
+    } else {
+        // file.(n-1) -> file.n, ..., file -> file.1; самый старый файл перезаписывается
+        for (unsigned i = options_.max_files; i > 1; --i) {
+            std::filesystem::rename(GetRotatedPath(options_.file, i - 1), GetRotatedPath(options_.file, i), ec);
+        }
+        std::filesystem::rename(options_.file, GetRotatedPath(options_.file, 1), ec);
+    }
+    file_.clear();
+    file_.open(options_.file, std::ios::binary | std::ios::trunc);
+    file_size_ = 0;
+}
+
+Logger& GetLogger() {
+    static Logger logger;
+    return logger;
+}
+
+//! ------ Запись событий ------
+
+void LogServerStarted(std::string_view address, std::uint16_t port) {
+    Record record;
+    record.timestamp_us = NowMicros();
+    record.event = Event::SERVER_STARTED;
+    record.port = port;
+    record.address.Assign(address);
+    GetLogger().Push(record);
+}
+
+void LogServerExited(int code, std::string_view exception) {
+    Record record;
+    record.timestamp_us = NowMicros();
+    record.event = Event::SERVER_EXITED;
+    record.code = code;
+    record.text.Assign(exception);
+    GetLogger().Push(record);
+}
+
+void LogRequestReceived(std::string_view ip, std::string_view uri, std::string_view method) {
+    if (!GetLogger().IsEnabled(Level::INFO)) {
+        return;
+    }
+    Record record;
+    record.timestamp_us = NowMicros();
+    record.event = Event::REQUEST_RECEIVED;
+    record.address.Assign(ip);
+    record.uri.Assign(uri);
+    record.method.Assign(method);
+    GetLogger().Push(record);
+}
+
+void LogResponseSent(std::string_view ip, std::int64_t response_time, int code, std::string_view content_type) {
+    if (!GetLogger().IsEnabled(Level::INFO)) {
+        return;
+    }
+    Record record;
+    record.timestamp_us = NowMicros();
+    record.event = Event::RESPONSE_SENT;
+    record.address.Assign(ip);
+    record.response_time = response_time;
+    record.code = code;
+    record.text.Assign(content_type);
+    GetLogger().Push(record);
+}
+
+void LogError(int code, std::string_view text, std::string_view where) {
+    if (!GetLogger().IsEnabled(Level::ERROR)) {
+        return;
+    }
+    Record record;
+    record.timestamp_us = NowMicros();
+    record.event = Event::NETWORK_ERROR;
+    record.level = Level::ERROR;
+    record.code = code;
+    record.text.Assign(text);
+    record.method.Assign(where);
+    GetLogger().Push(record);
+}
+
+} // namespace async_log
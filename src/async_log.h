@@ -0,0 +1,166 @@
+#pragma once
+
+#include "metrics.h"
+#include "mpsc_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/*
+ *  Асинхронный журнал сервера. Потоки запросов складывают в кольцевой буфер записи
+ *  фиксированного размера: без выделения памяти и без JSON. Отдельный поток забирает
+ *  их пачками, форматирует в те же JSON-строки, что писал Boost.Log
+ *  ({"timestamp", "data", "message"}), и пишет пачку одной операцией в консоль
+ *  или в файл с ротацией по размеру.
+ *  Если буфер полон, запись отбрасывается и учитывается в счётчике, запрос не ждёт диск.
+ */
+namespace async_log {
+
+enum class Level : std::uint8_t {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR,
+    OFF
+};
+
+// Разбирает debug/info/warning/error/off, иначе nullopt
+std::optional<Level> ParseLevel(std::string_view name) noexcept;
+
+enum class Event : std::uint8_t {
+    SERVER_STARTED,
+    SERVER_EXITED,
+    REQUEST_RECEIVED,
+    RESPONSE_SENT,
+    NETWORK_ERROR
+};
+
+// Строка фиксированной ёмкости, длинные значения обрезаются
+template <std::size_t N>
+struct FixedString {
+    void Assign(std::string_view value) noexcept {
+        size = static_cast<std::uint16_t>(std::min(value.size(), N));
+        std::memcpy(data, value.data(), size);
+    }
+
+    std::string_view View() const noexcept {
+        return {data, size};
+    }
+
+    std::uint16_t size = 0;
+    char data[N];
+};
+
+/*
+ *  Запись журнала. Смысл полей зависит от события:
+ *    SERVER_STARTED   — address, port;
+ *    SERVER_EXITED    — code, text (исключение, может быть пустым);
+ *    REQUEST_RECEIVED — address (ip клиента), uri, method;
+ *    RESPONSE_SENT    — address, response_time, code, text (content type);
+ *    NETWORK_ERROR    — code, text (описание), method (где произошла ошибка).
+ */
+struct Record {
+    // Микросекунды от эпохи system_clock
+    std::int64_t timestamp_us = 0;
+    Event event = Event::REQUEST_RECEIVED;
+    Level level = Level::INFO;
+    std::uint16_t port = 0;
+    std::int32_t code = 0;
+    std::int64_t response_time = 0;
+    FixedString<46> address;
+    FixedString<16> method;
+    FixedString<160> uri;
+    FixedString<128> text;
+};
+
+// Отформатированная строка записи без перевода строки
+std::string FormatRecord(const Record& record);
+
+struct Options {
+    Level level = Level::INFO;
+    // Доля запросов, попадающих в журнал: 1 — все, 0.1 — каждый десятый
+    double sample_rate = 1.0;
+    // Пустой путь — писать в std::clog
+    std::filesystem::path file;
+    // При превышении размера файл переименовывается в file.1, file.1 — в file.2 и т.д.
+    std::uintmax_t max_file_size = 64 * 1024 * 1024;
+    unsigned max_files = 5;
+    std::size_t capacity = 16384;
+};
+
+class Logger {
+public:
+    Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ~Logger();
+
+    // До запуска журнал выключен, записи не принимаются
+    void Start(const Options& options);
+
+    // Дописывает всё, что осталось в буфере, и останавливает поток записи
+    void Stop();
+
+    bool IsEnabled(Level level) const noexcept {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // Решает, попадёт ли очередной запрос в журнал. Выборка — каждый n-й запрос потока,
+    // поэтому генератор случайных чисел игры не затрагивается.
+    bool SampleRequest() const noexcept;
+
+    // Не блокирует; при переполнении буфера запись отбрасывается
+    void Push(const Record& record) noexcept;
+
+    std::uint64_t GetDroppedCount() const noexcept;
+
+private:
+    void Run(std::stop_token stop);
+
+    // Забирает из буфера до BATCH записей и пишет их одной операцией, возвращает их число
+    std::size_t WriteBatch(std::string& buffer);
+
+    void Write(std::string_view data);
+
+    void OpenFile();
+
+    void RotateFiles();
+
+    std::atomic<Level> level_{Level::OFF};
+    std::uint64_t sample_period_ = 1;
+    std::unique_ptr<MpscRing<Record>> ring_;
+    metrics::Counter& dropped_;
+
+    // Состояние потока записи
+    Options options_;
+    std::ofstream file_;
+    std::uintmax_t file_size_ = 0;
+    std::jthread writer_;
+};
+
+// Журнал процесса
+Logger& GetLogger();
+
+void LogServerStarted(std::string_view address, std::uint16_t port);
+
+void LogServerExited(int code, std::string_view exception = {});
+
+void LogRequestReceived(std::string_view ip, std::string_view uri, std::string_view method);
+
+void LogResponseSent(std::string_view ip, std::int64_t response_time, int code, std::string_view content_type);
+
+void LogError(int code, std::string_view text, std::string_view where);
+
+} // namespace async_log
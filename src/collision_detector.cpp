@@ -0,0 +1,236 @@
+#include "collision_detector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <tuple>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAME_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace model {
+
+namespace collision_detector {
+
+CollectionResult TryCollectPoint(DogPosition a, DogPosition b, LostObjectPosition c) {
+    // Проверим, что перемещение ненулевое.
+    // Тут приходится использовать строгое равенство, а не приближённое,
+    // пoскольку при сборе придётся учитывать перемещение даже на небольшое
+    // расстояние.
+    if (b.x != a.x || b.y != a.y) {
+        const double u_x = c.x - a.x;
+        const double u_y = c.y - a.y;
+        const double v_x = b.x - a.x;
+        const double v_y = b.y - a.y;
+        const double u_dot_v = u_x * v_x + u_y * v_y;
+        const double u_len2 = u_x * u_x + u_y * u_y;
+        const double v_len2 = v_x * v_x + v_y * v_y;
+        const double proj_ratio = u_dot_v / v_len2;
+        const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+
+        return CollectionResult(sq_distance, proj_ratio);
+    }
+    const double u_x = c.x - a.x;
+    const double u_y = c.y - a.y;
+    return CollectionResult(u_x * u_x + u_y * u_y, std::numeric_limits<double>::quiet_NaN());
+}
+
+namespace {
+
+// Параметры отрезка перемещения, общие для всех точек пакета
+struct Segment {
+    double a_x;
+    double a_y;
+    double v_x;
+    double v_y;
+    // 1 / |v|^2: деление вынесено из цикла, внутри остаются только умножения и сложения
+    double inv_v_len2;
+};
+
+void CollectScalar(const Segment& s, const double* xs, const double* ys, std::size_t count, double* proj_ratios, double* sq_distances) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const double u_x = xs[i] - s.a_x;
+        const double u_y = ys[i] - s.a_y;
+        const double u_dot_v = u_x * s.v_x + u_y * s.v_y;
+        const double u_len2 = u_x * u_x + u_y * u_y;
+        const double proj_ratio = u_dot_v * s.inv_v_len2;
+        proj_ratios[i] = proj_ratio;
+        sq_distances[i] = u_len2 - u_dot_v * proj_ratio;
+    }
+}
+
+#ifdef GAME_X86_SIMD
+
+// Формулы и порядок операций те же, что в CollectScalar, поэтому результаты всех вариантов совпадают побитно.
+// От TryCollectPoint они могут отличаться только ошибкой округления.
+__attribute__((target("sse2")))
+void CollectSse2(const Segment& s, const double* xs, const double* ys, std::size_t count, double* proj_ratios, double* sq_distances) {
+    const __m128d a_x = _mm_set1_pd(s.a_x);
+    const __m128d a_y = _mm_set1_pd(s.a_y);
+    const __m128d v_x = _mm_set1_pd(s.v_x);
+    const __m128d v_y = _mm_set1_pd(s.v_y);
+    const __m128d inv_v_len2 = _mm_set1_pd(s.inv_v_len2);
+
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d u_x = _mm_sub_pd(_mm_loadu_pd(xs + i), a_x);
+        const __m128d u_y = _mm_sub_pd(_mm_loadu_pd(ys + i), a_y);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(u_x, v_x), _mm_mul_pd(u_y, v_y));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(u_x, u_x), _mm_mul_pd(u_y, u_y));
+        const __m128d proj_ratio = _mm_mul_pd(u_dot_v, inv_v_len2);
+        _mm_storeu_pd(proj_ratios + i, proj_ratio);
+        _mm_storeu_pd(sq_distances + i, _mm_sub_pd(u_len2, _mm_mul_pd(u_dot_v, proj_ratio)));
+    }
+    CollectScalar(s, xs + i, ys + i, count - i, proj_ratios + i, sq_distances + i);
+}
+
+__attribute__((target("avx2")))
+void CollectAvx2(const Segment& s, const double* xs, const double* ys, std::size_t count, double* proj_ratios, double* sq_distances) {
+    const __m256d a_x = _mm256_set1_pd(s.a_x);
+    const __m256d a_y = _mm256_set1_pd(s.a_y);
+    const __m256d v_x = _mm256_set1_pd(s.v_x);
+    const __m256d v_y = _mm256_set1_pd(s.v_y);
+    const __m256d inv_v_len2 = _mm256_set1_pd(s.inv_v_len2);
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(xs + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(ys + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x), _mm256_mul_pd(u_y, v_y));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_mul_pd(u_dot_v, inv_v_len2);
+        _mm256_storeu_pd(proj_ratios + i, proj_ratio);
+        _mm256_storeu_pd(sq_distances + i, _mm256_sub_pd(u_len2, _mm256_mul_pd(u_dot_v, proj_ratio)));
+    }
+    // Хвост считается SSE-кодом без VEX-префикса. Компилятор не всегда сам сбрасывает
+    // верхние половины ymm-регистров перед таким вызовом, а без этого каждый вызов платит за смену режима.
+    _mm256_zeroupper();
+    CollectScalar(s, xs + i, ys + i, count - i, proj_ratios + i, sq_distances + i);
+}
+
+#endif
+
+SimdLevel DetectSimdLevel() {
+#ifdef GAME_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+} // namespace
+
+SimdLevel GetSimdLevel() {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+void TryCollectPoints(DogPosition a, DogPosition b, std::span<const double> xs, std::span<const double> ys,
+                      std::span<double> proj_ratios, std::span<double> sq_distances) {
+    TryCollectPoints(GetSimdLevel(), a, b, xs, ys, proj_ratios, sq_distances);
+}
+
+void TryCollectPoints(SimdLevel level, DogPosition a, DogPosition b, std::span<const double> xs, std::span<const double> ys,
+                      std::span<double> proj_ratios, std::span<double> sq_distances) {
+    assert(xs.size() == ys.size() && xs.size() == proj_ratios.size() && xs.size() == sq_distances.size());
+
+    if (b.x == a.x && b.y == a.y) {
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            const CollectionResult result = TryCollectPoint(a, b, LostObjectPosition{xs[i], ys[i]});
+            proj_ratios[i] = result.proj_ratio;
+            sq_distances[i] = result.sq_distance;
+        }
+        return;
+    }
+
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const Segment segment{a.x, a.y, v_x, v_y, 1.0 / (v_x * v_x + v_y * v_y)};
+
+    if (level > GetSimdLevel()) {
+        level = SimdLevel::SCALAR;
+    }
+    switch (level) {
+#ifdef GAME_X86_SIMD
+    case SimdLevel::AVX2:
+        CollectAvx2(segment, xs.data(), ys.data(), xs.size(), proj_ratios.data(), sq_distances.data());
+        break;
+    case SimdLevel::SSE2:
+        CollectSse2(segment, xs.data(), ys.data(), xs.size(), proj_ratios.data(), sq_distances.data());
+        break;
+#endif
+    default:
+        CollectScalar(segment, xs.data(), ys.data(), xs.size(), proj_ratios.data(), sq_distances.data());
+        break;
+    }
+}
+
+void ItemGathererProvider::GetCandidates([[maybe_unused]] std::size_t gatherer_idx, std::vector<std::size_t>& candidates) const {
+    candidates.resize(ItemsCount());
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        candidates[i] = i;
+    }
+}
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    std::vector<GatheringEvent> events;
+    CollectGatherEvents(provider, 0, provider.GatherersCount(), events);
+    SortGatherEvents(events);
+    return events;
+}
+
+void CollectGatherEvents(const ItemGathererProvider& provider, std::size_t first_gatherer, std::size_t last_gatherer,
+                         std::vector<GatheringEvent>& events) {
+    GatherScratch scratch;
+    CollectGatherEvents(provider, first_gatherer, last_gatherer, events, scratch);
+}
+
+void CollectGatherEvents(const ItemGathererProvider& provider, std::size_t first_gatherer, std::size_t last_gatherer,
+                         std::vector<GatheringEvent>& events, GatherScratch& scratch) {
+    auto& [candidates, xs, ys, widths, proj_ratios, sq_distances] = scratch;
+
+    for (std::size_t g = first_gatherer; g < last_gatherer; ++g) {
+        const Gatherer gatherer = provider.GetGatherer(g);
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+
+        candidates.clear();
+        provider.GetCandidates(g, candidates);
+        xs.resize(candidates.size());
+        ys.resize(candidates.size());
+        widths.resize(candidates.size());
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            const Item item = provider.GetItem(candidates[i]);
+            xs[i] = item.x;
+            ys[i] = item.y;
+            widths[i] = item.width;
+        }
+        proj_ratios.resize(candidates.size());
+        sq_distances.resize(candidates.size());
+        TryCollectPoints(gatherer.start_pos, gatherer.end_pos, xs, ys, proj_ratios, sq_distances);
+
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (CollectionResult{sq_distances[i], proj_ratios[i]}.IsCollected(gatherer.width + widths[i])) {
+                events.push_back(GatheringEvent{candidates[i], g, sq_distances[i], proj_ratios[i] * gatherer.travel_time});
+            }
+        }
+    }
+}
+
+void SortGatherEvents(std::vector<GatheringEvent>& events) {
+    std::sort(events.begin(), events.end(), [](const GatheringEvent& lhs, const GatheringEvent& rhs) {
+        return std::tie(lhs.time, lhs.gatherer_id, lhs.item_id) < std::tie(rhs.time, rhs.gatherer_id, rhs.item_id);
+    });
+}
+
+} //namespace collision_detector
+
+} // namespace model
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "dog.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace model {
+
+namespace collision_detector {
+
+struct CollectionResult {
+    bool IsCollected(double collect_radius) const {
+        return proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= collect_radius * collect_radius;
+    }
+
+    // квадрат расстояния до точки
+    double sq_distance;
+
+    // доля пройденного отрезка
+    double proj_ratio;
+};
+
+// Движемся из точки a в точку b и пытаемся подобрать точку c.
+// Эта функция реализована в уроке.
+CollectionResult TryCollectPoint(DogPosition a, DogPosition b, LostObjectPosition c);
+
+// Набор векторных инструкций, которым считается пакетная проверка
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Лучший набор инструкций, доступный на текущем процессоре. Определяется один раз.
+SimdLevel GetSimdLevel();
+
+/*
+ * Пакетный вариант TryCollectPoint: перемещение из a в b проверяется сразу против
+ * всех точек (xs[i], ys[i]). Для каждой точки в proj_ratios[i] и sq_distances[i]
+ * записываются те же величины, что вернула бы TryCollectPoint.
+ * При нулевом перемещении proj_ratio равен NaN, и точка не считается собранной.
+ * Все массивы должны быть одной длины.
+ */
+void TryCollectPoints(DogPosition a, DogPosition b, std::span<const double> xs, std::span<const double> ys,
+                      std::span<double> proj_ratios, std::span<double> sq_distances);
+
+// То же, но с явно заданным набором инструкций (для тестов и бенчмарков).
+// Если процессор не поддерживает level, используется скалярный вариант.
+void TryCollectPoints(SimdLevel level, DogPosition a, DogPosition b, std::span<const double> xs, std::span<const double> ys,
+                      std::span<double> proj_ratios, std::span<double> sq_distances);
+
+//! ------------------------- Gather events --------------------------------
+
+// Предмет, который можно подобрать (вещь или офис)
+struct Item {
+    double x;
+    double y;
+    double width;
+};
+
+// Собиратель, двигавшийся за тик из start_pos в end_pos
+struct Gatherer {
+    DogPosition start_pos;
+    DogPosition end_pos;
+    double width;
+    // Доля тика, за которую пройден путь: собака, упёршаяся в край дороги, стоит остаток тика
+    double travel_time = 1.0;
+};
+
+class ItemGathererProvider {
+protected:
+    ~ItemGathererProvider() = default;
+
+public:
+    virtual std::size_t ItemsCount() const = 0;
+    virtual Item GetItem(std::size_t idx) const = 0;
+    virtual std::size_t GatherersCount() const = 0;
+    virtual Gatherer GetGatherer(std::size_t idx) const = 0;
+
+    // Индексы предметов, которые стоит проверять для собирателя gatherer_idx.
+    // По умолчанию — все предметы; реализации с пространственным индексом сужают список.
+    virtual void GetCandidates(std::size_t gatherer_idx, std::vector<std::size_t>& candidates) const;
+};
+
+struct GatheringEvent {
+    std::size_t item_id;
+    std::size_t gatherer_id;
+    double sq_distance;
+    // доля тика в момент встречи: доля пройденного отрезка, умноженная на travel_time собирателя
+    double time;
+};
+
+/*
+ * Все встречи собирателей с предметами за тик, отсортированные по времени.
+ * При равном времени раньше идёт собиратель с меньшим индексом, затем предмет
+ * с меньшим индексом. Предмет собран, если расстояние до него не больше суммы
+ * полуширин собирателя и предмета.
+ */
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
+
+// Рабочие массивы CollectGatherEvents. Переиспользуются между вызовами,
+// чтобы поиск событий не выделял память на каждом тике.
+struct GatherScratch {
+    std::vector<std::size_t> candidates;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> widths;
+    std::vector<double> proj_ratios;
+    std::vector<double> sq_distances;
+};
+
+// Части FindGatherEvents для параллельного расчёта: события собирателей
+// [first_gatherer, last_gatherer) дописываются в events без сортировки,
+// после объединения всех кусков их упорядочивает SortGatherEvents.
+// Параллельные вызовы должны получать разные scratch.
+void CollectGatherEvents(const ItemGathererProvider& provider, std::size_t first_gatherer, std::size_t last_gatherer,
+                         std::vector<GatheringEvent>& events, GatherScratch& scratch);
+
+void CollectGatherEvents(const ItemGathererProvider& provider, std::size_t first_gatherer, std::size_t last_gatherer,
+                         std::vector<GatheringEvent>& events);
+
+void SortGatherEvents(std::vector<GatheringEvent>& events);
+
+} //namespace collision_detector
+
+} // namespace model
@@ -3,6 +3,9 @@
 #include <pqxx/pqxx>
 #include <pqxx/connection>
 
+#include "metrics.h"
+
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <vector>
@@ -55,6 +58,9 @@ public:
     }
 
     ConnectionWrapper GetConnection() {
+        static metrics::Histogram& wait_time = metrics::GetRegistry().GetHistogram("game_db_pool_wait_seconds",
+            "Time spent waiting for a free database connection");
+        const auto start = std::chrono::steady_clock::now();
         std::unique_lock lock{mutex_};
         // Блокируем текущий поток и ждём, пока cond_var_ не получит уведомление и не освободится
         // хотя бы одно соединение
@@ -62,6 +68,7 @@ public:
             return used_connections_ < pool_.size();
         });
         // После выхода из цикла ожидания мьютекс остаётся захваченным
+        wait_time.Observe(std::chrono::steady_clock::now() - start);
 
         return {std::move(pool_[used_connections_++]), *this};
     }
@@ -1,5 +1,7 @@
 #include "dog.h"
 
+#include <cmath>
+
 std::uint64_t Dog::GetId() const {
     return id_;
 }
@@ -9,165 +11,58 @@ std::string Dog::GetName() const {
 }
 
 DogPosition Dog::GetPosition() const {
-    return position_;
+    return DogPosition{state_->pos_x[slot_], state_->pos_y[slot_]};
 }
 
 DogSpeed Dog::GetSpeed() const {
-    return speed_;
+    return DogSpeed{state_->speed_x[slot_], state_->speed_y[slot_]};
 }
 
 Direction Dog::GetDirection() const {
-    return direction_;
+    return state_->direction[slot_];
 }
 
 void Dog::SetSpeedAndDirection(DogSpeed speed, Direction dir) {
     if (speed.x == .0 && speed.y == .0) {
-        speed_ = DogSpeed{0.0, 0.0};
+        SetSpeed(DogSpeed{0.0, 0.0});
     } else {
-        speed_ = speed;
-        direction_ = dir;
+        SetSpeed(speed);
+        state_->direction[slot_] = dir;
     }
 }
 
 void Dog::SetSpeed(DogSpeed speed) {
-    speed_ = speed;
+    state_->SetSpeed(slot_, speed.x, speed.y);
 }
 
-void Dog::SetRoadToMove(Road* road) {
-    road_to_move_ = road;
+void Dog::SetRoadId(std::size_t road_id) {
+    state_->road_id[slot_] = road_id;
 }
 
-Road *Dog::GetRoadToMove() const
-{
-    return road_to_move_;
+std::size_t Dog::GetRoadId() const {
+    return state_->road_id[slot_];
 }
 
 void Dog::SetPosition(DogPosition pos) {
-    position_ = pos;
+    state_->pos_x[slot_] = pos.x;
+    state_->pos_y[slot_] = pos.y;
 }
 
 void Dog::SetPrevPosition(DogPosition pos)
 {
-    prev_position_ = pos;
+    state_->prev_x[slot_] = pos.x;
+    state_->prev_y[slot_] = pos.y;
 }
 
-void Dog::Move(double delta_time, const std::vector<Road>& roads) {
-    // Вычисляем новое положение на основе скорости и времени
+void Dog::Move(double delta_time, const Map& map) {
+    // Вычисляем смещение на основе скорости и времени
     const double MS_TO_SEC_COEF = 0.001;
 
-    DogPosition new_position = position_;
-    new_position.x = position_.x + (speed_.x * (delta_time * MS_TO_SEC_COEF));
-    new_position.y = position_.y + (speed_.y * (delta_time * MS_TO_SEC_COEF));
-
-    const double EPSILON = 1e-6;
-    if (std::abs(new_position.x - position_.x) > EPSILON || std::abs(new_position.y - position_.y) > EPSILON) {
-        if (CanMoveTo(new_position, road_to_move_)) {
-            prev_position_ = position_;
-            position_ = new_position;
-        } else {
-            auto current_roads = GetCurrentRoad(roads);
-
-            bool can_move = false;
-            for (const auto& road : current_roads) {
-                if (CanMoveTo(new_position, road)) {
-                    prev_position_ = position_;
-                    position_ = new_position;
-                    road_to_move_ = road;
-                    can_move = true;
-                    break;
-                } else {
-                    if (road != road_to_move_) {
-                        road_to_move_ = road;
-                    }
-                }
-            }        
-            if (!can_move) {
-                SetSpeed(DogSpeed{0.0, 0.0});
-                StopAtRoadBoundary(road_to_move_, new_position);
-            }
-        }
-    }
-}
-
-bool Dog::CanMoveTo(const DogPosition& new_position, const Road* current_road) const {
-    if (current_road) {
-        Point start = current_road->GetStart();
-        Point end = current_road->GetEnd();
-
-        // Определяем минимальные и максимальные координаты
-        auto [min_x, max_x] = sdk::GetMinMax(start.x, end.x);
-        auto [min_y, max_y] = sdk::GetMinMax(start.y, end.y);
-
-        if (current_road->IsHorizontal() && new_position.y <= max_y + map_const::HALF_OF_ROAD && new_position.y >= min_y - map_const::HALF_OF_ROAD &&
-            new_position.x >= min_x - map_const::HALF_OF_ROAD && new_position.x <= max_x + map_const::HALF_OF_ROAD) {
-            return true; // Новая позиция на текущей горизонтальной дороге
-        }
-        if (current_road->IsVertical() && new_position.x <= max_x + map_const::HALF_OF_ROAD && new_position.x >= min_x - map_const::HALF_OF_ROAD &&
-            new_position.y >= min_y - map_const::HALF_OF_ROAD && new_position.y <= max_y + map_const::HALF_OF_ROAD) {
-            return true; // Новая позиция на текущей вертикальной дороге
-        }
-    }
-    return false; // Новая позиция не на текущей дороге
-}
-
-void Dog::StopAtRoadBoundary(const Road* current_road, const DogPosition& new_position) {
-    // Логика остановки на границе текущей дороги
-    if (current_road) {
-        Point start = current_road->GetStart();
-        Point end = current_road->GetEnd();
-
-        // Определяем минимальные и максимальные координаты
-        auto [min_x, max_x] = sdk::GetMinMax(start.x, end.x);
-        auto [min_y, max_y] = sdk::GetMinMax(start.y, end.y);
-
-        if (current_road->IsHorizontal()) {
-            // Остановка на границе горизонтальной дороги
-            if (direction_ == Direction::NORTH) { // Движение U
-                position_.y = min_y - map_const::HALF_OF_ROAD; // Остановка выше дороги
-            } else if (direction_ == Direction::SOUTH) { // Движение D
-                position_.y = max_y + map_const::HALF_OF_ROAD; // Остановка ниже дороги
-            } else if (direction_ == Direction::WEST && new_position.x <= min_x) {  // L
-                position_.x = min_x - map_const::HALF_OF_ROAD; // Остановка слева от дороги
-            } else if (direction_ == Direction::EAST && new_position.x >= max_x) { // R
-                position_.x = max_x + map_const::HALF_OF_ROAD; // Остановка справа от дороги
-            }
-        } else if (current_road->IsVertical()) {
-            // Остановка на границе вертикальной дороги
-            if (direction_ == Direction::EAST) { // Движение R
-                position_.x = max_x + map_const::HALF_OF_ROAD; // Остановка справа от дороги
-            } else if (direction_ == Direction::WEST) { // Движение L
-                position_.x = min_x - map_const::HALF_OF_ROAD; // Остановка слева от дороги
-            } else if (direction_ == Direction::NORTH && new_position.y <= min_y) {
-                // Если собака движется на север, останавливаем её выше дороги
-                position_.y = min_y - map_const::HALF_OF_ROAD; // Остановка выше дороги
-            } else if (direction_ == Direction::SOUTH && new_position.y >= max_y) {
-                // Если собака движется на юг, останавливаем её ниже дороги
-                position_.y = max_y + map_const::HALF_OF_ROAD; // Остановка ниже дороги
-            }
-        }
-    }
-}
-
-const std::vector<Road*> Dog::GetCurrentRoad(const std::vector<Road>& roads) const {
-   std::vector<Road*> founded_roads;
-    for (const auto& road : roads) {
-        Point start = road.GetStart();
-        Point end = road.GetEnd();
-
-        // Определяем минимальные и максимальные координаты
-        auto [min_x, max_x] = sdk::GetMinMax(start.x, end.x);
-        auto [min_y, max_y] = sdk::GetMinMax(start.y, end.y);
-
-        if (road.IsHorizontal() && position_.y <= max_y + map_const::HALF_OF_ROAD && position_.y >= min_y - map_const::HALF_OF_ROAD &&
-            position_.x >= min_x - map_const::HALF_OF_ROAD && position_.x <= max_x + map_const::HALF_OF_ROAD) {
-            founded_roads.push_back(const_cast<Road*>(&road)); // Собака на горизонтальной дороге
-        }
-        if (road.IsVertical() && position_.x <= max_x + map_const::HALF_OF_ROAD && position_.x >= min_x - map_const::HALF_OF_ROAD &&
-            position_.y >= min_y - map_const::HALF_OF_ROAD && position_.y <= max_y + map_const::HALF_OF_ROAD) {
-            founded_roads.push_back(const_cast<Road*>(&road)); // Собака на вертикальной дороге
-        }
+    const double dx = state_->speed_x[slot_] * (delta_time * MS_TO_SEC_COEF);
+    const double dy = state_->speed_y[slot_] * (delta_time * MS_TO_SEC_COEF);
+    if (state_->Move(slot_, dx, dy, map)) {
+        state_->SetSpeed(slot_, 0.0, 0.0);
     }
-    return founded_roads; // Возвращаем найденные дороги
 }
 
 size_t Dog::GetBagSize() const noexcept {
@@ -187,7 +82,12 @@ void Dog::ClearBag()
 
 DogPosition Dog::GetPreviousPosition() const
 {
-    return prev_position_;
+    return DogPosition{state_->prev_x[slot_], state_->prev_y[slot_]};
+}
+
+double Dog::GetTravelTime() const
+{
+    return state_->travel_time[slot_];
 }
 
 void Dog::IncreaseScore(int value)
@@ -220,25 +120,152 @@ void Dog::AddToBag(int obj_id, int type_id) {
 }
 
 void Dog::IncreaseGameTime(double delta) {
-    game_time_ += delta;
+    state_->game_time[slot_] += delta;
 }
 
 void Dog::IncreaseRetireTime(double delta) {
-    retire_time_ += delta;
+    state_->AddRetireTime(slot_, delta);
 }
 
 void Dog::SetNeedToRetire(bool need_to_retire) {
-    need_to_retire_ = need_to_retire;
+    state_->SetNeedToRetire(slot_, need_to_retire);
 }
 
 double Dog::GetRetireTime() {
-    return retire_time_;
+    return state_->GetRetireTime(slot_);
 }
 
 double Dog::GetGameTime() {
-    return game_time_;
+    return state_->game_time[slot_];
 }
 
 bool Dog::IsNeedToRetire() {
-    return need_to_retire_;
+    return state_->need_to_retire[slot_] != 0;
+}
+
+//! ------------------------- DogsState --------------------------------
+
+std::size_t DogsState::Add() {
+    pos_x.push_back(0.0);
+    pos_y.push_back(0.0);
+    prev_x.push_back(0.0);
+    prev_y.push_back(0.0);
+    speed_x.push_back(0.0);
+    speed_y.push_back(0.0);
+    direction.push_back(Direction::NORTH);
+    road_id.push_back(RoadIndex::NO_ROAD);
+    travel_time.push_back(1.0);
+    game_time.push_back(0.0);
+    retire_time.push_back(0.0);
+    idle_since.push_back(clock);
+    need_to_retire.push_back(0);
+    moving_pos.push_back(NOT_MOVING);
+
+    // Новая собака стоит: положение задаётся после добавления, предыдущее выровняется на тике
+    const std::size_t slot = pos_x.size() - 1;
+    settling.push_back(static_cast<std::uint32_t>(slot));
+    ScheduleRetire(slot);
+    return slot;
+}
+
+std::size_t DogsState::Size() const noexcept {
+    return pos_x.size();
+}
+
+bool DogsState::Move(std::size_t slot, double dx, double dy, const Map& map) {
+    const double EPSILON = 1e-6;
+    travel_time[slot] = 1.0;
+    if (std::abs(dx) <= EPSILON && std::abs(dy) <= EPSILON) {
+        prev_x[slot] = pos_x[slot];
+        prev_y[slot] = pos_y[slot];
+        return false;
+    }
+    // Проходим по графу дорог всё смещение за тик, переходя через перекрёстки
+    RoadWalk walk = map.GetRoadGraph().Walk(map.GetRoadIndex(), road_id[slot], pos_x[slot], pos_y[slot], dx, dy);
+    prev_x[slot] = pos_x[slot];
+    prev_y[slot] = pos_y[slot];
+    pos_x[slot] = walk.x;
+    pos_y[slot] = walk.y;
+    road_id[slot] = walk.road_id;
+    if (walk.stopped) {
+        // Скорость постоянна, поэтому доля тика равна доле пройденного пути
+        travel_time[slot] = std::hypot(walk.x - prev_x[slot], walk.y - prev_y[slot]) / std::hypot(dx, dy);
+    }
+    return walk.stopped;
+}
+
+void DogsState::SetSpeed(std::size_t slot, double x, double y) {
+    speed_x[slot] = x;
+    speed_y[slot] = y;
+
+    const bool was_moving = IsMoving(slot);
+    const bool now_moving = x != 0.0 || y != 0.0;
+    if (now_moving && !was_moving) {
+        // Простой закончился: фиксируем накопленное время и снимаем таймер
+        retire_time[slot] += clock - idle_since[slot];
+        retire_timers.Cancel(static_cast<std::uint32_t>(slot));
+        moving_pos[slot] = static_cast<std::uint32_t>(moving.size());
+        moving.push_back(static_cast<std::uint32_t>(slot));
+    } else if (!now_moving && was_moving) {
+        // Удаляем слот из moving, переставляя на его место последний
+        const std::uint32_t pos = moving_pos[slot];
+        moving[pos] = moving.back();
+        moving_pos[moving[pos]] = pos;
+        moving.pop_back();
+        moving_pos[slot] = NOT_MOVING;
+
+        idle_since[slot] = clock;
+        settling.push_back(static_cast<std::uint32_t>(slot));
+        ScheduleRetire(slot);
+    }
+}
+
+bool DogsState::IsMoving(std::size_t slot) const noexcept {
+    return moving_pos[slot] != NOT_MOVING;
+}
+
+double DogsState::GetRetireTime(std::size_t slot) const noexcept {
+    return retire_time[slot] + (IsMoving(slot) ? 0.0 : clock - idle_since[slot]);
+}
+
+void DogsState::AddRetireTime(std::size_t slot, double delta) {
+    retire_time[slot] += delta;
+    if (!IsMoving(slot)) {
+        ScheduleRetire(slot);
+    }
+}
+
+void DogsState::SetNeedToRetire(std::size_t slot, bool value) {
+    need_to_retire[slot] = value;
+    if (value) {
+        retire_timers.Cancel(static_cast<std::uint32_t>(slot));
+    } else if (!IsMoving(slot)) {
+        ScheduleRetire(slot);
+    }
+}
+
+void DogsState::SetRetireLimit(double limit) {
+    retire_limit = limit;
+    for (std::size_t slot = 0; slot < Size(); ++slot) {
+        if (!IsMoving(slot)) {
+            ScheduleRetire(slot);
+        }
+    }
+}
+
+void DogsState::AdvanceClock(double delta) {
+    clock += delta;
+    retire_timers.Advance(clock, [this](std::uint32_t slot) {
+        need_to_retire[slot] = 1;
+        expired.push_back(slot);
+    });
+}
+
+void DogsState::ScheduleRetire(std::size_t slot) {
+    const double deadline = idle_since[slot] + retire_limit - retire_time[slot];
+    if (need_to_retire[slot] || !std::isfinite(deadline)) {
+        retire_timers.Cancel(static_cast<std::uint32_t>(slot));
+        return;
+    }
+    retire_timers.Schedule(static_cast<std::uint32_t>(slot), deadline);
 }
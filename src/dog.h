@@ -5,8 +5,10 @@
 
 #include "map.h"
 #include "sdk.h"
+#include "timer_wheel.h"
 
 #include <cstdint>
+#include <limits>
 #include <iostream>
 
 static const double DOG_WIDTH = 0.6;
@@ -44,13 +46,89 @@ enum Direction : char{
 
 class DogRepr;
 
+/*
+ *  Часто изменяемые данные всех собак сессии, разложенные по отдельным массивам.
+ *  Индекс в массивах — плотный номер слота собаки в сессии, поэтому обновление
+ *  таймеров и положений на тике сводится к проходу по непрерывной памяти.
+ *
+ *  На тике перебираются только движущиеся собаки (moving). Время простоя стоящей
+ *  собаки не накапливается потиково: запоминается момент остановки, а срок ухода
+ *  из игры ставится в колесо таймеров. Поэтому скорость меняется только через SetSpeed.
+ */
+struct DogsState {
+    static constexpr std::uint32_t NOT_MOVING = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<double> pos_x;
+    std::vector<double> pos_y;
+    std::vector<double> prev_x;
+    std::vector<double> prev_y;
+    std::vector<double> speed_x;
+    std::vector<double> speed_y;
+    std::vector<Direction> direction;
+    std::vector<std::size_t> road_id;
+    // Доля тика, за которую собака прошла последнее перемещение: меньше 1, если она упёрлась в край дороги
+    std::vector<double> travel_time;
+    std::vector<double> game_time;
+    // Время простоя, накопленное до последней остановки
+    std::vector<double> retire_time;
+    // Момент последней остановки по часам сессии
+    std::vector<double> idle_since;
+    std::vector<std::uint8_t> need_to_retire;
+    // Позиция слота в moving или NOT_MOVING
+    std::vector<std::uint32_t> moving_pos;
+
+    // Слоты движущихся собак
+    std::vector<std::uint32_t> moving;
+    // Собаки, остановившиеся после прошлого тика: на следующем тике их предыдущее
+    // положение совмещается с текущим, чтобы сбор вещей не видел старого перемещения
+    std::vector<std::uint32_t> settling;
+    // Собаки, чей срок простоя истёк, ещё не забранные сессией
+    std::vector<std::uint32_t> expired;
+    TimerWheel retire_timers;
+    // Часы сессии, мс
+    double clock = 0.0;
+    double retire_limit = std::numeric_limits<double>::infinity();
+
+    // Добавляет слот со значениями по умолчанию и возвращает его номер
+    std::size_t Add();
+
+    std::size_t Size() const noexcept;
+
+    // Смещает собаку из слота slot на (dx, dy) по дорогам карты.
+    // Возвращает true, если собака упёрлась в край дороги; остановить её должен вызывающий.
+    bool Move(std::size_t slot, double dx, double dy, const Map& map);
+
+    // Меняет скорость, переводя собаку между движущимися и стоящими
+    void SetSpeed(std::size_t slot, double x, double y);
+
+    bool IsMoving(std::size_t slot) const noexcept;
+
+    double GetRetireTime(std::size_t slot) const noexcept;
+
+    void AddRetireTime(std::size_t slot, double delta);
+
+    void SetNeedToRetire(std::size_t slot, bool value);
+
+    // Предельное время простоя, мс. Сроки уже стоящих собак пересчитываются.
+    void SetRetireLimit(double limit);
+
+    // Продвигает часы сессии и помечает собак, чей срок простоя истёк
+    void AdvanceClock(double delta);
+
+private:
+    void ScheduleRetire(std::size_t slot);
+};
+
+// Собака хранит редко меняющиеся данные (имя, рюкзак, очки),
+// а положение, скорость и таймеры читает из DogsState своей сессии.
 class Dog {
 public:
 
-    Dog(std::uint64_t id, std::string name)
+    Dog(std::uint64_t id, std::string name, DogsState* state, std::size_t slot)
     : name_(std::move(name)),
         id_(id),
-        road_to_move_(nullptr)
+        state_(state),
+        slot_(slot)
     {}
 
     std::uint64_t GetId() const;
@@ -71,11 +149,11 @@ public:
 
     void SetPrevPosition(DogPosition pos);
 
-    void SetRoadToMove(Road* road); // for tests
+    void SetRoadId(std::size_t road_id);
 
-    Road* GetRoadToMove() const;
+    std::size_t GetRoadId() const;
 
-    void Move(double delta_time, const std::vector<Road>& roads);
+    void Move(double delta_time, const Map& map);
 
     void AddToBag(int obj_id, int type_id);
 
@@ -87,6 +165,9 @@ public:
 
     DogPosition GetPreviousPosition() const;
 
+    // Доля тика, за которую собака прошла путь от предыдущего положения до текущего
+    double GetTravelTime() const;
+
     void IncreaseScore(int value);
 
     void IncreaseBagScore(int value);
@@ -112,24 +193,11 @@ public:
 private:
     std::uint64_t id_;
     std::string name_;
-    DogPosition position_ = {};
-    DogPosition prev_position_ = {};
-    DogSpeed speed_ = {};
-    Direction direction_ = Direction::NORTH;
-    Road* road_to_move_;
+    DogsState* state_;
+    std::size_t slot_;
     Bag bag_;
     int score_ = 0;
     int bag_score_ = 0;
-    double game_time_ = .0;
-    double retire_time_ = .0;
-    bool need_to_retire_ = false;
-
-    bool CanMoveTo(const DogPosition& new_position, const Road* current_road) const;
-
-    void StopAtRoadBoundary(const Road* current_road, const DogPosition& new_position);
-
-    const std::vector<Road*> GetCurrentRoad(const std::vector<Road>& roads) const;
-
 };
 
 class DogRepr {
@@ -149,8 +217,16 @@ public:
     {
     }
 
-    [[nodiscard]] Dog Restore() const {
-        Dog dog{id_, name_};
+    std::uint64_t GetId() const {
+        return id_;
+    }
+
+    const std::string& GetName() const {
+        return name_;
+    }
+
+    // Переносит сохранённое состояние в собаку, уже добавленную в сессию
+    void Restore(Dog& dog) const {
         dog.SetPosition(position_);
         dog.SetPrevPosition(prev_position_);
         dog.SetSpeedAndDirection(speed_, direction_);
@@ -162,8 +238,6 @@ public:
         dog.IncreaseGameTime(game_time_);
         dog.IncreaseRetireTime(retire_time_);
         dog.SetNeedToRetire(need_to_retire_);
-
-        return dog;
     }
 
     template <typename Archive>
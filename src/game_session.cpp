@@ -1,20 +1,102 @@
 #include "game_session.h"
 
+#include <algorithm>
+
+namespace {
+
+// Размер ячейки сетки предметов: порядка пути собаки за тик
+const double GRID_CELL_SIZE = 4.0;
+
+// Собак в одном куске параллельного расчёта движения
+const std::size_t MOVE_CHUNK_SIZE = 512;
+
+template <typename T>
+void SortUnique(std::vector<T>& values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+template <typename T>
+void Append(std::vector<T>& to, const std::vector<T>& from) {
+    to.insert(to.end(), from.begin(), from.end());
+}
+
+} // namespace
+
+GameSession::GameSession(const Map* map, std::size_t instance)
+    : map_(map),
+    instance_(instance),
+    lost_objects_grid_(GRID_CELL_SIZE),
+    random_(rng::MakeStream(rng::StreamId(*map->GetId()) + instance))
+{
+}
+
 const Map* GameSession::GetMap() const {
     return map_;
 }
 
+std::size_t GameSession::GetInstance() const noexcept {
+    return instance_;
+}
+
+bool GameSession::TryTakeSeat(std::size_t max_players) noexcept {
+    std::size_t count = players_count_.load();
+    do {
+        if (max_players != 0 && count >= max_players) {
+            return false;
+        }
+    } while (!players_count_.compare_exchange_weak(count, count + 1));
+    return true;
+}
+
+void GameSession::TakeSeat() noexcept {
+    ++players_count_;
+}
+
+void GameSession::ReleaseSeat() noexcept {
+    --players_count_;
+}
+
+//! ------ SeatGuard ------
+
+SeatGuard::SeatGuard(GameSession* session) noexcept
+    : session_(session)
+{
+}
+
+SeatGuard::~SeatGuard() {
+    if (session_) {
+        session_->ReleaseSeat();
+    }
+}
+
+void SeatGuard::Dismiss() noexcept {
+    session_ = nullptr;
+}
+
+std::size_t GameSession::GetPlayersCount() const noexcept {
+    return players_count_.load();
+}
+
 uint64_t GameSession::GetDogsCount() const {
     return dogs_.size();
 }
 
+std::size_t GameSession::GetMovingDogsCount() const noexcept {
+    return dogs_state_.moving.size();
+}
+
 GameSession::Dogs* GameSession::GetDogs() {
     return &id_and_dogs_;
 }
 
-void GameSession::AddDog(Dog dog) {
-    dogs_.emplace_back(std::move(dog));
-    id_and_dogs_[dogs_.back().GetId()] = &dogs_.back();
+Dog& GameSession::AddDog(std::uint64_t id, std::string name) {
+    const std::size_t slot = dogs_state_.Add();
+    Dog& dog = dogs_.emplace_back(id, std::move(name), &dogs_state_, slot);
+    id_and_dogs_[id] = &dog;
+    open_changes_.dogs.push_back(id);
+    InvalidateStateSnapshot();
+    return dog;
 }
 
 std::map<uint64_t, std::string> GameSession::GetListIdWithName() const {
@@ -26,20 +108,208 @@ std::map<uint64_t, std::string> GameSession::GetListIdWithName() const {
     return players_list;
 }
 
-void GameSession::MoveDogs(double dog_retirment_time, double delta_time) {
-    for (const auto& [id, dog] : id_and_dogs_) {
-        if (dog->GetSpeed().x == .0 && dog->GetSpeed().y == .0) {
-            dog->IncreaseRetireTime(delta_time);
-            if (dog->GetRetireTime() >= dog_retirment_time) {
-                dog->SetNeedToRetire(true);
-            }
-        } else {
-            dog->Move(delta_time, map_->GetRoads());
-            dog->IncreaseGameTime(delta_time);
+void GameSession::MoveDogs(double delta_time, WorkStealingPool* pool) {
+    // Остановившиеся после прошлого тика собаки больше не перемещались
+    for (std::uint32_t slot : dogs_state_.settling) {
+        if (!dogs_state_.IsMoving(slot)) {
+            dogs_state_.prev_x[slot] = dogs_state_.pos_x[slot];
+            dogs_state_.prev_y[slot] = dogs_state_.pos_y[slot];
+        }
+    }
+    dogs_state_.settling.clear();
+
+    // Простой стоящих собак учитывается часами сессии и колесом таймеров.
+    // Собака с истёкшим сроком исчезает у клиентов.
+    const std::size_t expired_before = dogs_state_.expired.size();
+    dogs_state_.AdvanceClock(delta_time);
+    for (std::size_t i = expired_before; i < dogs_state_.expired.size(); ++i) {
+        open_changes_.dogs.push_back(dogs_[dogs_state_.expired[i]].GetId());
+    }
+
+    // Двигаются только собаки из списка движущихся; куски списка независимы друг от друга
+    const std::size_t count = dogs_state_.moving.size();
+    move_stopped_.assign(count, 0);
+    auto move_range = [&](std::size_t begin, std::size_t end) {
+        MoveDogsRange(begin, end, delta_time);
+    };
+    if (pool) {
+        pool->ParallelFor(count, MOVE_CHUNK_SIZE, move_range);
+    } else {
+        move_range(0, count);
+    }
+
+    // Упёршихся в край дороги останавливаем последовательно: это меняет список движущихся.
+    // Все двигавшиеся собаки изменились за тик.
+    stopped_slots_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        open_changes_.dogs.push_back(dogs_[dogs_state_.moving[i]].GetId());
+        if (move_stopped_[i]) {
+            stopped_slots_.push_back(dogs_state_.moving[i]);
         }
     }
+    for (std::uint32_t slot : stopped_slots_) {
+        dogs_state_.SetSpeed(slot, 0.0, 0.0);
+    }
+}
+
+void GameSession::MoveDogsRange(std::size_t begin, std::size_t end, double delta_time) {
+    const double MS_TO_SEC_COEF = 0.001;
+    const double dt = delta_time * MS_TO_SEC_COEF;
+
+    const std::uint32_t* moving = dogs_state_.moving.data();
+    for (std::size_t i = begin; i < end; ++i) {
+        const std::uint32_t slot = moving[i];
+        dogs_state_.game_time[slot] += delta_time;
+        move_stopped_[i] = dogs_state_.Move(slot, dogs_state_.speed_x[slot] * dt, dogs_state_.speed_y[slot] * dt, *map_);
+    }
 }
 
 std::deque<Dog>& GameSession::GetDogsList() {
     return dogs_;
-}
\ No newline at end of file
+}
+
+int GameSession::AddLostObject(double x, double y, Loot* loot) {
+    const int id = lost_objects_.Insert(LostObject(LostObjectPosition{x, y}, loot));
+    lost_objects_grid_.Insert(id, x, y);
+    open_changes_.lost_objects.push_back(id);
+    return id;
+}
+
+void GameSession::RestoreLostObject(int id, LostObject obj) {
+    if (const LostObject* old = lost_objects_.Find(id)) {
+        lost_objects_grid_.Remove(id, old->pos.x, old->pos.y);
+    }
+    if (!lost_objects_.InsertWithId(id, obj)) {
+        id = lost_objects_.Insert(obj);
+    }
+    lost_objects_grid_.Insert(id, obj.pos.x, obj.pos.y);
+    open_changes_.lost_objects.push_back(id);
+}
+
+void GameSession::RemoveLostObject(int id) {
+    if (const LostObject* obj = lost_objects_.Find(id)) {
+        lost_objects_grid_.Remove(id, obj->pos.x, obj->pos.y);
+        lost_objects_.Erase(id);
+        open_changes_.lost_objects.push_back(id);
+    }
+}
+
+const LostObject* GameSession::FindLostObject(int id) const {
+    return lost_objects_.Find(id);
+}
+
+const LostObjects& GameSession::GetLostObjects() const noexcept {
+    return lost_objects_;
+}
+
+std::size_t GameSession::GetLostObjectsCount() const noexcept {
+    return lost_objects_.Size();
+}
+
+const SpatialGrid& GameSession::GetLostObjectsGrid() const noexcept {
+    return lost_objects_grid_;
+}
+
+void GameSession::SetDogRetirementTime(double retirement_time) {
+    dogs_state_.SetRetireLimit(retirement_time);
+}
+
+void GameSession::TakeRetiredDogs(std::vector<Dog*>& dogs) {
+    for (std::uint32_t slot : dogs_state_.expired) {
+        dogs.push_back(&dogs_[slot]);
+    }
+    dogs_state_.expired.clear();
+}
+
+void GameSession::SetLootGenerator(loot_gen::LootGenerator loot_generator) {
+    loot_generator_ = std::move(loot_generator);
+    loot_generator_->SetRandomGenerator([this] {
+        return random_.NextDouble();
+    });
+}
+
+loot_gen::LootGenerator* GameSession::GetLootGenerator() {
+    return loot_generator_ ? &*loot_generator_ : nullptr;
+}
+
+const TickPhaseTimes& GameSession::GetLastTickPhases() const noexcept {
+    return last_tick_phases_;
+}
+
+void GameSession::SetLastTickPhases(const TickPhaseTimes& phases) noexcept {
+    last_tick_phases_ = phases;
+}
+
+void GameSession::AdvanceTick() {
+    SortUnique(open_changes_.dogs);
+    ++tick_;
+    // Изменения вытесняемого тика очищаются, их память переходит к следующему тику
+    StateChanges& changes = changes_history_[tick_ % STATE_CHANGES_TICKS];
+    changes.dogs.clear();
+    changes.lost_objects.clear();
+    std::swap(changes, open_changes_);
+    history_size_ = std::min(history_size_ + 1, STATE_CHANGES_TICKS);
+    InvalidateStateSnapshot();
+}
+
+std::uint64_t GameSession::GetTick() const noexcept {
+    return tick_;
+}
+
+const std::shared_ptr<const StateSnapshot>& GameSession::GetStateSnapshot() const noexcept {
+    return state_snapshot_;
+}
+
+void GameSession::SetStateSnapshot(std::shared_ptr<const StateSnapshot> snapshot) noexcept {
+    state_snapshot_ = std::move(snapshot);
+}
+
+void GameSession::InvalidateStateSnapshot() noexcept {
+    state_snapshot_.reset();
+    changes_snapshots_.clear();
+}
+
+void GameSession::MarkDogChanged(std::uint64_t id) {
+    InvalidateStateSnapshot();
+    // Без тиков (ручной режим) действия копятся долго: убираем повторы
+    if (open_changes_.dogs.size() > 2 * dogs_.size()) {
+        SortUnique(open_changes_.dogs);
+    }
+    open_changes_.dogs.push_back(id);
+}
+
+std::optional<StateChanges> GameSession::GetChangesSince(std::uint64_t since) const {
+    if (since > tick_ || tick_ - since > history_size_) {
+        return std::nullopt;
+    }
+    StateChanges result = open_changes_;
+    for (std::uint64_t tick = since + 1; tick <= tick_; ++tick) {
+        const StateChanges& changes = changes_history_[tick % STATE_CHANGES_TICKS];
+        Append(result.dogs, changes.dogs);
+        Append(result.lost_objects, changes.lost_objects);
+    }
+    SortUnique(result.dogs);
+    SortUnique(result.lost_objects);
+    return result;
+}
+
+std::shared_ptr<const StateSnapshot> GameSession::FindChangesSnapshot(std::uint64_t since) const noexcept {
+    for (const auto& snapshot : changes_snapshots_) {
+        if (snapshot->since == since) {
+            return snapshot;
+        }
+    }
+    return nullptr;
+}
+
+void GameSession::AddChangesSnapshot(std::shared_ptr<const StateSnapshot> snapshot) {
+    changes_snapshots_.push_back(std::move(snapshot));
+}
+
+rng::Xoshiro256& GameSession::GetRandom() noexcept {
+    return random_;
+}
+
+GatherBuffers& GameSession::GetGatherBuffers() noexcept {
+    return gather_buffers_;
+}
@@ -1,36 +1,234 @@
 #pragma once
 
+#include "collision_detector.h"
 #include "dog.h"
+#include "loot_generator.h"
+#include "random.h"
+#include "spatial_grid.h"
+#include "work_stealing_pool.h"
 
+#include <atomic>
 #include <deque>
 #include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Время фаз последнего тика сессии, мс
+struct TickPhaseTimes {
+    double spawn = 0.0;
+    double move = 0.0;
+    double collect = 0.0;
+    // Уход игроков и запись их результатов в базу, заполняются Application::TickSession
+    double retire = 0.0;
+    double db_write = 0.0;
+};
+
+// Состояние сессии для запросов /api/v1/game/state, сериализованное после тика tick.
+// Неизменяемо: одно тело делят все ответы, пока состояние сессии не изменится.
+struct StateSnapshot {
+    std::uint64_t tick = 0;
+    // Задан у ответа с изменениями: тело содержит только то, что изменилось после тика since
+    std::optional<std::uint64_t> since;
+    std::string body;
+};
+
+// id собак и потерянных вещей, которые появились, изменились или исчезли
+struct StateChanges {
+    std::vector<std::uint64_t> dogs;
+    std::vector<int> lost_objects;
+};
+
+// Рабочие массивы фазы сбора тика (Game::CollectLostObjects). Живут в сессии и очищаются
+// без освобождения памяти, чтобы тик не выделял их заново.
+struct GatherBuffers {
+    // Собиратели и предметы
+    std::vector<Dog*> dogs;
+    std::vector<model::collision_detector::Gatherer> gatherers;
+    std::vector<model::collision_detector::Item> items;
+    std::vector<int> lost_object_ids;
+    std::vector<std::size_t> candidate_begin;
+    std::vector<std::size_t> candidates;
+    // Широкая фаза
+    std::vector<std::vector<SpatialGrid::Item>> chunk_loot;
+    std::vector<std::size_t> loot_end;
+    std::vector<std::size_t> loot_candidates;
+    // Номер вещи среди предметов по слоту её id; запись действительна, только если
+    // loot_item_stamp[слот] равен loot_stamp текущего тика, так что массивы не чистятся
+    std::vector<std::size_t> loot_item_index;
+    std::vector<std::uint32_t> loot_item_stamp;
+    std::uint32_t loot_stamp = 0;
+    std::vector<std::size_t> office_items;
+    std::vector<std::size_t> office_seen;
+    // Узкая фаза и применение событий
+    std::vector<std::vector<model::collision_detector::GatheringEvent>> chunk_events;
+    std::vector<model::collision_detector::GatherScratch> chunk_scratch;
+    std::vector<model::collision_detector::GatheringEvent> events;
+    std::vector<char> collected;
+};
+
+// Сколько последних тиков помнит сессия для ответов с изменениями; клиент, отставший сильнее, получает полное состояние
+inline constexpr std::size_t STATE_CHANGES_TICKS = 64;
 
 class GameSession {
 public:
     using Dogs = std::map<std::uint64_t, Dog*>;
 
+    // Собаки ссылаются на dogs_state_ сессии, поэтому сессия не копируется
+    GameSession(const GameSession&) = delete;
     GameSession& operator=(const GameSession&) = delete;
 
-    explicit GameSession(const Map* map) 
-    : map_(map)
-    {}
+    // instance — номер экземпляра сессии среди сессий той же карты
+    explicit GameSession(const Map* map, std::size_t instance = 0);
 
     const Map* GetMap() const;
 
+    std::size_t GetInstance() const noexcept;
+
+    // Места игроков. Занимаются координатором при входе, освобождаются при уходе игрока
+    // в strand сессии, поэтому счётчик атомарный. max_players == 0 — без ограничения.
+    bool TryTakeSeat(std::size_t max_players) noexcept;
+
+    // Занимает место без проверки вместимости (восстановление сохранённой игры)
+    void TakeSeat() noexcept;
+
+    void ReleaseSeat() noexcept;
+
+    std::size_t GetPlayersCount() const noexcept;
+
     uint64_t GetDogsCount() const;
 
+    std::size_t GetMovingDogsCount() const noexcept;
+
     Dogs* GetDogs();
 
     std::deque<Dog>& GetDogsList();
 
-    void AddDog(Dog dog);
+    // Создаёт собаку в новом слоте сессии
+    Dog& AddDog(std::uint64_t id, std::string name);
 
     std::map<uint64_t, std::string> GetListIdWithName() const;
 
-    void MoveDogs(double dog_retirment_time, double delta_time);
-    
+    // Если задан pool, собаки двигаются кусками в его потоках
+    void MoveDogs(double delta_time, WorkStealingPool* pool = nullptr);
+
+    // Предельное время простоя собаки, мс
+    void SetDogRetirementTime(double retirement_time);
+
+    // Добавляет в dogs собак, чей срок простоя истёк после прошлого вызова
+    void TakeRetiredDogs(std::vector<Dog*>& dogs);
+
+    // Потерянные вещи у каждого экземпляра сессии свои, сетка для поиска обновляется вместе с ними
+    int AddLostObject(double x, double y, Loot* loot);
+
+    // Восстанавливает вещь под сохранённым id. Если место этого id занято другой вещью,
+    // восстановленная получает новый id.
+    void RestoreLostObject(int id, LostObject obj);
+
+    void RemoveLostObject(int id);
+
+    const LostObject* FindLostObject(int id) const;
+
+    // Обход без копирования: for (const auto& [id, obj] : GetLostObjects())
+    const LostObjects& GetLostObjects() const noexcept;
+
+    std::size_t GetLostObjectsCount() const noexcept;
+
+    const SpatialGrid& GetLostObjectsGrid() const noexcept;
+
+    // У каждой сессии свой генератор: сессии обновляются независимо друг от друга.
+    // Случайные числа генератор берёт из потока сессии.
+    void SetLootGenerator(loot_gen::LootGenerator loot_generator);
+
+    loot_gen::LootGenerator* GetLootGenerator();
+
+    // Заполняется Game::UpdateSession, читается в strand сессии
+    const TickPhaseTimes& GetLastTickPhases() const noexcept;
+
+    void SetLastTickPhases(const TickPhaseTimes& phases) noexcept;
+
+    // Завершает тик: сохраняет изменения тика в историю и сбрасывает снимки состояния.
+    // Номер тика — сколько раз сессия обновлялась.
+    void AdvanceTick();
+
+    std::uint64_t GetTick() const noexcept;
+
+    // Снимок состояния, построенный после последнего изменения сессии; nullptr — его нужно построить.
+    // Тик, вход и действия игроков, как и запросы состояния, выполняются в strand сессии.
+    const std::shared_ptr<const StateSnapshot>& GetStateSnapshot() const noexcept;
+
+    void SetStateSnapshot(std::shared_ptr<const StateSnapshot> snapshot) noexcept;
+
+    // Сбрасывает снимки состояния: сессия изменилась между тиками
+    void InvalidateStateSnapshot() noexcept;
+
+    // Собака изменилась между тиками: действие игрока. Сбрасывает снимки состояния.
+    void MarkDogChanged(std::uint64_t id);
+
+    // Изменения после тика since, включая изменения между тиками после последнего тика.
+    // nullopt — история since уже не хранится или since из будущего (например, после перезапуска сервера).
+    std::optional<StateChanges> GetChangesSince(std::uint64_t since) const;
+
+    // Ответ с изменениями после since, построенный после последнего изменения сессии; nullptr — его нужно построить
+    std::shared_ptr<const StateSnapshot> FindChangesSnapshot(std::uint64_t since) const noexcept;
+
+    void AddChangesSnapshot(std::shared_ptr<const StateSnapshot> snapshot);
+
+    // Поток случайных чисел сессии. Зависит от общего зерна и id карты, используется в strand сессии.
+    rng::Xoshiro256& GetRandom() noexcept;
+
+    // Используются только в тике сессии
+    GatherBuffers& GetGatherBuffers() noexcept;
+
 private:
+    void MoveDogsRange(std::size_t begin, std::size_t end, double delta_time);
+
+    // Холодные данные собак: имя, рюкзак, очки
     std::deque<Dog> dogs_;
     Dogs id_and_dogs_;
+    // Горячие данные собак, индексируются номером слота
+    DogsState dogs_state_;
+    // Флаги остановки для позиций списка движущихся, заполняются на тике
+    std::vector<std::uint8_t> move_stopped_;
+    std::vector<std::uint32_t> stopped_slots_;
     const Map* map_;
+    std::size_t instance_;
+    std::atomic<std::size_t> players_count_ = 0;
+    LostObjects lost_objects_;
+    SpatialGrid lost_objects_grid_;
+    std::optional<loot_gen::LootGenerator> loot_generator_;
+    rng::Xoshiro256 random_;
+    TickPhaseTimes last_tick_phases_;
+    std::uint64_t tick_ = 0;
+    std::shared_ptr<const StateSnapshot> state_snapshot_;
+    std::vector<std::shared_ptr<const StateSnapshot>> changes_snapshots_;
+    GatherBuffers gather_buffers_;
+
+    // Изменения текущего тика. Собаки записываются там, где меняются: движение, остановка,
+    // действия игроков, вход и истечение срока простоя; стоящие собаки тик не удорожают.
+    StateChanges open_changes_;
+    // Изменения тика t хранятся в changes_history_[t % STATE_CHANGES_TICKS]
+    std::vector<StateChanges> changes_history_ = std::vector<StateChanges>(STATE_CHANGES_TICKS);
+    // Сколько последних тиков есть в истории
+    std::size_t history_size_ = 0;
+};
+
+// Место, занятое в сессии под входящего игрока. Возвращается сессии при разрушении,
+// если вход не состоялся: ошибка в запросе или исключение до добавления игрока.
+class SeatGuard {
+public:
+    // session == nullptr — места нет, охранять нечего
+    explicit SeatGuard(GameSession* session) noexcept;
+
+    SeatGuard(const SeatGuard&) = delete;
+    SeatGuard& operator=(const SeatGuard&) = delete;
+
+    ~SeatGuard();
+
+    // Игрок вошёл: место теперь принадлежит ему и освобождается при его уходе
+    void Dismiss() noexcept;
+
+private:
+    GameSession* session_;
 };
@@ -1,35 +1,15 @@
 #include "http_server.h"
 
+#include "async_log.h"
+
 #include <boost/asio/dispatch.hpp>
-#include <boost/log/core.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/expressions.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
-#include <boost/log/utility/setup/console.hpp>
-#include <boost/log/utility/manipulators/add_value.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/json.hpp>
 #include <iostream>
 #include <string>
 
-BOOST_LOG_ATTRIBUTE_KEYWORD(additional_data, "AdditionalData", boost::json::value)
-BOOST_LOG_ATTRIBUTE_KEYWORD(custom_message, "CustomMessage", std::string)
-
 namespace http_server {
 
 void ReportError(beast::error_code ec, std::string_view what) {
-    using namespace std::literals;
-    namespace keywords = boost::log::keywords;
-    namespace logging = boost::log;
-    namespace json = boost::json;
-
-    json::value entry{
-        {"code"s, ec.value()},
-        {"text"s, ec.message()},
-        {"where"s, std::move(what)}
-    };
-
-    BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "error"); 
+    async_log::LogError(ec.value(), ec.message(), what);
 }
 
 void SessionBase::Run() {
@@ -3,6 +3,7 @@
 // boost.beast будет использовать std::string_view вместо boost::string_view
 #define BOOST_BEAST_USE_STD_STRING_VIEW
 
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
@@ -44,10 +45,13 @@ protected:
         auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
 
         auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response,
-                          [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                              self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                          });
+        // Ответ может быть готов в strand игровой сессии, а работать с stream_ можно только в его executor
+        net::dispatch(stream_.get_executor(), [safe_response, self] {
+            http::async_write(self->stream_, *safe_response,
+                              [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
+                                  self->OnWrite(safe_response->need_eof(), ec, bytes_written);
+                              });
+        });
     }
 
     beast::tcp_stream& GetStream() {
@@ -97,7 +101,7 @@ private:
         // Захватываем умный указатель на текущий объект Session в лямбде,
         // чтобы продлить время жизни сессии до вызова лямбды.
         // Используется generic-лямбда функция, способная принять response произвольного типа
-        request_handler_(std::move(request), [&endpoint, self = this->shared_from_this()](auto&& response) {
+        request_handler_(std::move(request), [self = this->shared_from_this()](auto&& response) {
             self->Write(std::move(response));
         }, endpoint);
     }
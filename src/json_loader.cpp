@@ -123,6 +123,36 @@ void SetLootGenerator(const json::object loot_generator, model::Game* game) {
     game->SetLootGenerator(loot_generator.at("period").as_double(), loot_generator.at("probability").as_double());
 }
 
+json::object GetDogState(Dog& dog) {
+    json::object state;
+    auto speed = dog.GetSpeed();
+    auto pos = dog.GetPosition();
+    state["pos"] = json::array{pos.x, pos.y};
+    state["speed"] = json::array{speed.x, speed.y};
+    std::string dir_to_string;
+    dir_to_string += static_cast<char>(dog.GetDirection());
+    state["dir"] = dir_to_string;
+
+    json::array bag;
+    for (const auto& [obj_id, type_id] : dog.GetBag()) {
+        json::object obj;
+        obj["id"] = obj_id;
+        obj["type"] = type_id;
+        bag.emplace_back(obj);
+    }
+
+    state["bag"] = bag;
+    state["score"] = dog.GetScore();
+    return state;
+}
+
+json::object GetLostObjectState(const LostObject& lost_object) {
+    json::object lost;
+    lost["type"] = lost_object.loot->GetLootType();
+    lost["pos"] = json::array{lost_object.pos.x, lost_object.pos.y};
+    return lost;
+}
+
 } //namespace
 
 
@@ -173,6 +203,7 @@ void LoadGame(model::Game& game, const std::filesystem::path& json_path) {
         FillMapWithRoads(map_j, map);
         FillMapWithBuildings(map_j, map);
         FillMapWithOffices(map_j, map);
+        map.BuildIndexes(model::OFFICE_REACH);
 
         game.AddMap(map);
     }
@@ -210,42 +241,66 @@ std::string GetSerializedMap(const Map& map)
     return json::serialize(obj);
 }
 
-std::string GetSerialezedJoinBody(const std::string& auth_token, const std::uint64_t id) {
-    json::object obj;
-    obj["authToken"] = auth_token;
-    obj["playerId"] = id;
+std::string GetSerializedSessionState(GameSession& session)
+{
+    json::object result;
+    json::object players;
 
-    return json::serialize(obj);
+    for (const auto& [id, dog] : *session.GetDogs()) {
+        if (dog->IsNeedToRetire()) {
+            continue;
+        }
+        players[std::to_string(id)] = GetDogState(*dog);
+    }
+
+    json::object lost_objects;
+    for (const auto& [id, lost_object] : session.GetLostObjects()) {
+        lost_objects[std::to_string(id)] = GetLostObjectState(lost_object);
+    }
+
+    result["players"] = players;
+    result["lostObjects"] = lost_objects;
+    return json::serialize(result);
 }
 
-std::string GetLogRequest(std::string& ip, std::string& uri, std::string& method) {
-    json::array entry;
-    json::object message;
-    message["message"] = "request received";
-    entry.emplace_back(message);
+std::string GetSerializedSessionChanges(GameSession& session, const StateChanges& changes)
+{
+    json::object players;
+    json::array removed_players;
+    auto& dogs = *session.GetDogs();
+    for (std::uint64_t id : changes.dogs) {
+        auto it = dogs.find(id);
+        if (it == dogs.end() || it->second->IsNeedToRetire()) {
+            removed_players.emplace_back(std::to_string(id));
+        } else {
+            players[std::to_string(id)] = GetDogState(*it->second);
+        }
+    }
 
-    json::object data;
-    data["ip"] = ip;
-    data["URI"] = uri;
-    data["method"] = method;
-    entry.emplace_back(data);
+    json::object lost_objects;
+    json::array removed_lost_objects;
+    for (int id : changes.lost_objects) {
+        if (const LostObject* lost_object = session.FindLostObject(id)) {
+            lost_objects[std::to_string(id)] = GetLostObjectState(*lost_object);
+        } else {
+            removed_lost_objects.emplace_back(std::to_string(id));
+        }
+    }
 
-    return json::serialize(entry);
+    json::object result;
+    result["players"] = players;
+    result["lostObjects"] = lost_objects;
+    result["removedPlayers"] = removed_players;
+    result["removedLostObjects"] = removed_lost_objects;
+    return json::serialize(result);
 }
 
-std::string GetLogResponse(int response_time, int code, std::string content_type/* = "null"*/) {
-    json::array entry;
-    json::object message;
-    message["message"] = "response sent";
-    entry.emplace_back(message);
-    
-    json::object data;
-    data["response_time"] = response_time;
-    data["code"] = code;
-    data["content_type"] = content_type;
-    entry.emplace_back(data);
+std::string GetSerialezedJoinBody(const std::string& auth_token, const std::uint64_t id) {
+    json::object obj;
+    obj["authToken"] = auth_token;
+    obj["playerId"] = id;
 
-    return json::serialize(entry);
+    return json::serialize(obj);
 }
 
 }  // namespace json_loader
\ No newline at end of file
@@ -15,10 +15,13 @@ std::string GetSerializedMaps(const model::Maps& maps);
 
 std::string GetSerializedMap(const Map& map);
 
-std::string GetSerialezedJoinBody(const std::string& auth_token, const std::uint64_t id);
+// Состояние сессии для ответа /api/v1/game/state: собаки, ещё не ушедшие из игры, и потерянные вещи
+std::string GetSerializedSessionState(GameSession& session);
 
-std::string GetLogRequest(std::string& ip, std::string& uri, std::string& method);
+// Ответ с изменениями для /api/v1/game/state?since=: собаки и вещи из changes, которые есть в сессии,
+// в "players" и "lostObjects", исчезнувшие — в "removedPlayers" и "removedLostObjects"
+std::string GetSerializedSessionChanges(GameSession& session, const StateChanges& changes);
 
-std::string GetLogResponse(int response_time, int code, std::string content_type = "null");
+std::string GetSerialezedJoinBody(const std::string& auth_token, const std::uint64_t id);
 
 }  // namespace json_loader
@@ -35,6 +35,10 @@ public:
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    void SetRandomGenerator(RandomGenerator random_gen) {
+        random_generator_ = std::move(random_gen);
+    }
+
 private:
     static double DefaultGenerator() noexcept {
         return 1.0;
@@ -11,7 +11,9 @@
 #include <iostream>
 #include <thread>
 
+#include "metrics_server.h"
 #include "request_handler.h"
+#include "random.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
@@ -40,9 +42,22 @@ struct Args {
     int tick = -1;
     std::string config;
     std::string static_files;
+    // Пакет статики вместо каталога www-root
+    std::string static_bundle;
     bool random_spawn = false;
     std::string state_file;
     int save_state_period = -1;
+    unsigned sim_threads = 1;
+    bool fixed_timestep = false;
+    unsigned max_catch_up_steps = 5;
+    std::optional<std::uint64_t> seed;
+    std::size_t max_players_per_session = 0;
+    bool tick_stats = false;
+    std::optional<net::ip::port_type> metrics_port;
+    async_log::Options log;
+    // 0 — кэш статики выключен
+    std::uintmax_t static_cache_size = 256 * 1024 * 1024;
+    unsigned static_max_age = 0;
 }; 
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
@@ -50,15 +65,31 @@ struct Args {
     po::options_description desc{"Allowed options"s};
 
     Args args;
+    std::string log_level = "info"s;
     desc.add_options()
         // Добавляем опцию --help и её короткую версию -h
         ("help,h", "produce help message")
         ("tick-period,t", po::value(&args.tick)->value_name("milliseconds"s), "set tick period")
         ("config-file,c", po::value(&args.config)->value_name("file"s), "set config file path")
         ("www-root,w", po::value(&args.static_files)->value_name("dir"s), "set static files root")
+        ("www-bundle", po::value(&args.static_bundle)->value_name("file"s), "serve static files from a bundle built by the static_bundle target instead of www-root")
         ("randomize-spawn-points", "spawn dogs at random positions")
         ("state-file", po::value(&args.state_file)->value_name("dir"s), "set state file")
-        ("save-state-period", po::value(&args.save_state_period)->value_name("milliseconds"s), "set period to autosave to state file");
+        ("save-state-period", po::value(&args.save_state_period)->value_name("milliseconds"s), "set period to autosave to state file")
+        ("sim-threads", po::value(&args.sim_threads)->value_name("count"s), "set number of threads to compute game tick")
+        ("fixed-timestep", "run ticks with fixed step of tick period on a dedicated scheduler thread")
+        ("max-catch-up-steps", po::value(&args.max_catch_up_steps)->value_name("count"s), "set max number of late steps to run at once in fixed timestep mode")
+        ("seed", po::value<std::uint64_t>()->value_name("number"s), "set seed of game random number generators")
+        ("max-players-per-session", po::value(&args.max_players_per_session)->value_name("count"s), "set max number of players in one session instance of a map (0 - unlimited)")
+        ("tick-stats", "measure tick phases and expose them at /api/v1/admin/tick-stats")
+        ("metrics-port", po::value<net::ip::port_type>()->value_name("port"s), "serve Prometheus metrics at /metrics on a separate port")
+        ("log-level", po::value(&log_level)->value_name("level"s), "set min log level: debug, info, warning, error or off")
+        ("log-file", po::value(&args.log.file)->value_name("file"s), "write log to file instead of stderr")
+        ("log-file-max-size", po::value(&args.log.max_file_size)->value_name("bytes"s), "rotate log file when it grows past the size")
+        ("log-files", po::value(&args.log.max_files)->value_name("count"s), "set number of rotated log files to keep")
+        ("log-sample-rate", po::value(&args.log.sample_rate)->value_name("fraction"s), "log only a fraction of requests, e.g. 0.1 for every tenth")
+        ("static-cache-size", po::value(&args.static_cache_size)->value_name("bytes"s), "set memory limit of static files cache (0 - serve files from disk)")
+        ("static-max-age", po::value(&args.static_max_age)->value_name("seconds"s), "set max-age of static files for browsers (0 - revalidate with ETag on every use)");
 
     // variables_map хранит значения опций после разбора
     po::variables_map vm;
@@ -75,12 +106,29 @@ struct Args {
     if (!vm.contains("config-file"s)) {
         throw std::runtime_error("Config files have not been specified"s);
     }
-    if (!vm.contains("www-root"s)) {
+    if (!vm.contains("www-root"s) && !vm.contains("www-bundle"s)) {
         throw std::runtime_error("Static files have not been specified"s);
     }
     if (vm.contains("randomize-spawn-points")) {
         args.random_spawn = true;
     }
+    if (vm.contains("seed"s)) {
+        args.seed = vm["seed"s].as<std::uint64_t>();
+    }
+    if (vm.contains("fixed-timestep"s)) {
+        args.fixed_timestep = true;
+    }
+    if (vm.contains("tick-stats"s)) {
+        args.tick_stats = true;
+    }
+    if (vm.contains("metrics-port"s)) {
+        args.metrics_port = vm["metrics-port"s].as<net::ip::port_type>();
+    }
+    if (auto level = async_log::ParseLevel(log_level)) {
+        args.log.level = *level;
+    } else {
+        throw std::runtime_error("Unknown log level "s + log_level);
+    }
     if (vm.contains("save-state-period") && !vm.contains("state-file"s)) {
         args.save_state_period = -1;
     }
@@ -98,19 +146,27 @@ int main(int argc, const char* argv[]) {
     }
 
     auto args = ParseCommandLine(argc, argv);
+    if (!args) {
+        return EXIT_SUCCESS;
+    }
+    // Журнал пишется отдельным потоком до самого выхода
+    async_log::GetLogger().Start(args->log);
     
+    // Зерно задаётся до создания сессий: от него зависят их потоки случайных чисел
+    if (args->seed) {
+        rng::SetSeed(*args->seed);
+    }
+
     // Загружаем карту из файла и построить модель игры
     model::Game game;
     json_loader::LoadGame(game, std::filesystem::path(args->config));
+    game.SetSimulationThreads(args->sim_threads);
+    game.SetMaxPlayersPerSession(args->max_players_per_session);
 
     // Инициализируем io_context
     const unsigned num_threads = std::thread::hardware_concurrency();
     net::io_context ioc(num_threads);
 
-    // Создаём обработчик HTTP-запросов, связываем его с моделью игры
-    // strand для выполнения запросов к API
-    auto api_strand = net::make_strand(ioc);
-
     ConnectionPool conn_pool{num_threads, 
     [db_url] {
         auto conn = std::make_shared<pqxx::connection>(db_url);
@@ -134,6 +190,9 @@ int main(int argc, const char* argv[]) {
     }};
     
     Application app{&game, &conn_pool};
+    if (args->tick_stats) {
+        app.SetTickProfiler(std::make_shared<TickProfiler>());
+    }
     std::shared_ptr<http_handler::SerializationListener> srl_listener = nullptr;
     if (!args->state_file.empty()) {
         srl_listener = std::make_shared<http_handler::SerializationListener>();
@@ -153,21 +212,32 @@ int main(int argc, const char* argv[]) {
     } else {
         app.SetApplicationListener(nullptr);
     }
-    auto handler = std::make_shared<http_handler::RequestHandler>(game, api_strand, app);
+    // Создаём обработчик HTTP-запросов, связываем его с моделью игры.
+    // У каждой игровой сессии будет свой strand, глобальные операции идут через strand координатора
+    auto handler = std::make_shared<http_handler::RequestHandler>(game, ioc, app);
     auto logging_handler = std::make_shared<http_handler::LoggingRequestHandler<http_handler::RequestHandler>>(*handler);
 
     if (args->random_spawn) {
         handler->SetRandomize();
     }
+    if (!args->static_bundle.empty()) {
+        handler->UseStaticBundle(static_bundle::Bundle::Open(args->static_bundle));
+    } else if (args->static_cache_size > 0) {
+        static_cache::StaticCache::Options cache_options;
+        cache_options.max_size = args->static_cache_size;
+        cache_options.max_file_size = std::min(cache_options.max_file_size, args->static_cache_size);
+        handler->EnableStaticCache(args->static_files, cache_options);
+    }
+    handler->SetStaticMaxAge(std::chrono::seconds{args->static_max_age});
 
     if (args->tick != -1) {
         std::chrono::duration<int, std::milli> chrono_milliseconds{ args->tick };
-        auto ticker = std::make_shared<http_handler::Ticker>(api_strand, std::chrono::duration_cast<std::chrono::milliseconds>(chrono_milliseconds),
-            [self = handler->shared_from_this()](std::chrono::milliseconds delta) { 
-                self->Update(delta.count()); 
-            }
-        );
-        ticker->Start();
+        const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(chrono_milliseconds);
+        if (args->fixed_timestep) {
+            handler->StartFixedStepTicker(period, args->max_catch_up_steps);
+        } else {
+            handler->StartTicker(period);
+        }
     }
 
     try {
@@ -184,6 +254,13 @@ int main(int argc, const char* argv[]) {
         constexpr net::ip::port_type port = 8080;
         std::string root_path = args->static_files;
 
+        // Метрики слушают свой порт в своём потоке и не конкурируют с игровыми запросами
+        std::unique_ptr<MetricsServer> metrics_server;
+        if (args->metrics_port) {
+            metrics_server = std::make_unique<MetricsServer>(address, *args->metrics_port, metrics::GetRegistry());
+            metrics_server->Start();
+        }
+
         logging_handler->LogStartServer(address, port);
         http_server::ServeHttp(ioc, {address, port}, [self = logging_handler->shared_from_this(), &root_path](auto&& req, auto&& send, 
                                                                                                                 boost::asio::ip::tcp::endpoint& endpoint) 
@@ -194,11 +271,17 @@ int main(int argc, const char* argv[]) {
         RunWorkers(std::max(1u, num_threads), [&ioc] {
             ioc.run();
         });
-        
+        handler->StopTicker();
+        if (metrics_server) {
+            metrics_server->Stop();
+        }
+
         app.SaveState();
     } catch (const std::exception& ex) {
         logging_handler->LogStopServer(EXIT_FAILURE, ex.what());
+        async_log::GetLogger().Stop();
         return EXIT_FAILURE;
     }
     logging_handler->LogStopServer(0);
+    async_log::GetLogger().Stop();
 }
@@ -1,5 +1,6 @@
 #include "map.h"
 
+#include <cmath>
 #include <iostream>
 
 //! -------------------------Road --------------------------------
@@ -62,10 +63,86 @@ const Map::Offices& Map::GetOffices() const noexcept {
     return offices_;
 }
 
+const RoadIndex& Map::GetRoadIndex() const noexcept {
+    return road_index_;
+}
+
+const RoadGraph& Map::GetRoadGraph() const noexcept {
+    return road_graph_;
+}
+
 void Map::AddRoad(const Road& road) {
     roads_.emplace_back(road);
 }
 
+void Map::BuildRoadIndex() {
+    road_index_.Build(roads_, map_const::HALF_OF_ROAD);
+}
+
+void Map::BuildRoadGraph() {
+    road_graph_.Build(road_index_);
+}
+
+void Map::BuildSpawnTable() {
+    std::vector<double> lengths;
+    lengths.reserve(roads_.size());
+    for (const auto& road : roads_) {
+        lengths.push_back(std::abs(road.GetEnd().x - road.GetStart().x) + std::abs(road.GetEnd().y - road.GetStart().y));
+    }
+    spawn_table_ = AliasTable(lengths);
+}
+
+void Map::BuildRoadOffices(double reach) {
+    road_offices_begin_.assign(1, 0);
+    road_offices_.clear();
+    for (std::size_t road_id = 0; road_id < road_index_.GetRoadsCount(); ++road_id) {
+        const RoadBounds& bounds = road_index_.GetBounds(road_id);
+        for (std::size_t i = 0; i < offices_.size(); ++i) {
+            const double x = offices_[i].GetPosition().x - offices_[i].GetOffset().dx;
+            const double y = offices_[i].GetPosition().y - offices_[i].GetOffset().dy;
+            if (x >= bounds.min_x - reach && x <= bounds.max_x + reach
+                && y >= bounds.min_y - reach && y <= bounds.max_y + reach) {
+                road_offices_.push_back(RoadOffice{x, y, static_cast<std::uint32_t>(i)});
+            }
+        }
+        road_offices_begin_.push_back(static_cast<std::uint32_t>(road_offices_.size()));
+    }
+}
+
+void Map::BuildIndexes(double office_reach) {
+    BuildRoadIndex();
+    BuildRoadGraph();
+    BuildSpawnTable();
+    BuildRoadOffices(office_reach);
+}
+
+std::span<const Map::RoadOffice> Map::GetRoadOffices(std::size_t road_id) const noexcept {
+    if (road_id + 1 >= road_offices_begin_.size()) {
+        return {};
+    }
+    return std::span<const RoadOffice>(road_offices_).subspan(road_offices_begin_[road_id],
+                                                               road_offices_begin_[road_id + 1] - road_offices_begin_[road_id]);
+}
+
+bool Map::HasRoadOffices() const noexcept {
+    return road_offices_begin_.size() == road_index_.GetRoadsCount() + 1;
+}
+
+void Map::SampleRoadPoints(rng::Xoshiro256& random, std::span<LostObjectPosition> out) const {
+    if (out.empty()) {
+        return;
+    }
+    if (roads_.empty() || spawn_table_.Size() != roads_.size()) {
+        throw std::logic_error("Spawn table is not built for map " + *id_);
+    }
+    for (auto& point : out) {
+        const Road& road = roads_[spawn_table_.Sample(random)];
+        const double t = random.NextDouble();
+        point.x = road.GetStart().x + (road.GetEnd().x - road.GetStart().x) * t;
+        point.y = road.GetStart().y + (road.GetEnd().y - road.GetStart().y) * t;
+    }
+}
+
 void Map::AddBuilding(const Building& building) {
     buildings_.emplace_back(building);
 }
@@ -113,30 +190,6 @@ Loot* Map::GetLootTypeByPos(int idx) {
     return &loot_types_.at(idx);
 }
 
-void Map::AddLootOnMap(double x, double y, Loot* loot) {
-    lost_objects_[lost_objects_.size() + founded_obj_.size()] = LostObject(LostObjectPosition{x, y}, loot);
-}
-
-size_t Map::GetLostObjectsCount() const noexcept {
-    return lost_objects_.size();
-}
-
-std::unordered_map<int, LostObject> Map::GetLostObjects() const {
-    return lost_objects_;
-}
-
-void Map::RemoveCollectedObj(int id) noexcept {
-    if (lost_objects_.count(id)) {
-        founded_obj_.push_back(id);
-        lost_objects_.erase(id);
-    }
-}
-
-void Map::SetLostObject(int id, LostObject obj)
-{
-    lost_objects_[id] = obj;
-}
-
 int Map::GetBagCapacity() const noexcept {
     return bag_capacity_;
 }
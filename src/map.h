@@ -1,9 +1,15 @@
 #pragma once
 
 #include "tagged.h"
+#include "alias_table.h"
 #include "extra_data.h"
+#include "road_graph.h"
+#include "road_index.h"
+#include "slot_map.h"
 
+#include <cstdint>
 #include <deque>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -49,6 +55,8 @@ struct LostObject {
     Loot* loot;
 };
 
+using LostObjects = SlotMap<LostObject>;
+
 struct LostObjectRepr {
     LostObjectPosition pos;
     int type;
@@ -158,10 +166,47 @@ public:
 
     const Roads& GetRoads() const noexcept;
 
+    const RoadIndex& GetRoadIndex() const noexcept;
+
+    const RoadGraph& GetRoadGraph() const noexcept;
+
     const Offices& GetOffices() const noexcept;
 
     void AddRoad(const Road& road);
 
+    // Строит пространственный индекс дорог, вызывается после добавления всех дорог
+    void BuildRoadIndex();
+
+    // Строит граф перекрёстков, вызывается после BuildRoadIndex
+    void BuildRoadGraph();
+
+    // Строит таблицу выбора дорог с весом по длине, вызывается после добавления всех дорог
+    void BuildSpawnTable();
+
+    // Офис рядом с дорогой, позиция уже смещена на offset
+    struct RoadOffice {
+        double x;
+        double y;
+        std::uint32_t office_idx;
+    };
+
+    // Для каждой дороги запоминает офисы, до которых можно дотянуться с неё на расстояние reach.
+    // Вызывается после добавления дорог, офисов и BuildRoadIndex.
+    void BuildRoadOffices(double reach);
+
+    std::span<const RoadOffice> GetRoadOffices(std::size_t road_id) const noexcept;
+
+    // Списки офисов построены для всех дорог индекса
+    bool HasRoadOffices() const noexcept;
+
+    // Строит индекс дорог, граф перекрёстков, таблицу выбора дорог и списки офисов дорог
+    // в нужном порядке. Вызывается один раз, после добавления всех дорог и офисов.
+    void BuildIndexes(double office_reach);
+
+    // Заполняет out точками, равномерно распределёнными по длине всех дорог карты:
+    // дорога выбирается по таблице за O(1), точка — равномерно вдоль неё
+    void SampleRoadPoints(rng::Xoshiro256& random, std::span<LostObjectPosition> out) const;
+
     void AddBuilding(const Building& building);
 
     void AddOffice(Office office);
@@ -176,31 +221,24 @@ public:
 
     Loot* GetLootTypeByPos(int idx);
 
-    void AddLootOnMap(double x, double y, Loot* loot);
-
-    size_t GetLostObjectsCount() const noexcept;
-
-    std::unordered_map<int, LostObject> GetLostObjects() const;
-
     int GetBagCapacity() const noexcept;
 
-    void RemoveCollectedObj(int id) noexcept;
-
-    void SetLostObject(int id, LostObject obj);
-
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
 
     Id id_;
     std::string name_;
     Roads roads_;
+    RoadIndex road_index_;
+    RoadGraph road_graph_;
+    AliasTable spawn_table_;
+    // Офисы дороги i занимают отрезок [road_offices_begin_[i], road_offices_begin_[i + 1]) в road_offices_
+    std::vector<std::uint32_t> road_offices_begin_;
+    std::vector<RoadOffice> road_offices_;
     Buildings buildings_;
     double dog_speed_;
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
     std::deque<Loot> loot_types_;
-    int lost_objects_count_ = 0;
-    std::unordered_map<int, LostObject> lost_objects_;
-    std::vector<int> founded_obj_;
     int bag_capacity_;
 };
\ No newline at end of file
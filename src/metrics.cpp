@@ -0,0 +1,254 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+
+namespace metrics {
+
+namespace {
+
+const std::uint64_t DEFAULT_LATENCY_BOUNDS[] = {
+    50, 100, 250, 500,
+    1'000, 2'500, 5'000, 10'000, 25'000, 50'000,
+    100'000, 250'000, 500'000, 1'000'000, 2'500'000, 10'000'000
+};
+
+std::atomic<std::size_t> next_shard{0};
+
+void WriteEscaped(std::ostream& out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            out << "\\\\";
+            break;
+        case '"':
+            out << "\\\"";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        default:
+            out << c;
+        }
+    }
+}
+
+// {a="1",b="2"}, extra добавляется последней меткой (le для корзин гистограммы)
+void WriteLabels(std::ostream& out, const Registry::LabelNames& names, const Registry::LabelValues& values,
+                 std::string_view extra_name = {}, std::string_view extra_value = {}) {
+    if (names.empty() && extra_name.empty()) {
+        return;
+    }
+    out << '{';
+    bool first = true;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        out << (first ? "" : ",") << names[i] << "=\"";
+        WriteEscaped(out, values[i]);
+        out << '"';
+        first = false;
+    }
+    if (!extra_name.empty()) {
+        out << (first ? "" : ",") << extra_name << "=\"" << extra_value << '"';
+    }
+    out << '}';
+}
+
+// Кратчайшая запись, читающаяся обратно в то же число
+std::string MicrosToSeconds(std::uint64_t us) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<double>(us) / 1e6, std::chars_format::fixed);
+    return std::string(buffer, result.ptr);
+}
+
+template <typename Metric, typename... Args>
+Metric& FindOrCreate(std::shared_mutex& mutex, std::map<Registry::LabelValues, std::unique_ptr<Metric>>& metrics,
+                     const Registry::LabelValues& label_values, Args&&... args) {
+    {
+        std::shared_lock lock{mutex};
+        if (auto it = metrics.find(label_values); it != metrics.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock lock{mutex};
+    auto& metric = metrics[label_values];
+    if (!metric) {
+        metric = std::make_unique<Metric>(std::forward<Args>(args)...);
+    }
+    return *metric;
+}
+
+} // namespace
+
+std::size_t GetShardIndex() noexcept {
+    thread_local const std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return shard;
+}
+
+//! ------ Counter ------
+
+std::uint64_t Counter::GetValue() const noexcept {
+    std::uint64_t result = 0;
+    for (const auto& shard : shards_) {
+        result += shard.value.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+//! ------ Gauge ------
+
+std::int64_t Gauge::GetValue() const noexcept {
+    std::int64_t result = 0;
+    for (const auto& shard : shards_) {
+        result += shard.value.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+//! ------ Histogram ------
+
+std::span<const std::uint64_t> GetDefaultLatencyBounds() noexcept {
+    return DEFAULT_LATENCY_BOUNDS;
+}
+
+Histogram::Histogram(std::span<const std::uint64_t> bounds_us)
+    : bounds_(bounds_us.begin(), bounds_us.end())
+{
+    if (!std::is_sorted(bounds_.begin(), bounds_.end())) {
+        throw std::invalid_argument("Histogram bounds must be sorted");
+    }
+    for (auto& shard : shards_) {
+        shard.buckets = std::make_unique<std::atomic<std::uint64_t>[]>(bounds_.size() + 1);
+    }
+}
+
+void Histogram::Observe(std::uint64_t value_us) noexcept {
+    // Корзина — первая граница не меньше значения
+    const std::size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value_us) - bounds_.begin();
+    Shard& shard = shards_[GetShardIndex()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_us.fetch_add(value_us, std::memory_order_relaxed);
+}
+
+std::span<const std::uint64_t> Histogram::GetBounds() const noexcept {
+    return bounds_;
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+    Snapshot snapshot;
+    snapshot.cumulative.assign(bounds_.size() + 1, 0);
+    for (const auto& shard : shards_) {
+        for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+            snapshot.cumulative[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.sum_us += shard.sum_us.load(std::memory_order_relaxed);
+    }
+    for (std::size_t i = 1; i < snapshot.cumulative.size(); ++i) {
+        snapshot.cumulative[i] += snapshot.cumulative[i - 1];
+    }
+    snapshot.count = snapshot.cumulative.back();
+    return snapshot;
+}
+
+//! ------ Registry ------
+
+Registry::Family& Registry::GetFamily(std::string_view name, std::string_view help, Type type,
+                                      const LabelNames& label_names, const LabelValues& label_values) {
+    if (label_names.size() != label_values.size()) {
+        throw std::invalid_argument("Metric " + std::string(name) + " label values do not match names");
+    }
+    {
+        std::shared_lock lock{mutex_};
+        if (auto it = families_.find(name); it != families_.end()) {
+            if (it->second.type != type || it->second.label_names != label_names) {
+                throw std::invalid_argument("Metric " + std::string(name) + " is registered with another type or labels");
+            }
+            return it->second;
+        }
+    }
+    std::unique_lock lock{mutex_};
+    auto [it, inserted] = families_.try_emplace(std::string(name));
+    if (inserted) {
+        it->second.type = type;
+        it->second.help = std::string(help);
+        it->second.label_names = label_names;
+    } else if (it->second.type != type || it->second.label_names != label_names) {
+        throw std::invalid_argument("Metric " + std::string(name) + " is registered with another type or labels");
+    }
+    // Семейства не удаляются, ссылка остаётся действительной
+    return it->second;
+}
+
+Counter& Registry::GetCounter(std::string_view name, std::string_view help, const LabelNames& label_names,
+                              const LabelValues& label_values) {
+    Family& family = GetFamily(name, help, Type::COUNTER, label_names, label_values);
+    return FindOrCreate(mutex_, family.counters, label_values);
+}
+
+Gauge& Registry::GetGauge(std::string_view name, std::string_view help, const LabelNames& label_names,
+                          const LabelValues& label_values) {
+    Family& family = GetFamily(name, help, Type::GAUGE, label_names, label_values);
+    return FindOrCreate(mutex_, family.gauges, label_values);
+}
+
+Histogram& Registry::GetHistogram(std::string_view name, std::string_view help, const LabelNames& label_names,
+                                  const LabelValues& label_values, std::span<const std::uint64_t> bounds_us) {
+    Family& family = GetFamily(name, help, Type::HISTOGRAM, label_names, label_values);
+    return FindOrCreate(mutex_, family.histograms, label_values, bounds_us);
+}
+
+std::string Registry::Render() const {
+    std::ostringstream out;
+    std::shared_lock lock{mutex_};
+    for (const auto& [name, family] : families_) {
+        out << "# HELP " << name << ' ' << family.help << '\n';
+        switch (family.type) {
+        case Type::COUNTER:
+            out << "# TYPE " << name << " counter\n";
+            for (const auto& [values, counter] : family.counters) {
+                out << name;
+                WriteLabels(out, family.label_names, values);
+                out << ' ' << counter->GetValue() << '\n';
+            }
+            break;
+        case Type::GAUGE:
+            out << "# TYPE " << name << " gauge\n";
+            for (const auto& [values, gauge] : family.gauges) {
+                out << name;
+                WriteLabels(out, family.label_names, values);
+                out << ' ' << gauge->GetValue() << '\n';
+            }
+            break;
+        case Type::HISTOGRAM:
+            out << "# TYPE " << name << " histogram\n";
+            for (const auto& [values, histogram] : family.histograms) {
+                const Histogram::Snapshot snapshot = histogram->Collect();
+                const auto bounds = histogram->GetBounds();
+                for (std::size_t i = 0; i < bounds.size(); ++i) {
+                    out << name << "_bucket";
+                    WriteLabels(out, family.label_names, values, "le", MicrosToSeconds(bounds[i]));
+                    out << ' ' << snapshot.cumulative[i] << '\n';
+                }
+                out << name << "_bucket";
+                WriteLabels(out, family.label_names, values, "le", "+Inf");
+                out << ' ' << snapshot.count << '\n';
+                out << name << "_sum";
+                WriteLabels(out, family.label_names, values);
+                out << ' ' << MicrosToSeconds(snapshot.sum_us) << '\n';
+                out << name << "_count";
+                WriteLabels(out, family.label_names, values);
+                out << ' ' << snapshot.count << '\n';
+            }
+            break;
+        }
+    }
+    return out.str();
+}
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+} // namespace metrics
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ *  Метрики сервера в формате Prometheus.
+ *  Счётчики и гистограммы разбиты на шарды по потокам: каждый поток пишет в свою
+ *  строку кэша, и потоки ввода-вывода не дерутся за одну атомарную переменную.
+ *  Значения шардов складываются только при выдаче метрик.
+ */
+namespace metrics {
+
+inline constexpr std::size_t SHARDS = 16;
+
+// Шард текущего потока, назначается по кругу при первом обращении
+std::size_t GetShardIndex() noexcept;
+
+class Counter {
+public:
+    void Increment(std::uint64_t value = 1) noexcept {
+        shards_[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetValue() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    std::array<Shard, SHARDS> shards_;
+};
+
+// Значение, которое может расти и убывать: число запросов в обработке и т.п.
+class Gauge {
+public:
+    void Add(std::int64_t value = 1) noexcept {
+        shards_[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Sub(std::int64_t value = 1) noexcept {
+        Add(-value);
+    }
+
+    std::int64_t GetValue() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::int64_t> value{0};
+    };
+
+    std::array<Shard, SHARDS> shards_;
+};
+
+// Границы корзин по умолчанию, мкс: от 50 мкс до 10 с
+std::span<const std::uint64_t> GetDefaultLatencyBounds() noexcept;
+
+/*
+ *  Гистограмма с фиксированными границами корзин и разрешением в микросекунду.
+ *  Запись — поиск корзины среди нескольких границ и два атомарных сложения в шарде потока.
+ */
+class Histogram {
+public:
+    struct Snapshot {
+        // Накопленные числа: cumulative[i] — записи не больше bounds[i], последний элемент — все записи
+        std::vector<std::uint64_t> cumulative;
+        std::uint64_t count = 0;
+        std::uint64_t sum_us = 0;
+    };
+
+    explicit Histogram(std::span<const std::uint64_t> bounds_us);
+
+    void Observe(std::uint64_t value_us) noexcept;
+
+    void Observe(std::chrono::steady_clock::duration duration) noexcept {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        Observe(static_cast<std::uint64_t>(us < 0 ? 0 : us));
+    }
+
+    std::span<const std::uint64_t> GetBounds() const noexcept;
+
+    Snapshot Collect() const;
+
+private:
+    struct alignas(64) Shard {
+        // bounds_.size() + 1 корзин, последняя — выше всех границ
+        std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;
+        std::atomic<std::uint64_t> sum_us{0};
+    };
+
+    std::vector<std::uint64_t> bounds_;
+    std::array<Shard, SHARDS> shards_;
+};
+
+/*
+ *  Реестр метрик. Метрика определяется именем и значениями меток; повторный запрос
+ *  возвращает ту же метрику, поэтому горячий код берёт ссылку один раз и дальше
+ *  обращается к ней без блокировок.
+ */
+class Registry {
+public:
+    using LabelNames = std::vector<std::string>;
+    using LabelValues = std::vector<std::string>;
+
+    Counter& GetCounter(std::string_view name, std::string_view help, const LabelNames& label_names = {},
+                        const LabelValues& label_values = {});
+
+    Gauge& GetGauge(std::string_view name, std::string_view help, const LabelNames& label_names = {},
+                    const LabelValues& label_values = {});
+
+    Histogram& GetHistogram(std::string_view name, std::string_view help, const LabelNames& label_names = {},
+                            const LabelValues& label_values = {},
+                            std::span<const std::uint64_t> bounds_us = GetDefaultLatencyBounds());
+
+    // Текстовый формат Prometheus 0.0.4. Гистограммы выдаются в секундах.
+    std::string Render() const;
+
+private:
+    enum class Type {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Family {
+        Type type;
+        std::string help;
+        LabelNames label_names;
+        std::map<LabelValues, std::unique_ptr<Counter>> counters;
+        std::map<LabelValues, std::unique_ptr<Gauge>> gauges;
+        std::map<LabelValues, std::unique_ptr<Histogram>> histograms;
+    };
+
+    Family& GetFamily(std::string_view name, std::string_view help, Type type, const LabelNames& label_names,
+                      const LabelValues& label_values);
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, Family, std::less<>> families_;
+};
+
+// Реестр процесса, его выдаёт сервер метрик
+Registry& GetRegistry();
+
+} // namespace metrics
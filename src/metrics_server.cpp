@@ -0,0 +1,65 @@
+#include "metrics_server.h"
+
+namespace {
+
+namespace http = http_server::http;
+
+using StringRequest = http::request<http::string_body>;
+using StringResponse = http::response<http::string_body>;
+
+StringResponse MakeMetricsResponse(const StringRequest& req, const metrics::Registry& registry) {
+    StringResponse response;
+    response.version(req.version());
+    response.keep_alive(req.keep_alive());
+
+    const std::string_view target = req.target();
+    if (target.substr(0, target.find('?')) != "/metrics") {
+        response.result(http::status::not_found);
+        response.set(http::field::content_type, "text/plain");
+        response.body() = "Not found\n";
+    } else if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        response.result(http::status::method_not_allowed);
+        response.set(http::field::allow, "GET, HEAD");
+        response.set(http::field::content_type, "text/plain");
+        response.body() = "Method not allowed\n";
+    } else {
+        response.result(http::status::ok);
+        response.set(http::field::content_type, "text/plain; version=0.0.4");
+        response.body() = registry.Render();
+    }
+    response.prepare_payload();
+    return response;
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(const http_server::net::ip::address& address, http_server::net::ip::port_type port,
+                             metrics::Registry& registry)
+    : endpoint_(address, port),
+    registry_(registry)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+void MetricsServer::Start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    http_server::ServeHttp(ioc_, endpoint_, [&registry = registry_](auto&& req, auto&& send,
+                                                                   [[maybe_unused]] http_server::tcp::endpoint& endpoint) {
+        send(MakeMetricsResponse(req, registry));
+    });
+    thread_ = std::jthread([this] {
+        ioc_.run();
+    });
+}
+
+void MetricsServer::Stop() {
+    if (thread_.joinable()) {
+        ioc_.stop();
+        thread_.join();
+    }
+}
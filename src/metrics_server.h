@@ -0,0 +1,32 @@
+#pragma once
+
+#include "http_server.h"
+#include "metrics.h"
+
+#include <thread>
+
+/*
+ *  Отдаёт метрики реестра в текстовом формате Prometheus по GET /metrics.
+ *  Слушает отдельный порт в собственном io_context и потоке, поэтому сбор метрик
+ *  не занимает потоки игрового сервера и не стоит в одной очереди с запросами игроков.
+ */
+class MetricsServer {
+public:
+    MetricsServer(const http_server::net::ip::address& address, http_server::net::ip::port_type port,
+                  metrics::Registry& registry);
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    ~MetricsServer();
+
+    void Start();
+
+    void Stop();
+
+private:
+    http_server::tcp::endpoint endpoint_;
+    metrics::Registry& registry_;
+    http_server::net::io_context ioc_{1};
+    std::jthread thread_;
+};
@@ -2,34 +2,200 @@
 #include "model.h"
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <stdexcept>
 
 namespace model {
 using namespace std::literals;
 
-namespace collision_detector {
+namespace {
+
+const double LOOT_WIDTH = 0.0;
+
+// Собак в одном куске параллельного поиска событий сбора
+const std::size_t GATHER_CHUNK_SIZE = 128;
+
+const std::size_t NO_ITEM = std::numeric_limits<std::size_t>::max();
+
+/*
+ *  Собиратели — собаки сессии, сдвинувшиеся за тик, предметы — вещи и офисы рядом с их путём.
+ *  Сначала идут все вещи, затем офисы: при одновременной встрече вещь успевает попасть
+ *  в рюкзак до сдачи его в офис.
+ *  Все массивы лежат в GatherBuffers сессии и очищаются без освобождения памяти,
+ *  поэтому последовательная фаза сбора с обычным числом собак и вещей ничего не выделяет.
+ *  С пулом потоков остаётся несколько выделений на раскладку кусков по очередям пула.
+ */
+class SessionGatherProvider : public collision_detector::ItemGathererProvider {
+public:
+    SessionGatherProvider(GameSession& session, WorkStealingPool* pool)
+        : buffers_(session.GetGatherBuffers())
+    {
+        buffers_.dogs.clear();
+        buffers_.gatherers.clear();
+        buffers_.items.clear();
+        buffers_.lost_object_ids.clear();
+        buffers_.candidate_begin.clear();
+        buffers_.candidates.clear();
+
+        for (auto& [dog_id, dog] : *session.GetDogs()) {
+            const auto start_pos = dog->GetPreviousPosition();
+            const auto end_pos = dog->GetPosition();
+            if (start_pos.x != end_pos.x || start_pos.y != end_pos.y) {
+                buffers_.dogs.push_back(dog);
+                buffers_.gatherers.push_back(collision_detector::Gatherer{start_pos, end_pos, DOG_GATHER_WIDTH, dog->GetTravelTime()});
+            }
+        }
+        const std::size_t gatherers_count = buffers_.gatherers.size();
+
+        // Широкая фаза по вещам: только ячейки сетки, которые задевает путь собаки.
+        // Запросы к сетке только читают её; каждый кусок собак пишет в свой буфер,
+        // loot_end[g] — конец вещей собаки g в буфере её куска.
+        auto& chunk_loot = buffers_.chunk_loot;
+        const std::size_t chunks_count = (gatherers_count + GATHER_CHUNK_SIZE - 1) / GATHER_CHUNK_SIZE;
+        if (chunk_loot.size() < chunks_count) {
+            chunk_loot.resize(chunks_count);
+        }
+        for (std::size_t chunk = 0; chunk < chunks_count; ++chunk) {
+            chunk_loot[chunk].clear();
+        }
+        auto& loot_end = buffers_.loot_end;
+        loot_end.assign(gatherers_count, 0);
+        auto query_range = [&](std::size_t begin, std::size_t end) {
+            auto& buffer = chunk_loot[begin / GATHER_CHUNK_SIZE];
+            for (std::size_t g = begin; g < end; ++g) {
+                ForEachNear(session.GetLostObjectsGrid(), g, LOOT_WIDTH, [&buffer](const SpatialGrid::Item& item) {
+                    buffer.push_back(item);
+                });
+                loot_end[g] = buffer.size();
+            }
+        };
+        if (pool) {
+            pool->ParallelFor(gatherers_count, GATHER_CHUNK_SIZE, query_range);
+        } else {
+            for (std::size_t begin = 0; begin < gatherers_count; begin += GATHER_CHUNK_SIZE) {
+                query_range(begin, std::min(gatherers_count, begin + GATHER_CHUNK_SIZE));
+            }
+        }
+
+        // Нумерация вещей идёт последовательно в порядке собак, поэтому не зависит от числа потоков
+        auto& loot_candidates = buffers_.loot_candidates;
+        loot_candidates.clear();
+        auto& loot_item_index = buffers_.loot_item_index;
+        auto& loot_item_stamp = buffers_.loot_item_stamp;
+        const std::size_t slots_count = session.GetLostObjects().SlotCount();
+        if (loot_item_stamp.size() < slots_count) {
+            loot_item_stamp.resize(slots_count, 0);
+            loot_item_index.resize(slots_count);
+        }
+        // Новая метка делает все старые записи недействительными; при переполнении метки чистим массив
+        if (++buffers_.loot_stamp == 0) {
+            std::fill(loot_item_stamp.begin(), loot_item_stamp.end(), 0);
+            buffers_.loot_stamp = 1;
+        }
+        const std::uint32_t stamp = buffers_.loot_stamp;
+        for (std::size_t g = 0; g < gatherers_count; ++g) {
+            const auto& buffer = chunk_loot[g / GATHER_CHUNK_SIZE];
+            const std::size_t begin = g % GATHER_CHUNK_SIZE == 0 ? 0 : loot_end[g - 1];
+            for (std::size_t i = begin; i < loot_end[g]; ++i) {
+                const auto& item = buffer[i];
+                const std::uint32_t slot = LostObjects::IndexOf(item.id);
+                if (loot_item_stamp[slot] != stamp) {
+                    loot_item_stamp[slot] = stamp;
+                    loot_item_index[slot] = buffers_.items.size();
+                    buffers_.items.push_back(collision_detector::Item{item.x, item.y, LOOT_WIDTH});
+                    buffers_.lost_object_ids.push_back(item.id);
+                }
+                loot_candidates.push_back(loot_item_index[slot]);
+            }
+        }
 
-CollectionResult TryCollectPoint(DogPosition a, DogPosition b, LostObjectPosition c) {
-    // Проверим, что перемещение ненулевое.
-    // Тут приходится использовать строгое равенство, а не приближённое,
-    // пoскольку при сборе придётся учитывать перемещение даже на небольшое
-    // расстояние.
-    if (b.x != a.x || b.y != a.y) {
-        const double u_x = c.x - a.x;
-        const double u_y = c.y - a.y;
-        const double v_x = b.x - a.x;
-        const double v_y = b.y - a.y;
-        const double u_dot_v = u_x * v_x + u_y * v_y;
-        const double u_len2 = u_x * u_x + u_y * u_y;
-        const double v_len2 = v_x * v_x + v_y * v_y;
-        const double proj_ratio = u_dot_v / v_len2;
-        const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+        // Офисы берутся из заранее посчитанных списков дорог, которые задевает путь собаки
+        const Map& map = *session.GetMap();
+        auto& office_items = buffers_.office_items;
+        auto& office_seen = buffers_.office_seen;
+        office_items.assign(map.GetOffices().size(), NO_ITEM);
+        office_seen.assign(map.GetOffices().size(), NO_ITEM);
+        auto& candidates = buffers_.candidates;
+        buffers_.candidate_begin.push_back(0);
+        std::size_t loot_pos = 0;
+        for (std::size_t g = 0; g < gatherers_count; ++g) {
+            const std::size_t loot_count = loot_end[g] - (g % GATHER_CHUNK_SIZE == 0 ? 0 : loot_end[g - 1]);
+            candidates.insert(candidates.end(), loot_candidates.begin() + loot_pos, loot_candidates.begin() + loot_pos + loot_count);
+            loot_pos += loot_count;
+
+            const auto& gatherer = buffers_.gatherers[g];
+            const RoadBounds path{std::min(gatherer.start_pos.x, gatherer.end_pos.x), std::min(gatherer.start_pos.y, gatherer.end_pos.y),
+                                  std::max(gatherer.start_pos.x, gatherer.end_pos.x), std::max(gatherer.start_pos.y, gatherer.end_pos.y)};
+            map.GetRoadIndex().ForEachRoadInBox(path, [&](std::size_t road_id) {
+                for (const auto& office : map.GetRoadOffices(road_id)) {
+                    // Дорога может встретиться несколько раз, офис — быть рядом с несколькими дорогами
+                    if (office_seen[office.office_idx] == g) {
+                        continue;
+                    }
+                    office_seen[office.office_idx] = g;
+                    std::size_t& idx = office_items[office.office_idx];
+                    if (idx == NO_ITEM) {
+                        idx = buffers_.items.size();
+                        buffers_.items.push_back(collision_detector::Item{office.x, office.y, OFFICE_WIDTH});
+                    }
+                    candidates.push_back(idx);
+                }
+            });
+            buffers_.candidate_begin.push_back(candidates.size());
+        }
+    }
 
-        return CollectionResult(sq_distance, proj_ratio);
+    std::size_t ItemsCount() const override {
+        return buffers_.items.size();
+    }
+
+    collision_detector::Item GetItem(std::size_t idx) const override {
+        return buffers_.items[idx];
+    }
+
+    std::size_t GatherersCount() const override {
+        return buffers_.gatherers.size();
     }
-}
 
-} //namespace collision_detector
+    collision_detector::Gatherer GetGatherer(std::size_t idx) const override {
+        return buffers_.gatherers[idx];
+    }
+
+    void GetCandidates(std::size_t gatherer_idx, std::vector<std::size_t>& candidates) const override {
+        candidates.assign(buffers_.candidates.begin() + buffers_.candidate_begin[gatherer_idx],
+                          buffers_.candidates.begin() + buffers_.candidate_begin[gatherer_idx + 1]);
+    }
+
+    Dog* GetDog(std::size_t gatherer_idx) const {
+        return buffers_.dogs[gatherer_idx];
+    }
+
+    // Вещи занимают индексы [0, LostObjectsCount()), офисы — всё, что дальше
+    std::size_t LostObjectsCount() const noexcept {
+        return buffers_.lost_object_ids.size();
+    }
+
+    bool IsOffice(std::size_t item_idx) const noexcept {
+        return item_idx >= buffers_.lost_object_ids.size();
+    }
+
+    int GetLostObjectId(std::size_t item_idx) const {
+        return buffers_.lost_object_ids[item_idx];
+    }
+
+private:
+    template <typename Fn>
+    void ForEachNear(const SpatialGrid& grid, std::size_t gatherer_idx, double item_width, Fn&& fn) const {
+        const auto& gatherer = buffers_.gatherers[gatherer_idx];
+        grid.ForEachNearSegment(gatherer.start_pos.x, gatherer.start_pos.y, gatherer.end_pos.x, gatherer.end_pos.y,
+                                gatherer.width + item_width, std::forward<Fn>(fn));
+    }
+
+    GatherBuffers& buffers_;
+};
+
+} // namespace
 
 //! ------------------------- Game --------------------------------
 const Maps& Game::GetMaps() const noexcept {
@@ -43,15 +209,12 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
     return nullptr;
 }
 
-std::pair<Player*, Token> Game::AddPlayerToSession(const std::string& username, const std::string& map_id, double start_x, double start_y, Road* road_to_move) {
-    auto session = GetSession(map_id);
-    Dog dog{session->GetDogsCount(), username};
-    
+std::pair<Player*, Token> Game::AddPlayerToSession(const std::string& username, GameSession& session, double start_x, double start_y, std::size_t road_id) {
+    Dog& dog = session.AddDog(session.GetDogsCount(), username);
+
     dog.SetPosition(DogPosition{start_x, start_y});
-    dog.SetRoadToMove(road_to_move);
-    session->AddDog(std::move(dog));
-    auto last = std::prev(const_cast<GameSession*>(session)->GetDogs()->end());
-    return players_.Add(*last->second, *session);
+    dog.SetRoadId(road_id);
+    return players_.Add(dog, session);
 }
 
 const Players* Game::GetPlayers() const {
@@ -64,6 +227,10 @@ void Game::AddMap(Map map) {
         throw std::invalid_argument("Map with id "s + *map.GetId() + " already exists"s);
     } else {
         try {
+            // Без индексов карты (Map::BuildIndexes) сбор не увидит ни одного офиса
+            if (!map.HasRoadOffices()) {
+                throw std::logic_error("Indexes are not built for map "s + *map.GetId());
+            }
             maps_.emplace_back(std::move(map));
         } catch (...) {
             map_id_to_index_.erase(it);
@@ -73,34 +240,56 @@ void Game::AddMap(Map map) {
     
 }
 
-GameSession* Game::FindSessionFromMapId(const std::string& map_id) {
-    if (sessions_.size() == 0) {
-        return nullptr;
+GameSession* Game::CreateSession(const Map* map) {
+    auto& instances = session_directory_[map->GetId()];
+    GameSession& session = sessions_.emplace_back(map, instances.size());
+    instances.push_back(&session);
+    session.SetDogRetirementTime(dog_retirement_time_);
+    if (loot_generator_) {
+        session.SetLootGenerator(*loot_generator_);
     }
+    return &session;
+}
 
-    auto session = std::find_if(sessions_.begin(), sessions_.end(), [&map_id](const GameSession s){
-        return *(s.GetMap()->GetId()) == map_id;
-    });
-
-    if (session == sessions_.end()) {
+GameSession* Game::FindJoinableSession(const std::string& map_id) {
+    const Map* map = FindMap(Map::Id(map_id));
+    if (map == nullptr) {
         return nullptr;
     }
-    return &*session;        
+    if (auto it = session_directory_.find(map->GetId()); it != session_directory_.end()) {
+        for (GameSession* session : it->second) {
+            if (session->TryTakeSeat(max_players_per_session_)) {
+                return session;
+            }
+        }
+    }
+    // Все экземпляры заполнены: новый экземпляр тикает независимо от остальных
+    GameSession* session = CreateSession(map);
+    session->TakeSeat();
+    return session;
 }
 
-GameSession* Game::GetSession(const std::string& map_id) {
-    auto session = FindSessionFromMapId(map_id);
-    if (session == nullptr) {
-        auto map = FindMap(Map::Id(map_id));
-        sessions_.emplace_back(GameSession{map});
-        session = &sessions_.back();
+GameSession* Game::GetSessionInstance(const std::string& map_id, std::size_t instance) {
+    const Map* map = FindMap(Map::Id(map_id));
+    if (map == nullptr) {
+        return nullptr;
     }
-    return session;    
+    while (session_directory_[map->GetId()].size() <= instance) {
+        CreateSession(map);
+    }
+    return session_directory_[map->GetId()][instance];
+}
+
+void Game::SetMaxPlayersPerSession(std::size_t max_players) {
+    max_players_per_session_ = max_players;
 }
 
 void Game::SetDogRetirementTime(double sec)
 {
     dog_retirement_time_ = sec * 1000;
+    for (auto& session : sessions_) {
+        session.SetDogRetirementTime(dog_retirement_time_);
+    }
 }
 
 double Game::GetDogRetirementTime()
@@ -112,101 +301,143 @@ void Game::SetDefaultDogSpeed(double speed) {
     default_dog_speed_ = std::move(speed);
 }
 
-void Game::UpdateLostObjects(const GameSession* session, int interval) {
+void Game::UpdateLostObjects(GameSession* session, int interval) {
+    // Игра без SetLootGenerator не создаёт вещей
+    if (!session->GetLootGenerator()) {
+        return;
+    }
     auto map = session->GetMap();
     std::chrono::duration<int, std::milli> chrono_milliseconds{ interval };
-    int need_to_generate = loot_generator_->Generate(std::chrono::duration_cast<std::chrono::milliseconds>(chrono_milliseconds), 
-                                                    map->GetLostObjectsCount(), session->GetDogsCount());
+    int need_to_generate = session->GetLootGenerator()->Generate(std::chrono::duration_cast<std::chrono::milliseconds>(chrono_milliseconds), 
+                                                    session->GetLostObjectsCount(), session->GetDogsCount());
     if (need_to_generate > 0) {
-        auto roads = map->GetRoads();
+        rng::Xoshiro256& random = session->GetRandom();
+        // Точки и типы для всех новых вещей выбираются одной пачкой: O(need_to_generate) без перебора дорог
+        std::vector<LostObjectPosition> positions(need_to_generate);
+        std::vector<int> loot_types(need_to_generate);
+        map->SampleRoadPoints(random, positions);
+        random.FillInts(loot_types, 0, static_cast<int>(map->GetLootTypes().size()) - 1);
         for (auto i = 0; i < need_to_generate; ++i) {
-            int r_road = sdk::GetRandomInt(0, roads.size() - 1);
-            auto start = roads[r_road].GetStart();
-            auto end = roads[r_road].GetEnd();
-            
-            auto [min_x, max_x] = sdk::GetMinMax(start.x, end.x);
-            auto [min_y, max_y] = sdk::GetMinMax(start.y, end.y);
-
-            auto loot_type = sdk::GetRandomInt(0, map->GetLootTypes().size() - 1);
-            double loot_x = sdk::GetRandomDouble(min_x, max_x);
-            double loot_y = sdk::GetRandomDouble(min_y, max_y);
-            const_cast<Map*>(map)->AddLootOnMap(loot_x, loot_y, const_cast<Map*>(map)->GetLootTypeByPos(loot_type));
+            session->AddLostObject(positions[i].x, positions[i].y, const_cast<Map*>(map)->GetLootTypeByPos(loot_types[i]));
         }
     }
 }
 
-std::vector<collision_detector::CollectionResult> MoveThroughOffice(const Map* map, DogPosition pos_before_move, DogPosition pos_after_move) {
-    std::vector<collision_detector::CollectionResult> offices_on_way;
-    auto offices = map->GetOffices();
-    for (const auto& office : offices) {
-        collision_detector::CollectionResult move_through_office = 
-                                    collision_detector::TryCollectPoint(pos_before_move, pos_after_move, 
-                                                                        LostObjectPosition{office.GetPosition().x - office.GetOffset().dx, 
-                                                                                            office.GetPosition().y - office.GetOffset().dy});
-        if (move_through_office.IsCollected((0.5 / 2) + (0.6 / 2))) {
-            offices_on_way.push_back(move_through_office);
+void Game::CollectLostObjects(GameSession& session) {
+    WorkStealingPool* pool = GetTickPool(session);
+    const SessionGatherProvider provider(session, pool);
+    GatherBuffers& buffers = session.GetGatherBuffers();
+
+    // Узкая фаза считается кусками, каждый кусок пишет события в свой буфер.
+    // После объединения события сортируются целиком, так что итог не зависит от числа потоков.
+    auto& events = buffers.events;
+    events.clear();
+    const std::size_t gatherers_count = provider.GatherersCount();
+    if (pool) {
+        auto& chunk_events = buffers.chunk_events;
+        const std::size_t chunks_count = (gatherers_count + GATHER_CHUNK_SIZE - 1) / GATHER_CHUNK_SIZE;
+        if (chunk_events.size() < chunks_count) {
+            chunk_events.resize(chunks_count);
+            buffers.chunk_scratch.resize(chunks_count);
         }
-    }
-    return offices_on_way;
-}
-
-void Game::CollectLostObjects(const GameSession& session) {
-    auto dogs = const_cast<GameSession&>(session).GetDogs();
-    for (auto& [dog_id, dog] : *dogs) {
-        auto pos_before_move = dog->GetPreviousPosition();
-        auto pos_after_move = dog->GetPosition();
-        if (pos_before_move.x == pos_after_move.x && pos_before_move.y == pos_after_move.y) {
-            continue;
+        for (std::size_t chunk = 0; chunk < chunks_count; ++chunk) {
+            chunk_events[chunk].clear();
         }
-
-        auto map = session.GetMap();
-
-        std::vector<collision_detector::CollectionResult> move_through_offices = MoveThroughOffice(map, pos_before_move, pos_after_move);
-
-        auto lost_objects = const_cast<Map*>(map)->GetLostObjects();
-        for (const auto& [id_on_map, lost_object] : lost_objects) {
-            collision_detector::CollectionResult collect_result = 
-                                        collision_detector::TryCollectPoint(pos_before_move, pos_after_move, lost_object.pos);
-            auto it = std::find_if(move_through_offices.begin(), move_through_offices.end(), 
-                                    [&collect_result](collision_detector::CollectionResult& office) {
-                                        return office.proj_ratio < collect_result.proj_ratio;
-            });
-            if (it != move_through_offices.end()) {
+        pool->ParallelFor(gatherers_count, GATHER_CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            const std::size_t chunk = begin / GATHER_CHUNK_SIZE;
+            collision_detector::CollectGatherEvents(provider, begin, end, chunk_events[chunk], buffers.chunk_scratch[chunk]);
+        });
+        for (std::size_t chunk = 0; chunk < chunks_count; ++chunk) {
+            events.insert(events.end(), chunk_events[chunk].begin(), chunk_events[chunk].end());
+        }
+    } else {
+        if (buffers.chunk_scratch.empty()) {
+            buffers.chunk_scratch.resize(1);
+        }
+        collision_detector::CollectGatherEvents(provider, 0, gatherers_count, events, buffers.chunk_scratch.front());
+    }
+    collision_detector::SortGatherEvents(events);
+    const std::size_t bag_capacity = session.GetMap()->GetBagCapacity();
+
+    // Применяем события в порядке времени: вещь достаётся той собаке, что дошла до неё первой
+    auto& collected = buffers.collected;
+    collected.assign(provider.LostObjectsCount(), 0);
+    for (const auto& event : events) {
+        Dog* dog = provider.GetDog(event.gatherer_id);
+        if (provider.IsOffice(event.item_id)) {
+            if (dog->GetBagSize() != 0) {
                 dog->IncreaseScore(dog->GetBagScore());
                 dog->ClearBag();
+                session.MarkDogChanged(dog->GetId());
             }
-
-            if (collect_result.IsCollected(DOG_WIDTH / 2)) {
-                if (dog->GetBagSize() < map->GetBagCapacity()) {
-                    dog->AddToBag(id_on_map, lost_object.loot->GetLootType());
-                    dog->IncreaseBagScore(lost_object.loot->GetRate());
-                    const_cast<Map*>(map)->RemoveCollectedObj(id_on_map);
-                } else {
-                    continue;
-                }
-            }
+            continue;
         }
+        if (collected[event.item_id] || dog->GetBagSize() >= bag_capacity) {
+            continue;
+        }
+        const int id_on_map = provider.GetLostObjectId(event.item_id);
+        const LostObject* lost_object = session.FindLostObject(id_on_map);
+        dog->AddToBag(id_on_map, lost_object->loot->GetLootType());
+        dog->IncreaseBagScore(lost_object->loot->GetRate());
+        session.RemoveLostObject(id_on_map);
+        session.MarkDogChanged(dog->GetId());
+        collected[event.item_id] = 1;
     }
 }
 
 void Game::UpdateGameState(int interval) {
-    for (const auto& session : sessions_) {
-        UpdateLostObjects(&session, interval);
-        const_cast<GameSession&>(session).MoveDogs(dog_retirement_time_, interval);
-        CollectLostObjects(session);  
+    for (auto& session : sessions_) {
+        UpdateSession(session, interval);
     }
+    IncreaseGameTime(interval);
+}
+
+void Game::UpdateSession(GameSession& session, int interval) {
+    using Clock = std::chrono::steady_clock;
+    auto to_ms = [](Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+    TickPhaseTimes phases;
+    const auto start = Clock::now();
+    UpdateLostObjects(&session, interval);
+    const auto spawned = Clock::now();
+    session.MoveDogs(interval, GetTickPool(session));
+    const auto moved = Clock::now();
+    CollectLostObjects(session);
+    const auto collected = Clock::now();
+    session.AdvanceTick();
+
+    phases.spawn = to_ms(spawned - start);
+    phases.move = to_ms(moved - spawned);
+    phases.collect = to_ms(collected - moved);
+    session.SetLastTickPhases(phases);
+}
+
+void Game::IncreaseGameTime(double interval) {
     game_time_ += interval;
 }
 
 std::unordered_map<std::string, std::pair<int, int>> Game::RetirePlayers() {
     std::unordered_map<std::string, std::pair<int, int>> retire_players;
-    auto players_and_tokens = players_.GetPlayersWithTokens();
-    for (const auto& [token, player] : players_and_tokens->TokenAndPlayer()) {
-        if (player && player->GetDog()->IsNeedToRetire()) {
-            auto dog = *player->GetDog();
-            retire_players[dog.GetName()] = std::make_pair(dog.GetScore(), dog.GetGameTime() + dog.GetRetireTime());
-            //db->Save(dog.GetName(), dog.GetScore(), dog.GetGameTime() + dog.GetRetireTime());
-            players_.DeletePlayerByToken(token);
+    for (auto& session : sessions_) {
+        retire_players.merge(RetirePlayers(session));
+    }
+
+    return retire_players;
+}
+
+std::unordered_map<std::string, std::pair<int, int>> Game::RetirePlayers(GameSession& session) {
+    std::unordered_map<std::string, std::pair<int, int>> retire_players;
+    // Сессия отдаёт только собак, чей срок простоя истёк на последних тиках
+    std::vector<Dog*> retired_dogs;
+    session.TakeRetiredDogs(retired_dogs);
+    for (Dog* dog : retired_dogs) {
+        // Токен есть только у ещё не ушедшего игрока
+        if (auto token = players_.FindTokenByDog(dog)) {
+            retire_players[dog->GetName()] = std::make_pair(dog->GetScore(), dog->GetGameTime() + dog->GetRetireTime());
+            players_.DeletePlayerByToken(*token);
+            session.ReleaseSeat();
         }
     }
 
@@ -217,6 +448,21 @@ void Game::SetLootGenerator(double period, double probability)
 {
     std::chrono::duration<double, std::milli> chrono_milliseconds{ period * 1000.0 };
     loot_generator_ = loot_gen::LootGenerator(std::chrono::duration_cast<std::chrono::milliseconds>(chrono_milliseconds), probability);
+    for (auto& session : sessions_) {
+        session.SetLootGenerator(*loot_generator_);
+    }
+}
+
+void Game::SetSimulationThreads(unsigned threads) {
+    if (threads > 1) {
+        sim_pool_ = std::make_unique<WorkStealingPool>(threads);
+    } else {
+        sim_pool_.reset();
+    }
+}
+
+WorkStealingPool* Game::GetTickPool(const GameSession& session) const {
+    return session.GetDogsCount() >= PARALLEL_TICK_MIN_DOGS ? sim_pool_.get() : nullptr;
 }
 
 Sessions* Game::GetSessions()
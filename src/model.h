@@ -1,11 +1,14 @@
 #pragma once
 
+#include "collision_detector.h"
 #include "players.h"
 #include "loot_generator.h"
 #include "postgres.h"
+#include "work_stealing_pool.h"
 
 #include <cmath>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <unordered_map>
@@ -16,25 +19,13 @@ namespace model {
 using Maps = std::deque<Map>;
 using Sessions = std::deque<GameSession>;
 
-namespace collision_detector {
-
-struct CollectionResult {
-    bool IsCollected(double collect_radius) const {
-        return proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= collect_radius * collect_radius;
-    }
-
-    // квадрат расстояния до точки
-    double sq_distance;
-
-    // доля пройденного отрезка
-    double proj_ratio;
-};
-
-// Движемся из точки a в точку b и пытаемся подобрать точку c.
-// Эта функция реализована в уроке.
-CollectionResult TryCollectPoint(DogPosition a, DogPosition b, LostObjectPosition c);
-
-} //namespace collision_detector
+const double DOG_GATHER_WIDTH = DOG_WIDTH / 2;
+const double OFFICE_WIDTH = 0.5 / 2;
+// С дороги до офиса дотягиваются зоны сбора собаки и офиса: расстояние для Map::BuildRoadOffices
+const double OFFICE_REACH = DOG_GATHER_WIDTH + OFFICE_WIDTH;
+// С меньшим числом собак сессия считает тик последовательно даже при заданном пуле:
+// раздача кусков потокам стоит дороже, чем расчёт такой сессии в одном потоке
+const std::size_t PARALLEL_TICK_MIN_DOGS = 4096;
 
 class Game {
 public:
@@ -44,7 +35,7 @@ public:
 
     const Map* FindMap(const Map::Id& id) const noexcept;
 
-    std::pair<Player*, Token> AddPlayerToSession(const std::string& username, const std::string& map_id, double start_x, double start_y, Road* road);
+    std::pair<Player*, Token> AddPlayerToSession(const std::string& username, GameSession& session, double start_x, double start_y, std::size_t road_id);
 
     const Players* GetPlayers() const;
 
@@ -52,13 +43,34 @@ public:
 
     void UpdateGameState(int interval);
 
+    // Обновляет одну сессию. Разные сессии можно обновлять одновременно из разных потоков.
+    void UpdateSession(GameSession& session, int interval);
+
+    void IncreaseGameTime(double interval);
+
+    // Фаза сбора вещей тика: собаки подбирают вещи, пройденные за последнее перемещение,
+    // и сдают рюкзаки в офисы. Вызывается из UpdateSession после MoveDogs.
+    void CollectLostObjects(GameSession& session);
+
     void SetLootGenerator(double period, double probability);
 
+    // Число потоков расчёта тика; при 1 тик считается последовательно
+    void SetSimulationThreads(unsigned threads);
+
     Sessions* GetSessions();
 
     double GetGameTime();
 
-    GameSession* GetSession(const std::string& map_id);
+    // Сессия карты со свободным местом; в ней сразу занимается место для входящего игрока.
+    // Если все экземпляры заполнены, открывается новый. nullptr, если карты нет.
+    GameSession* FindJoinableSession(const std::string& map_id);
+
+    // Экземпляр instance сессии карты map_id, недостающие экземпляры создаются.
+    // Используется при восстановлении сохранённой игры. nullptr, если карты нет.
+    GameSession* GetSessionInstance(const std::string& map_id, std::size_t instance);
+
+    // Число игроков в одном экземпляре сессии, 0 — без ограничения
+    void SetMaxPlayersPerSession(std::size_t max_players);
 
     void SetDogRetirementTime(double sec);
 
@@ -66,13 +78,21 @@ public:
 
     std::unordered_map<std::string, std::pair<int, int>> RetirePlayers();
 
+    // Уход игроков одной сессии, вызывается вместе с UpdateSession
+    std::unordered_map<std::string, std::pair<int, int>> RetirePlayers(GameSession& session);
+
 
 private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
 
     Maps maps_;
+    using SessionDirectory = std::unordered_map<Map::Id, std::vector<GameSession*>, MapIdHasher>;
+
     Sessions sessions_;
+    // Экземпляры сессий каждой карты в порядке создания
+    SessionDirectory session_directory_;
+    std::size_t max_players_per_session_ = 0;
     Players players_;
     MapIdToIndex map_id_to_index_;
     double default_dog_speed_ = .0;
@@ -81,13 +101,15 @@ private:
     double game_time_ = .0;
     double dog_retirement_time_ = .0;
     std::optional<loot_gen::LootGenerator> loot_generator_ = std::nullopt;
+    std::unique_ptr<WorkStealingPool> sim_pool_;
 
 
-    GameSession* FindSessionFromMapId(const std::string& map_id);
+    GameSession* CreateSession(const Map* map);
 
-    void UpdateLostObjects(const GameSession* session, int interval);
+    // Пул для тика сессии или nullptr, если сессию выгоднее считать последовательно
+    WorkStealingPool* GetTickPool(const GameSession& session) const;
 
-    void CollectLostObjects(const GameSession& session);
+    void UpdateLostObjects(GameSession* session, int interval);
 
 };
 
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+ *  Ограниченная очередь без блокировок: много писателей, один читатель.
+ *  У каждой ячейки свой номер последовательности (схема Вьюкова): писатель занимает
+ *  позицию одним CAS и публикует ячейку записью номера, читатель забирает её без CAS.
+ *  Заполненная очередь не ждёт читателя — TryPush возвращает false.
+ */
+template <typename T>
+class MpscRing {
+public:
+    // Ёмкость округляется вверх до степени двойки
+    explicit MpscRing(std::size_t capacity)
+        : capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        mask_(capacity_ - 1),
+        cells_(std::make_unique<Cell[]>(capacity_))
+    {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    std::size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Может вызываться из любого потока
+    bool TryPush(const T& value) noexcept {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Ячейка ещё не прочитана с прошлого круга — очередь полна
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Вызывается только из потока читателя
+    bool TryPop(T& value) noexcept {
+        Cell& cell = cells_[dequeue_pos_ & mask_];
+        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(dequeue_pos_ + 1) < 0) {
+            // Писатель ещё не занял или не дописал ячейку
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(dequeue_pos_ + capacity_, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    // Позиция читателя, её меняет только он
+    alignas(64) std::size_t dequeue_pos_ = 0;
+};
@@ -31,6 +31,7 @@ Token PlayerTokens::AddPlayer(Player& player) {
     ss << std::hex << std::setfill('0') << std::setw(16) << generator2_.operator()();
     Token token{ss.str()};
     token_to_player_[token] = &player;
+    dog_to_token_.insert_or_assign(player.GetDog(), token);
 
     return token;
 }
@@ -39,6 +40,7 @@ void PlayerTokens::AddPlayerWithToken(std::string t, Player &player)
 {
     Token token{t};
     token_to_player_[token] = &player;
+    dog_to_token_.insert_or_assign(player.GetDog(), token);
 }
 
 std::unordered_map<Token, Player *, TokenHasher>& PlayerTokens::TokenAndPlayer()
@@ -48,13 +50,24 @@ std::unordered_map<Token, Player *, TokenHasher>& PlayerTokens::TokenAndPlayer()
 
 void PlayerTokens::DeleteByToken(Token token) {
     if (token_to_player_.count(token) != 0) {
+        if (Player* player = token_to_player_.at(token)) {
+            dog_to_token_.erase(player->GetDog());
+        }
         token_to_player_.at(token) = nullptr;
     }
 }
 
+std::optional<Token> PlayerTokens::FindTokenByDog(const Dog* dog) const {
+    if (auto it = dog_to_token_.find(dog); it != dog_to_token_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
 //! ------------------------- Players --------------------------------
 
 std::pair<Player*, Token> Players::Add(Dog& dog, GameSession& session) {
+    std::unique_lock lock{mutex_};
     players_.emplace_back(Player{&session, &dog});
     auto token = player_tokens_.AddPlayer(players_.back());
     auto player_ptr = player_tokens_.FindPlayerByToken(token);
@@ -64,11 +77,25 @@ std::pair<Player*, Token> Players::Add(Dog& dog, GameSession& session) {
 
 void Players::AddPlayer(Player player)
 {
+    std::unique_lock lock{mutex_};
     players_.emplace_back(std::move(player));
 }
 
-Player* Players::FindByToken(Token token) {
-    return player_tokens_.FindPlayerByToken(token);
+void Players::AddPlayerWithToken(Player player, std::string token)
+{
+    std::unique_lock lock{mutex_};
+    players_.emplace_back(std::move(player));
+    player_tokens_.AddPlayerWithToken(std::move(token), players_.back());
+}
+
+Player* Players::FindByToken(Token token) const {
+    std::shared_lock lock{mutex_};
+    return const_cast<PlayerTokens&>(player_tokens_).FindPlayerByToken(token);
+}
+
+std::optional<Token> Players::FindTokenByDog(const Dog* dog) const {
+    std::shared_lock lock{mutex_};
+    return player_tokens_.FindTokenByDog(dog);
 }
 
 std::deque<Player>& Players::GetAllPlayers() {
@@ -81,7 +108,8 @@ PlayerTokens* Players::GetPlayersWithTokens()
 }
 
 void Players::DeletePlayerByToken(Token token) {
-    if (FindByToken(token)) {
+    std::unique_lock lock{mutex_};
+    if (player_tokens_.FindPlayerByToken(token)) {
         player_tokens_.DeleteByToken(token);
     }
 }
@@ -2,6 +2,10 @@
 
 #include "game_session.h"
 
+#include <optional>
+#include <random>
+#include <shared_mutex>
+
 struct TokenTag {
     std::string tag;
 };
@@ -39,11 +43,15 @@ public:
 
     void DeleteByToken(Token token);
 
+    std::optional<Token> FindTokenByDog(const Dog* dog) const;
+
     std::unordered_map<Token, Player*, TokenHasher>& TokenAndPlayer();
 
 private:
 
     std::unordered_map<Token, Player*, TokenHasher> token_to_player_;
+    // Обратный индекс для ухода игроков из сессии: токены только активных игроков
+    std::unordered_map<const Dog*, Token> dog_to_token_;
 
     std::random_device random_device_;
     std::mt19937_64 generator1_{[this] {
@@ -57,14 +65,25 @@ private:
 };
 
 
+/*
+ *  Реестр игроков общий для всех сессий: его читают и меняют из strand разных сессий,
+ *  поэтому все методы, кроме GetAllPlayers и GetPlayersWithTokens, защищены мьютексом.
+ *  Объекты Player не удаляются, так что указатель на игрока остаётся действительным.
+ */
 class Players {
 public:
     std::pair<Player*, Token> Add(Dog& dog, GameSession& session);
 
     void AddPlayer(Player player);
 
-    Player* FindByToken(Token token);
+    // Восстанавливает игрока с ранее выданным токеном
+    void AddPlayerWithToken(Player player, std::string token);
+
+    Player* FindByToken(Token token) const;
+
+    std::optional<Token> FindTokenByDog(const Dog* dog) const;
 
+    // Без блокировки: только когда другие потоки не работают с игроками
     std::deque<Player>& GetAllPlayers();
 
     PlayerTokens* GetPlayersWithTokens();
@@ -72,6 +91,7 @@ public:
     void DeletePlayerByToken(Token token);
 
 private:
+    mutable std::shared_mutex mutex_;
     PlayerTokens player_tokens_;
     std::deque<Player> players_;
 };
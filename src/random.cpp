@@ -0,0 +1,98 @@
+#include "random.h"
+
+#include <atomic>
+#include <random>
+
+namespace rng {
+
+namespace {
+
+std::uint64_t SplitMix64(std::uint64_t& x) noexcept {
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t MakeRandomSeed() {
+    std::random_device random_device;
+    return (static_cast<std::uint64_t>(random_device()) << 32) ^ random_device();
+}
+
+std::atomic<std::uint64_t> global_seed{MakeRandomSeed()};
+std::atomic<std::uint64_t> thread_counter{0};
+
+// Метка ключей генераторов потоков выполнения, чтобы они не совпадали с ключами сессий
+const std::uint64_t THREAD_STREAM_TAG = 0x7468726561640000ull;
+
+} // namespace
+
+Xoshiro256::Xoshiro256(std::uint64_t seed) noexcept {
+    // Состояние заполняется через splitmix64, поэтому близкие зёрна дают несвязанные потоки
+    for (auto& word : state_) {
+        word = SplitMix64(seed);
+    }
+}
+
+int Xoshiro256::NextInt(int min, int max) noexcept {
+    if (max <= min) {
+        return min;
+    }
+    // Метод Лемира: умножение вместо деления, отказ только для редких значений
+    const std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1;
+    std::uint64_t x = (*this)() >> 32;
+    std::uint64_t m = x * range;
+    std::uint32_t low = static_cast<std::uint32_t>(m);
+    if (low < range) {
+        const std::uint32_t threshold = static_cast<std::uint32_t>(-static_cast<std::uint32_t>(range) % range);
+        while (low < threshold) {
+            x = (*this)() >> 32;
+            m = x * range;
+            low = static_cast<std::uint32_t>(m);
+        }
+    }
+    return static_cast<int>(static_cast<std::int64_t>(min) + static_cast<std::int64_t>(m >> 32));
+}
+
+void Xoshiro256::FillDoubles(std::span<double> out, double min, double max) noexcept {
+    const double scale = max - min;
+    for (double& value : out) {
+        value = min + scale * NextDouble();
+    }
+}
+
+void Xoshiro256::FillInts(std::span<int> out, int min, int max) noexcept {
+    for (int& value : out) {
+        value = NextInt(min, max);
+    }
+}
+
+void SetSeed(std::uint64_t seed) noexcept {
+    global_seed = seed;
+}
+
+std::uint64_t GetSeed() noexcept {
+    return global_seed;
+}
+
+Xoshiro256 MakeStream(std::uint64_t stream_id) noexcept {
+    std::uint64_t mix = stream_id;
+    return Xoshiro256{global_seed.load() ^ SplitMix64(mix)};
+}
+
+std::uint64_t StreamId(std::string_view name) noexcept {
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+Xoshiro256& ThreadGenerator() noexcept {
+    thread_local Xoshiro256 generator = MakeStream(THREAD_STREAM_TAG + thread_counter++);
+    return generator;
+}
+
+} // namespace rng
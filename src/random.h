@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+
+namespace rng {
+
+/*
+ *  Генератор xoshiro256**: 32 байта состояния, несколько сдвигов и умножение на число.
+ *  Удовлетворяет требованиям UniformRandomBitGenerator, поэтому годится и для
+ *  стандартных распределений. Не криптостойкий — для токенов не подходит.
+ */
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed = 0) noexcept;
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        const std::uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = Rotl(state_[3], 45);
+        return result;
+    }
+
+    // Равномерно в [0, 1)
+    double NextDouble() noexcept {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    // Равномерно в [min, max)
+    double NextDouble(double min, double max) noexcept {
+        return min + (max - min) * NextDouble();
+    }
+
+    // Равномерно в [min, max], включая границы
+    int NextInt(int min, int max) noexcept;
+
+    // Заполняет out числами, равномерными в [min, max)
+    void FillDoubles(std::span<double> out, double min, double max) noexcept;
+
+    // Заполняет out числами, равномерными в [min, max]
+    void FillInts(std::span<int> out, int min, int max) noexcept;
+
+private:
+    static std::uint64_t Rotl(std::uint64_t x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t state_[4];
+};
+
+// Задаёт общее зерно. Вызывается при старте до создания сессий.
+void SetSeed(std::uint64_t seed) noexcept;
+
+std::uint64_t GetSeed() noexcept;
+
+// Независимый поток для объекта с ключом stream_id, определяемый общим зерном
+Xoshiro256 MakeStream(std::uint64_t stream_id) noexcept;
+
+// Ключ потока по имени, не зависящий от реализации std::hash
+std::uint64_t StreamId(std::string_view name) noexcept;
+
+// Генератор текущего потока выполнения для кода вне сессий
+Xoshiro256& ThreadGenerator() noexcept;
+
+} // namespace rng
@@ -1,8 +1,12 @@
 
 #include "request_handler.h"
 
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+
 #include <algorithm>
 #include <filesystem>
+#include <future>
 
 namespace http_handler {
 
@@ -89,6 +93,71 @@ namespace {
         return ProcessApiError(http::status::bad_request, version, ConstructError("invalidArgument", std::move(message)), keep_alive);
     }
 
+    // Где выполняется API-запрос
+    enum class ApiRoute {
+        // Описание карт не меняется после загрузки, запрос выполняется сразу
+        IN_PLACE,
+        // Вход в игру: координатор находит сессию, сам вход — в strand сессии
+        JOIN,
+        // Запрос игрока выполняется в strand его сессии
+        SESSION,
+        // Глобальные операции: рекорды, ручной тик
+        COORDINATOR
+    };
+
+    struct ApiRouteInfo {
+        ApiEndpoint endpoint;
+        ApiRoute route;
+        router::Methods methods;
+    };
+
+    const std::string_view GAME_TICK_HEADER = "X-Game-Tick";
+    const std::string_view GAME_STATE_HEADER = "X-Game-State";
+
+    // Метка состояния для клиента — "<эпоха>.<тик>". Клиент возвращает её как since, не разбирая.
+    struct StateTag {
+        std::uint64_t epoch;
+        std::uint64_t tick;
+    };
+
+    std::string FormatStateTag(StateTag tag) {
+        return std::to_string(tag.epoch) + '.' + std::to_string(tag.tick);
+    }
+
+    std::optional<StateTag> ParseStateTag(std::string_view text) {
+        const auto dot = text.find('.');
+        if (dot == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto epoch = router::ParseNumber<std::uint64_t>(text.substr(0, dot));
+        const auto tick = router::ParseNumber<std::uint64_t>(text.substr(dot + 1));
+        if (!epoch || !tick) {
+            return std::nullopt;
+        }
+        return StateTag{*epoch, *tick};
+    }
+
+    // Первыми идут самые частые запросы: состояние и действие игрока
+    constexpr router::Route<ApiRouteInfo> API_ROUTES[] = {
+        {"/api/v1/game/state", {ApiEndpoint::STATE, ApiRoute::SESSION, router::GET_HEAD}},
+        {"/api/v1/game/player/action", {ApiEndpoint::PLAYER_ACTION, ApiRoute::SESSION, router::POST}},
+        {"/api/v1/game/players", {ApiEndpoint::PLAYERS, ApiRoute::SESSION, router::GET_HEAD}},
+        {"/api/v1/game/join", {ApiEndpoint::JOIN, ApiRoute::JOIN, router::POST}},
+        {"/api/v1/game/tick", {ApiEndpoint::TICK, ApiRoute::COORDINATOR, router::POST}},
+        {"/api/v1/game/records", {ApiEndpoint::RECORDS, ApiRoute::COORDINATOR, router::GET_HEAD}},
+        {"/api/v1/maps", {ApiEndpoint::MAPS, ApiRoute::IN_PLACE, router::GET_HEAD}},
+        {"/api/v1/maps/:id", {ApiEndpoint::MAP, ApiRoute::IN_PLACE, router::GET_HEAD}},
+        {"/api/v1/admin/tick-stats", {ApiEndpoint::TICK_STATS, ApiRoute::IN_PLACE, router::GET_HEAD}}
+    };
+
+    static_assert(router::IsUnambiguous(API_ROUTES));
+
+    // Запросы с путём /api/... обрабатывает API, остальные — раздача файлов
+    constexpr bool IsApiTarget(const router::Target& target) noexcept {
+        const auto segments = target.GetSegments();
+        return segments.size() >= 2 && segments[0] == "api";
+    }
+
     bool IsDirectionValid(const std::string_view dir) {
         return dir.length() == 1 && (dir[0] == Direction::NORTH || 
                                     dir[0] == Direction::SOUTH || 
@@ -96,56 +165,348 @@ namespace {
                                     dir[0] == Direction::EAST);
     }
 
+    // Сводка гистограммы длительностей для /api/v1/admin/tick-stats
+    json::object MakeHistogramObject(const DurationHistogram& histogram) {
+        json::object result;
+        result["count"] = histogram.GetCount();
+        result["meanMs"] = histogram.GetMean();
+        result["p50Ms"] = histogram.GetPercentile(0.5);
+        result["p90Ms"] = histogram.GetPercentile(0.9);
+        result["p99Ms"] = histogram.GetPercentile(0.99);
+        result["maxMs"] = histogram.GetMax();
+        return result;
+    }
+
+    // Время от постановки запроса в очередь strand до начала его обработки
+    metrics::Histogram& GetStrandWaitHistogram(const std::string& strand) {
+        return metrics::GetRegistry().GetHistogram("game_strand_queue_wait_seconds",
+            "Time an API request waits in a strand queue before it is handled", {"strand"}, {strand});
+    }
+
+    void ObserveStrandWait(metrics::Histogram& histogram, std::chrono::steady_clock::time_point queued) {
+        histogram.Observe(std::chrono::steady_clock::now() - queued);
+    }
+
+    // Задача обхода сессий завершилась исключением: обход продолжается, ошибка идёт в журнал и метрику
+    void ReportSessionTaskFailure(std::string_view what) {
+        static metrics::Counter& failures = metrics::GetRegistry().GetCounter("game_task_failures_total",
+            "Simulation steps and session tasks that ended with an exception", {"task"}, {"session"});
+        failures.Increment();
+        async_log::LogError(0, what, "session task"sv);
+    }
+
+    // Вариант статического файла в памяти, готовый к отправке
+    template <typename Body>
+    struct StaticVariant {
+        std::string_view content_type;
+        std::string_view etag;
+        bool gzip = false;
+        // У файла есть сжатый вариант: ответ зависит от Accept-Encoding
+        bool vary = false;
+        typename Body::value_type body;
+    };
+
+    // 304, если клиент прислал тот же ETag, иначе ответ с телом из памяти
+    template <typename Body>
+    Response MakeStaticResponse(StaticVariant<Body> variant, std::string_view cache_control, StringRequest& req) {
+        auto set_validators = [&](auto& response) {
+            response.set(http::field::etag, variant.etag);
+            response.set(http::field::cache_control, cache_control);
+            if (variant.vary) {
+                response.set(http::field::vary, "Accept-Encoding"s);
+            }
+            response.keep_alive(req.keep_alive());
+        };
+
+        if (auto it = req.find(http::field::if_none_match); it != req.end() && static_cache::MatchesEtag(it->value(), variant.etag)) {
+            StringResponse response(http::status::not_modified, req.version());
+            set_validators(response);
+            return response;
+        }
+
+        http::response<Body> response(http::status::ok, req.version());
+        set_validators(response);
+        response.set(http::field::content_type, variant.content_type);
+        if (variant.gzip) {
+            response.set(http::field::content_encoding, "gzip"s);
+        }
+        response.content_length(Body::size(variant.body));
+        // На HEAD отдаются только заголовки с длиной тела
+        if (req.method() != http::verb::head) {
+            response.body() = std::move(variant.body);
+        }
+        return response;
+    }
+
 } //namespace
 
+//! -------------------------Metrics --------------------------------
+
+EndpointMetrics::EndpointMetrics(std::string_view endpoint)
+    : endpoint_(endpoint),
+    duration_(metrics::GetRegistry().GetHistogram("game_http_request_duration_seconds",
+        "Time from receiving an HTTP request to sending the response", {"endpoint"}, {endpoint_}))
+{
+}
+
+void EndpointMetrics::ObserveRequest(unsigned status, std::chrono::steady_clock::duration duration) {
+    GetRequestsCounter(status).Increment();
+    duration_.Observe(duration);
+}
+
+metrics::Counter& EndpointMetrics::GetRequestsCounter(unsigned status) {
+    auto lookup = [this, status]() -> metrics::Counter& {
+        return metrics::GetRegistry().GetCounter("game_http_requests_total", "HTTP requests by endpoint and status code",
+                                                 {"endpoint", "code"}, {endpoint_, std::to_string(status)});
+    };
+    if (status < MIN_STATUS || status > MAX_STATUS) {
+        return lookup();
+    }
+    // Реестр возвращает один и тот же ряд, поэтому гонка двух первых ответов безвредна
+    auto& cached = requests_[status - MIN_STATUS];
+    metrics::Counter* counter = cached.load(std::memory_order_acquire);
+    if (counter == nullptr) {
+        counter = &lookup();
+        cached.store(counter, std::memory_order_release);
+    }
+    return *counter;
+}
+
+EndpointMetrics& GetEndpointMetrics(std::string_view target) {
+    // Маршруты API в порядке таблицы, затем статика и неизвестные пути API
+    static const std::vector<std::unique_ptr<EndpointMetrics>> endpoints = [] {
+        std::vector<std::unique_ptr<EndpointMetrics>> result;
+        for (const auto& route : API_ROUTES) {
+            result.push_back(std::make_unique<EndpointMetrics>(route.pattern.GetText()));
+        }
+        result.push_back(std::make_unique<EndpointMetrics>("static"));
+        result.push_back(std::make_unique<EndpointMetrics>("other"));
+        return result;
+    }();
+    const std::size_t routes_count = std::size(API_ROUTES);
+
+    const router::Target parsed{target};
+    if (!IsApiTarget(parsed)) {
+        return *endpoints[routes_count];
+    }
+    if (const auto match = router::FindRoute(API_ROUTES, parsed); match.route) {
+        return *endpoints[static_cast<std::size_t>(match.route - API_ROUTES)];
+    }
+    return *endpoints[routes_count + 1];
+}
+
+metrics::Gauge& GetRequestsInFlight() {
+    static metrics::Gauge& gauge = metrics::GetRegistry().GetGauge("game_http_requests_in_flight",
+        "HTTP requests received and not yet answered");
+    return gauge;
+}
+
 //! -------------------------Request handler --------------------------------
 
-std::vector<std::string> RequestHandler::GetURIPath(std::string& target) {
-    std::vector<std::string> target_uri;
-    boost::split(target_uri, target, boost::is_any_of("/"));
-    auto isEmptyOrBlank = [](const std::string &s) {
-        return s.find_first_not_of(" \t") == std::string::npos;
+void RequestHandler::HandleRequest(StringRequest&& req, std::string& root_path, ResponseSender send) {
+    if (!IsApiTarget(router::Target{req.target()})) {
+        std::string target{req.target()};
+        return send(file_handler_(http::status::ok, root_path, target, req));
+    }
+
+    auto request = std::make_shared<StringRequest>(std::move(req));
+    // Разбор повторяется после переноса запроса: представления должны ссылаться на target в request
+    const router::Target target{request->target()};
+    const auto match = router::FindRoute(API_ROUTES, target);
+    if (!match.route) {
+        return send(MakeBadRequestError(request->version(), request->keep_alive()));
+    }
+    const ApiRouteInfo& info = match.route->value;
+    // Ручной тик недоступен, если тик идёт по таймеру
+    if (info.endpoint == ApiEndpoint::TICK && app_.IsCommandTickSet()) {
+        return send(MakeInvalidArgumentError(request->version(), request->keep_alive(), "Invalid endpoint"s));
+    }
+    if (!info.methods.Allows(request->method())) {
+        return send(MakeInvalidMethodError(request->version(), request->keep_alive(), info.methods.GetAllow()));
+    }
+
+    const ApiRequest api_request{info.endpoint, match.params[0], target.GetQuery()};
+    auto handle = [self = shared_from_this(), request, api_request, send = std::move(send)](GameSession* session) mutable {
+        Response response;
+        try {
+            response = self->api_handler_(http::status::ok, api_request, *request, session);
+        } catch (const std::exception& ex) {
+            async_log::LogError(0, ex.what(), "api request"sv);
+        }
+        send(std::move(response));
     };
-    if (target_uri.size() > 0) {
-        target_uri.erase(std::remove_if(target_uri.begin(), target_uri.end(), isEmptyOrBlank), target_uri.end());
-    }
-
-    return target_uri;
-}
-
-bool IsGetOrHeadRequest(const boost::beast::http::verb& method) {
-    return method == http::verb::get || method == http::verb::head;
-}
-
-bool RequestHandler::CheckRequestValid(Response& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    bool result = true;
-    boost::beast::http::verb method = req.method();
-    if (target_uri[0] == "api") {
-        if (target_uri[1] != "v1" && IsGetOrHeadRequest(method)) {
-            response = MakeBadRequestError(req.version(), req.keep_alive());
-            result = false;
-        }
-        if (target_uri[1] == "v1") {
-            if (target_uri[2] == "maps") {
-                if (!IsGetOrHeadRequest(method)) {
-                    response = MakeInvalidMethodError(req.version(), req.keep_alive());
-                    result = false;
-                }
-                if (target_uri.size() == 4 && 
-                        app_.FindMapById(Map::Id(static_cast<std::string>(target_uri[3]))) == nullptr) {
-                    response = ProcessApiError(http::status::not_found, req.version(), ConstructError("mapNotFound", "Map not found"), req.keep_alive());
-                    result = false;
-                }
-            } 
-            if (target_uri[2] == "game" && target_uri[3] == "join" && req.method() != http::verb::post) {
-                response = MakeInvalidMethodError(req.version(), req.keep_alive(), "POST"s);
-                result = false;
+
+    static metrics::Histogram& session_wait = GetStrandWaitHistogram("session");
+    static metrics::Histogram& coordinator_wait = GetStrandWaitHistogram("coordinator");
+    const auto queued = std::chrono::steady_clock::now();
+
+    switch (info.route) {
+    case ApiRoute::IN_PLACE:
+        handle(nullptr);
+        break;
+    case ApiRoute::SESSION:
+        // Без действительного токена запрос не трогает сессий: ошибка формируется сразу
+        if (GameSession* session = api_handler_.FindRequestSession(*request)) {
+            net::dispatch(GetSessionStrand(session), [handle = std::move(handle), session, queued]() mutable {
+                ObserveStrandWait(session_wait, queued);
+                handle(session);
+            });
+        } else {
+            handle(nullptr);
+        }
+        break;
+    case ApiRoute::JOIN:
+        net::dispatch(coordinator_strand_, [self = shared_from_this(), request, handle = std::move(handle), queued]() mutable {
+            ObserveStrandWait(coordinator_wait, queued);
+            GameSession* session = self->api_handler_.FindJoinSession(*request);
+            if (session == nullptr) {
+                return handle(nullptr);
+            }
+            self->EnsureSessionActors();
+            net::dispatch(self->GetSessionStrand(session), [handle = std::move(handle), session,
+                                                            session_queued = std::chrono::steady_clock::now()]() mutable {
+                ObserveStrandWait(session_wait, session_queued);
+                handle(session);
+            });
+        });
+        break;
+    case ApiRoute::COORDINATOR:
+        net::dispatch(coordinator_strand_, [handle = std::move(handle), queued]() mutable {
+            ObserveStrandWait(coordinator_wait, queued);
+            handle(nullptr);
+        });
+        break;
+    }
+}
+
+void RequestHandler::StartTicker(std::chrono::milliseconds period) {
+    app_.SetTickAvailable();
+    net::dispatch(coordinator_strand_, [self = shared_from_this(), period] {
+        self->tick_period_ = period;
+        self->EnsureSessionActors();
+        self->coordinator_ticker_ = std::make_shared<Ticker>(self->coordinator_strand_, period, [self](std::chrono::milliseconds delta) {
+            self->AdvanceGameTime(delta.count());
+        });
+        self->coordinator_ticker_->Start();
+    });
+}
+
+void RequestHandler::StartFixedStepTicker(std::chrono::milliseconds step, unsigned max_catch_up) {
+    app_.SetTickAvailable();
+    // Планировщик принадлежит обработчику и останавливается раньше него, поэтому this не продлеваем
+    scheduler_ = std::make_unique<SimScheduler>(step, max_catch_up, [this](std::chrono::milliseconds step) {
+        auto done = std::make_shared<std::promise<void>>();
+        auto future = done->get_future();
+        net::dispatch(coordinator_strand_, [self = shared_from_this(), step, done] {
+            self->RunTick(static_cast<int>(step.count()), [done] {
+                done->set_value();
+            });
+        });
+        return future;
+    });
+    scheduler_->Start();
+}
+
+void RequestHandler::StopTicker() {
+    if (scheduler_) {
+        scheduler_->Stop();
+    }
+}
+
+Strand RequestHandler::GetSessionStrand(GameSession* session) {
+    {
+        std::shared_lock lock{actors_mutex_};
+        if (auto it = actors_.find(session); it != actors_.end()) {
+            return it->second.strand;
+        }
+    }
+    std::unique_lock lock{actors_mutex_};
+    auto [it, inserted] = actors_.try_emplace(session, SessionActor{session, net::make_strand(ioc_), nullptr});
+    return it->second.strand;
+}
+
+void RequestHandler::EnsureSessionActors() {
+    for (auto& session : *game_.GetSessions()) {
+        GetSessionStrand(&session);
+    }
+    if (!tick_period_) {
+        return;
+    }
+    std::unique_lock lock{actors_mutex_};
+    for (auto& [key, actor] : actors_) {
+        // Тикеры создаются и запускаются только здесь, в strand координатора
+        if (!actor.ticker) {
+            GameSession* session = actor.session;
+            actor.ticker = std::make_shared<Ticker>(actor.strand, *tick_period_,
+                [self = shared_from_this(), session](std::chrono::milliseconds delta) {
+                    self->app_.TickSession(*session, delta.count());
+                });
+            actor.ticker->Start();
+        }
+    }
+}
+
+RequestHandler::SessionTargets RequestHandler::GetSessionTargets() {
+    SessionTargets targets;
+    std::shared_lock lock{actors_mutex_};
+    targets.reserve(actors_.size());
+    for (const auto& [key, actor] : actors_) {
+        targets.emplace_back(actor.session, actor.strand);
+    }
+    return targets;
+}
+
+void RequestHandler::ForEachSession(SessionTargets targets, std::function<void(GameSession&, std::size_t)> fn, std::function<void()> done) {
+    if (targets.empty()) {
+        net::dispatch(coordinator_strand_, std::move(done));
+        return;
+    }
+    auto remaining = std::make_shared<std::atomic<std::size_t>>(targets.size());
+    auto shared_fn = std::make_shared<std::function<void(GameSession&, std::size_t)>>(std::move(fn));
+    auto shared_done = std::make_shared<std::function<void()>>(std::move(done));
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        net::post(targets[i].second, [self = shared_from_this(), session = targets[i].first, i, remaining, shared_fn, shared_done] {
+            // Ошибка в одной сессии не должна оставить остальных без завершения обхода
+            try {
+                (*shared_fn)(*session, i);
+            } catch (const std::exception& e) {
+                ReportSessionTaskFailure(e.what());
+            } catch (...) {
+                ReportSessionTaskFailure("unknown exception"sv);
+            }
+            if (--*remaining == 0) {
+                net::post(self->coordinator_strand_, *shared_done);
             }
+        });
+    }
+}
+
+void RequestHandler::RunTick(int delta, std::function<void()> on_done) {
+    EnsureSessionActors();
+    ForEachSession(GetSessionTargets(), [self = shared_from_this(), delta](GameSession& session, std::size_t) {
+        self->app_.TickSession(session, delta);
+    }, [self = shared_from_this(), delta, on_done = std::move(on_done)] {
+        self->AdvanceGameTime(delta);
+        if (on_done) {
+            on_done();
         }
+    });
+}
 
-    } 
+void RequestHandler::AdvanceGameTime(double delta) {
+    if (app_.AdvanceGameTime(delta)) {
+        SaveStateAsync();
+    }
+}
 
-    return result;
+void RequestHandler::SaveStateAsync() {
+    auto targets = GetSessionTargets();
+    auto snapshots = std::make_shared<std::vector<SessionSnapshot>>(targets.size());
+    ForEachSession(std::move(targets), [self = shared_from_this(), snapshots](GameSession& session, std::size_t i) {
+        (*snapshots)[i] = self->app_.MakeSessionSnapshot(session);
+    }, [self = shared_from_this(), snapshots] {
+        self->app_.SaveSnapshots(*snapshots);
+    });
 }
 
 //! -------------------------API handler --------------------------------
@@ -168,22 +529,45 @@ std::optional<std::vector<std::string>> ApiHandler::GetPlayerTokenFromRequest(St
     return header_values;
 }
 
-std::string ApiHandler::MakeMapBody(std::vector<std::string>& target_uri) {
-    std::string body;
-    if (target_uri.size() == 3) {
-        body = json_loader::GetSerializedMaps(app_->GetAllMaps());
-    } else if (target_uri.size() == 4) {
-        auto id = target_uri[3];
-        auto map = app_->FindMapById(Map::Id(static_cast<std::string>(id)));
+GameSession* ApiHandler::FindRequestSession(StringRequest& req) {
+    if (auto token = GetPlayerTokenFromRequest(req)) {
+        if (auto player = app_->FindPlayerByToken(Token{token.value()[1]})) {
+            return player->GetSession();
+        }
+    }
+    return nullptr;
+}
 
-        body = json_loader::GetSerializedMap(*map);
+GameSession* ApiHandler::FindJoinSession(StringRequest& req) {
+    try {
+        auto req_body = json::parse(req.body());
+        // Место в сессии занимается только под корректный запрос входа
+        if (req_body.at("userName").as_string().empty()) {
+            return nullptr;
+        }
+        auto map_id = static_cast<std::string>(req_body.at("mapId").as_string());
+        return app_->FindJoinableSession(map_id);
+    } catch (const std::exception&) {
+        return nullptr;
     }
+}
 
-    return body;
+StringResponse ApiHandler::GetMapsResponse(StringResponse& response, StringRequest& req) {
+    auto body = json_loader::GetSerializedMaps(app_->GetAllMaps());
+    response.body() = body;
+    response.content_length(body.size());
+    response.keep_alive(req.keep_alive());
+    response.set(http::field::allow, "GET, HEAD"s);
+
+    return response;
 }
 
-StringResponse ApiHandler::GetMapResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    auto body = MakeMapBody(target_uri);
+StringResponse ApiHandler::GetMapResponse(StringResponse& response, std::string_view map_id, StringRequest& req) {
+    auto map = app_->FindMapById(Map::Id(std::string(map_id)));
+    if (map == nullptr) {
+        return ProcessApiError(http::status::not_found, req.version(), ConstructError("mapNotFound", "Map not found"), req.keep_alive());
+    }
+    auto body = json_loader::GetSerializedMap(*map);
     response.body() = body;
     response.content_length(body.size());
     response.keep_alive(req.keep_alive());
@@ -192,19 +576,21 @@ StringResponse ApiHandler::GetMapResponse(StringResponse& response, std::vector<
     return response;
 }
 
-std::string ApiHandler::MakeJoinBody(std::string& username, std::string& map_id) {
-    auto player_and_token = app_->JoinPlayer(username, map_id);
-    auto id = const_cast<Dog*>(player_and_token.first->GetDog())->GetId();
-    std::string body = json_loader::GetSerialezedJoinBody(*player_and_token.second, id);
+std::string ApiHandler::MakeJoinBody(const Player& player, const Token& token) {
+    auto id = player.GetDog()->GetId();
+    std::string body = json_loader::GetSerialezedJoinBody(*token, id);
 
     return body;
 }
 
-StringResponse ApiHandler::GetPlayerJoinResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
+StringResponse ApiHandler::GetPlayerJoinResponse(StringResponse& response, StringRequest& req, GameSession* session) {
     json::value req_body;
     std::string username;
     std::string map_id;
 
+    // Место, занятое координатором под этот запрос, возвращается, если игрок так и не вошёл
+    SeatGuard seat{session};
+
     try {
         req_body = json::parse(req.body());
 
@@ -220,8 +606,13 @@ StringResponse ApiHandler::GetPlayerJoinResponse(StringResponse& response, std::
         } 
     } catch(const std::exception&) {
         return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Join game request parse error"s);
-    }                                                    
-    auto body = MakeJoinBody(username, map_id);
+    }
+    if (session == nullptr || *session->GetMap()->GetId() != map_id) {
+        throw std::logic_error("Join request must be executed in the strand of the session"s);
+    }
+    auto [player, token] = app_->JoinPlayer(username, *session);
+    seat.Dismiss();
+    auto body = MakeJoinBody(*player, token);
     response.body() = body;
     response.content_length(body.size());
     response.keep_alive(req.keep_alive());
@@ -244,11 +635,7 @@ std::string ApiHandler::MakePlayersBody(Player* player) {
     return body;
 }
 
-StringResponse ApiHandler::GetPlayersResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    if (!IsGetOrHeadRequest(req.method())) {
-        return MakeInvalidMethodError(req.version(), req.keep_alive());
-    }
-
+StringResponse ApiHandler::GetPlayersResponse(StringResponse& response, StringRequest& req) {
     return ExecuteAuthorized([&req, &response, this](const Token& token){
         auto player = app_->FindPlayerByToken(token);
         if (player == nullptr) {
@@ -265,79 +652,47 @@ StringResponse ApiHandler::GetPlayersResponse(StringResponse& response, std::vec
     }, req);
 }
 
-std::string ApiHandler::MakeStateBody(Player* player) const {
-    json::object result;
-    json::object players;
-    
-    auto session = const_cast<GameSession*>(player->GetSession());
-    auto dogs = const_cast<GameSession*>(player->GetSession())->GetDogs();
-    for (const auto& [id, dog] : *dogs) {
-        if (!dog->IsNeedToRetire()) {
-                    json::object state;
-        auto speed = dog->GetSpeed();
-        auto pos = dog->GetPosition();
-        state["pos"] = json::array{pos.x, pos.y};
-        state["speed"] = json::array{speed.x, speed.y};
-        std::string dir_to_string;
-        dir_to_string += static_cast<char>(dog->GetDirection());
-        state["dir"] = dir_to_string;
-
-        json::array bag;
-        if (dog->GetBagSize() > 0) {
-            for (const auto& [id, type_id] : dog->GetBag()) {
-                json::object obj;
-                obj["id"] = id;
-                obj["type"] = type_id;
-                bag.emplace_back(obj);
-            }
+Response ApiHandler::GetStateResponse(StringRequest& req, std::string_view query) {
+    std::optional<std::uint64_t> since;
+    if (auto value = router::GetQueryParam(query, "since")) {
+        const auto tag = ParseStateTag(*value);
+        if (!tag) {
+            return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Invalid since parameter"s);
         }
-
-        state["bag"] = bag;
-        state["score"] = dog->GetScore();
-        players[std::to_string(id)] = state;
+        // Метка прошлого запуска сервера: её тик ничего не говорит о нынешнем состоянии
+        if (tag->epoch == app_->GetStateEpoch()) {
+            since = tag->tick;
         }
     }
-
-    json::object lost_objects;
-    for (const auto& [id, lost_object] : const_cast<Map*>(session->GetMap())->GetLostObjects()) {
-        json::object lost;
-        lost["type"] = lost_object.loot->GetLootType();
-        lost["pos"] = json::array{lost_object.pos.x, lost_object.pos.y};
-        lost_objects[std::to_string(id)] = lost;
-    }
-
-    result["players"] = players;
-    result ["lostObjects"] = lost_objects;
-    std::string body = json::serialize(result);
-
-    return body;
-}
-
-StringResponse ApiHandler::GetStateResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    if (!IsGetOrHeadRequest(req.method())) {
-        return MakeInvalidMethodError(req.version(), req.keep_alive());
-    }
-
-    return ExecuteAuthorized([&req, &response, this](const Token& token){
+    return ExecuteAuthorized([&req, since, this](const Token& token) -> Response {
         auto player = app_->FindPlayerByToken(token);
         if (player == nullptr) {
             return MakeUnknownTokenError(req.version(), req.keep_alive());
         }
-        auto body = MakeStateBody(player);
-        response.body() = body;
-        response.result(http::status::ok);
-        response.content_length(body.size());
+        GameSession& session = *player->GetSession();
+        std::shared_ptr<const StateSnapshot> snapshot;
+        if (since) {
+            snapshot = app_->GetStateChanges(session, *since);
+        }
+        if (!snapshot) {
+            snapshot = app_->GetStateSnapshot(session);
+        }
+        CachedResponse response(http::status::ok, req.version());
+        response.set(http::field::content_type, "application/json"s);
+        response.set(http::field::cache_control, "no-cache"s);
+        // Клиент передаёт тик в следующем запросе как since и по X-Game-State узнаёт, применять ли ответ поверх прежнего
+        response.set(GAME_TICK_HEADER, FormatStateTag({app_->GetStateEpoch(), snapshot->tick}));
+        response.set(GAME_STATE_HEADER, snapshot->since ? "delta"s : "full"s);
+        // Тело указывает внутрь снимка и продлевает его жизнь до отправки ответа
+        response.body() = std::shared_ptr<const std::string>(snapshot, &snapshot->body);
+        response.content_length(snapshot->body.size());
         response.keep_alive(req.keep_alive());
 
         return response;
     }, req);
 }
 
-StringResponse ApiHandler::GetPlayerActionResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    if (req.method() != http::verb::post) {
-        return MakeInvalidMethodError(req.version(), req.keep_alive(), "POST"s);
-    }
-
+StringResponse ApiHandler::GetPlayerActionResponse(StringResponse& response, StringRequest& req) {
     if (req.at("Content-Type") != "application/json") {
         return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Invalid content type"s);
     }
@@ -363,14 +718,7 @@ StringResponse ApiHandler::GetPlayerActionResponse(StringResponse& response, std
     }, req);
 }
 
-StringResponse ApiHandler::GetTickResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req) {
-    if (app_->IsCommandTickSet()) {
-        return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Invalid endpoint"s);
-    }
-    if (req.method() != http::verb::post) {
-        return MakeInvalidMethodError(req.version(), req.keep_alive(), "POST"s);
-    }
-
+StringResponse ApiHandler::GetTickResponse(StringResponse& response, StringRequest& req) {
     if (req.at("Content-Type") != "application/json") {
         return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Invalid content type"s);
     }
@@ -382,7 +730,13 @@ StringResponse ApiHandler::GetTickResponse(StringResponse& response, std::vector
     } catch (const std::exception&) {
         return MakeInvalidArgumentError(req.version(), req.keep_alive(), "Failed to parse tick request JSON"s);
     }
-    app_->Tick(delta);
+    // Тики сессий ставятся в их strand раньше, чем клиент получит ответ,
+    // поэтому следующие запросы к сессиям увидят уже обновлённое состояние
+    if (tick_runner_) {
+        tick_runner_(delta);
+    } else {
+        app_->Tick(delta);
+    }
     std::string body = "{}"s;
     response.body() = body;
     response.result(http::status::ok);
@@ -406,22 +760,22 @@ std::string ApiHandler::MakeRecordsBody(int start_elem, int max_elem_count) cons
     return json::serialize(result);
 }
 
-StringResponse ApiHandler::GetRecordsResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req, std::string params) {
-    if (!IsGetOrHeadRequest(req.method())) {
-        return MakeInvalidMethodError(req.version(), req.keep_alive());
-    }
-
+StringResponse ApiHandler::GetRecordsResponse(StringResponse& response, StringRequest& req, std::string_view query) {
     int start_elem = 0;
     int max_elem_count = 100;
-    if (!params.empty()) {
-        size_t first = params.find_first_of('=');
-        start_elem = std::stoi(params.substr(first + 1, params.find('&') - first - 1));
-        size_t second = params.find_first_of('=', first + 1);
-        max_elem_count = std::stoi(params.substr(second + 1, params.length() - second));
-        if (max_elem_count > 100) {
+    if (auto start = router::GetQueryParam(query, "start")) {
+        auto value = router::ParseNumber<int>(*start);
+        if (!value || *value < 0) {
             return MakeBadRequestError(req.version(), req.keep_alive());
         }
-
+        start_elem = *value;
+    }
+    if (auto max_items = router::GetQueryParam(query, "maxItems")) {
+        auto value = router::ParseNumber<int>(*max_items);
+        if (!value || *value < 0 || *value > 100) {
+            return MakeBadRequestError(req.version(), req.keep_alive());
+        }
+        max_elem_count = *value;
     }
 
     auto body = MakeRecordsBody(start_elem, max_elem_count);
@@ -433,41 +787,107 @@ StringResponse ApiHandler::GetRecordsResponse(StringResponse& response, std::vec
     return response;
 }
 
+std::string ApiHandler::MakeTickStatsBody() const {
+    json::object result;
 
-Response ApiHandler::ProcessApiRequest(http::status status, std::vector<std::string>& target_uri, StringRequest& req,
-                                                std::string_view content_type) {
-    auto last_target_elem = target_uri[target_uri.size() - 1];
-    std::string last_target_elem_wo_params;
-    std::string params;
-    if (target_uri.size() == 4 && last_target_elem.find_first_of('?') != std::string::npos) {
-        std::size_t q_pos = last_target_elem.find_first_of('?');
+    const TickProfiler* profiler = app_->GetTickProfiler();
+    result["enabled"] = profiler != nullptr;
+    if (profiler) {
+        const TickProfileReport report = profiler->GetReport();
+        std::uint64_t dogs = 0;
+        std::uint64_t lost_objects = 0;
+        json::array sessions;
+        for (const auto& session : report.sessions) {
+            json::object obj;
+            obj["map"] = session.map_id;
+            obj["instance"] = session.instance;
+            obj["ticks"] = session.ticks;
+            obj["dogs"] = session.dogs;
+            obj["movingDogs"] = session.moving_dogs;
+            obj["lostObjects"] = session.lost_objects;
+            obj["players"] = session.players;
+            obj["tick"] = MakeHistogramObject(session.tick);
+            json::object phases;
+            for (std::size_t i = 0; i < TICK_PHASES_COUNT; ++i) {
+                phases[GetTickPhaseName(static_cast<TickPhase>(i))] = MakeHistogramObject(session.phases[i]);
+            }
+            obj["phases"] = phases;
+            sessions.emplace_back(obj);
+            dogs += session.dogs;
+            lost_objects += session.lost_objects;
+        }
+        result["windowTicks"] = SessionTickProfile::TICKS_PER_SLOT * RollingHistogram::SLOTS;
+        result["totals"] = json::object{
+            {"sessions", report.sessions.size()},
+            {"dogs", dogs},
+            {"lostObjects", lost_objects}
+        };
+        result["sessions"] = sessions;
+        json::object save = MakeHistogramObject(report.save);
+        save["total"] = report.saves;
+        result["save"] = save;
+    }
 
-        params = last_target_elem.substr(q_pos + 1, last_target_elem.length() - q_pos);
-        last_target_elem_wo_params = last_target_elem.substr(0, q_pos);
-    } else {
-        last_target_elem_wo_params = last_target_elem;
+    if (scheduler_stats_provider_) {
+        if (auto stats = scheduler_stats_provider_()) {
+            result["scheduler"] = json::object{
+                {"steps", stats->steps},
+                {"droppedSteps", stats->dropped_steps},
+                {"overrunSteps", stats->overrun_steps},
+                {"catchUpWakeups", stats->catch_up_wakeups},
+                {"lastLagMs", stats->last_lag},
+                {"maxLagMs", stats->max_lag},
+                {"lastStepCostMs", stats->last_step_cost},
+                {"maxStepCostMs", stats->max_step_cost},
+                {"totalStepCostMs", stats->total_step_cost}
+            };
+        }
     }
+    return json::serialize(result);
+}
 
-    auto version = req.version();
+StringResponse ApiHandler::GetTickStatsResponse(StringResponse& response, StringRequest& req) {
+    auto body = MakeTickStatsBody();
+    response.body() = body;
+    response.result(http::status::ok);
+    response.content_length(body.size());
+    response.keep_alive(req.keep_alive());
+
+    return response;
+}
+
+Response ApiHandler::ProcessApiRequest(http::status status, const ApiRequest& api_request, StringRequest& req,
+                                                GameSession* session, std::string_view content_type) {
     StringResponse response;
     response.result(status);
     response.set(http::field::content_type, content_type);
-    if (target_uri[2] == "game") {
-        if (target_uri[3] == "join") {
-            response = GetPlayerJoinResponse(response, target_uri, req);
-        } else if (last_target_elem_wo_params == "players") {
-            response = GetPlayersResponse(response, target_uri, req);
-        } else if (last_target_elem_wo_params == "state") {
-            response = GetStateResponse(response, target_uri, req);
-        } else if (target_uri[3] == "player" && last_target_elem_wo_params == "action") {
-            response = GetPlayerActionResponse(response, target_uri, req);
-        } else if (last_target_elem_wo_params == "tick") {
-            response = GetTickResponse(response, target_uri, req);
-        } else if (last_target_elem_wo_params == "records") {
-            response = GetRecordsResponse(response, target_uri, req, params);
-        } 
-    } else {
-        response = GetMapResponse(response, target_uri, req);
+    switch (api_request.endpoint) {
+    case ApiEndpoint::MAPS:
+        response = GetMapsResponse(response, req);
+        break;
+    case ApiEndpoint::MAP:
+        response = GetMapResponse(response, api_request.map_id, req);
+        break;
+    case ApiEndpoint::JOIN:
+        response = GetPlayerJoinResponse(response, req, session);
+        break;
+    case ApiEndpoint::PLAYERS:
+        response = GetPlayersResponse(response, req);
+        break;
+    case ApiEndpoint::STATE:
+        return GetStateResponse(req, api_request.query);
+    case ApiEndpoint::PLAYER_ACTION:
+        response = GetPlayerActionResponse(response, req);
+        break;
+    case ApiEndpoint::TICK:
+        response = GetTickResponse(response, req);
+        break;
+    case ApiEndpoint::RECORDS:
+        response = GetRecordsResponse(response, req, api_request.query);
+        break;
+    case ApiEndpoint::TICK_STATS:
+        response = GetTickStatsResponse(response, req);
+        break;
     }
     response.set(http::field::cache_control, "no-cache");
     return response;
@@ -475,15 +895,6 @@ Response ApiHandler::ProcessApiRequest(http::status status, std::vector<std::str
 
 //! -------------------------File handler --------------------------------
 
-std::string_view FileHandler::GetContentType(std::string_view file_ext)
-{
-    if (content_types_.count(file_ext) == 0) {
-        return content_types_.at("unknown");
-    }
-    
-    return content_types_.at(file_ext);
-}
-
 std::string FileHandler::UrlDecode(const std::string& target) {
     std::istringstream input(target);
     std::ostringstream output;
@@ -530,38 +941,91 @@ http::file_body::value_type FileHandler::MakeFileBody(std::filesystem::path& ful
     return file;
 }
 
+Response FileHandler::MakeCachedResponse(const static_cache::Entry& entry, StringRequest& req) const {
+    const bool gzip = entry.gzip && static_cache::AcceptsGzip(req[http::field::accept_encoding]);
+    return MakeStaticResponse<static_cache::SharedBufferBody>({
+        .content_type = entry.content_type,
+        .etag = gzip ? entry.gzip_etag : entry.etag,
+        .gzip = gzip,
+        .vary = entry.gzip != nullptr,
+        .body = gzip ? entry.gzip : entry.content
+    }, cache_control_, req);
+}
+
+Response FileHandler::ProcessBundleRequest(std::filesystem::path relative, StringRequest& req) const {
+    auto file = bundle_->Find(relative.generic_string());
+    if (!file) {
+        // Каталог: отдаём его index.html
+        file = bundle_->Find((relative / "index.html").generic_string());
+    }
+    if (!file) {
+        return ProcessApiError(http::status::not_found, req.version(), "File not found"s, req.keep_alive(), {}, "text/plain");
+    }
+    const bool gzip = !file->gzip.empty() && static_cache::AcceptsGzip(req[http::field::accept_encoding]);
+    return MakeStaticResponse<static_bundle::MappedBody>({
+        .content_type = file->content_type,
+        .etag = gzip ? file->gzip_etag : file->etag,
+        .gzip = gzip,
+        .vary = !file->gzip.empty(),
+        .body = {bundle_, gzip ? file->gzip : file->content}
+    }, cache_control_, req);
+}
+
 Response FileHandler::ProcessNoneApiRequest(http::status status, std::string& root_path, std::string& target, StringRequest& req) {
-    FileResponse response(status, req.version());
+    // Путь без строки запроса, с раскодированными %XX. Нормализация лексическая, без обращения к диску.
+    std::filesystem::path relative = std::filesystem::path(UrlDecode(std::string(router::Target{target}.GetPath())))
+                                        .relative_path().lexically_normal();
+    if (!relative.empty() && *relative.begin() == "..") {
+        return ProcessApiError(http::status::bad_request, req.version(), "Bad File Request"s, req.keep_alive(), {}, "text/plain");
+    }
+    if (!relative.has_filename()) {
+        relative /= "index.html";
+    }
 
-    std::string s = UrlDecode(target);
+    if (bundle_) {
+        return ProcessBundleRequest(std::move(relative), req);
+    }
+    if (cache_) {
+        auto entry = cache_->Find(relative.generic_string());
+        if (!entry) {
+            // Каталог без "/" на конце: в кэше лежит его index.html, на диск за проверкой не идём
+            entry = cache_->Find((relative / "index.html").generic_string());
+        }
+        if (entry) {
+            return MakeCachedResponse(*entry, req);
+        }
+    }
 
-    auto full_path = std::filesystem::path(root_path + target);
+    auto full_path = std::filesystem::path(root_path) / relative;
     auto full_path_canon = std::filesystem::weakly_canonical(full_path);
 
     if (!std::filesystem::exists(full_path_canon.parent_path()) || 
-        !IsSubPath(std::filesystem::path(full_path), std::filesystem::path(root_path))) {
+        !IsSubPath(full_path, std::filesystem::path(root_path))) {
         return ProcessApiError(http::status::bad_request, req.version(), "Bad File Request"s, req.keep_alive(), {}, "text/plain");
     }
-
+    if (std::filesystem::is_directory(full_path_canon)) {
+        relative /= "index.html";
+        full_path_canon /= "index.html";
+    }
     if (!std::filesystem::exists(full_path_canon)) {
-        return ProcessApiError(http::status::not_found, req.version(), "File not found"s, req.keep_alive(), {}, "text/plain");;
+        return ProcessApiError(http::status::not_found, req.version(), "File not found"s, req.keep_alive(), {}, "text/plain");
     }
-    
-    response.keep_alive(req.keep_alive());
 
-    if (full_path.has_filename()) {
-        auto file_ext = std::filesystem::path(full_path.filename()).extension().string();
-        std::transform(file_ext.begin(), file_ext.end(), file_ext.begin(), ::tolower);
-        std::string_view content_type = GetContentType(file_ext);
-        response.set(http::field::content_type, content_type);
-        auto file = std::move(MakeFileBody(full_path_canon));
-        response.body() = std::move(file);
-    } else {
-        auto index = std::filesystem::weakly_canonical(std::filesystem::path(full_path.string() + "/index.html"));
-        response.set(http::field::content_type, "text/html");
-        response.body() = std::move(MakeFileBody(index));
+    const std::string_view content_type = static_cache::GetContentType(relative);
+
+    if (cache_) {
+        if (auto entry = cache_->Load(relative.generic_string(), full_path_canon, std::string(content_type))) {
+            return MakeCachedResponse(*entry, req);
+        }
     }
 
+    // Файл не помещается в кэш или кэш выключен: отдаём с диска
+    FileResponse response(status, req.version());
+    response.keep_alive(req.keep_alive());
+    response.set(http::field::content_type, content_type);
+    response.set(http::field::cache_control, cache_control_);
+    response.body() = MakeFileBody(full_path_canon);
+
     // Метод prepare_payload заполняет заголовки Content-Length и Transfer-Encoding
     // в зависимости от свойств тела сообщения
     response.prepare_payload();
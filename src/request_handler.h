@@ -2,44 +2,42 @@
 
 #define BOOST_BEAST_USE_STD_STRING_VIEW
 
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/classification.hpp>
 #include <boost/beast.hpp>
 #include <boost/date_time.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/log/core.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/expressions.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
-#include <boost/log/utility/setup/console.hpp>
-#include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "http_server.h"
 #include "application.h"
-
+#include "async_log.h"
+#include "metrics.h"
+#include "router.h"
+#include "sim_scheduler.h"
+#include "static_bundle.h"
+#include "static_cache.h"
+
+#include <atomic>
 #include <chrono>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <type_traits>
 #include <variant>
 #include <vector>
 #include <optional>
 #include <unordered_map>
 
-BOOST_LOG_ATTRIBUTE_KEYWORD(timestamp, "TimeStamp", boost::posix_time::ptime)
-BOOST_LOG_ATTRIBUTE_KEYWORD(additional_data, "AdditionalData", boost::json::value)
-BOOST_LOG_ATTRIBUTE_KEYWORD(custom_message, "CustomMessage", std::string)
-
 namespace http_handler {
 
 using namespace std::literals;
 namespace beast = boost::beast;
 namespace http = beast::http;
-namespace keywords = boost::log::keywords;
-namespace logging = boost::log;
 namespace json = boost::json;
 namespace net = boost::asio;
 namespace sys = boost::system;
@@ -48,127 +46,152 @@ using tcp = net::ip::tcp;
 using StringRequest = http::request<http::string_body>;
 using StringResponse = http::response<http::string_body>;
 using FileResponse = http::response<http::file_body>;
+// Тело ссылается на общий неизменяемый буфер: файл из кэша статики или снимок состояния сессии
+using CachedResponse = http::response<static_cache::SharedBufferBody>;
+// Файл из пакета статики: тело — участок отображённого в память пакета
+using BundleResponse = http::response<static_bundle::MappedBody>;
 
-using Response = std::variant<StringResponse, FileResponse>;
+using Response = std::variant<StringResponse, FileResponse, CachedResponse, BundleResponse>;
 using Strand = net::strand<net::io_context::executor_type>;
+// Принимает готовый ответ; может быть вызван из любого потока
+using ResponseSender = std::function<void(Response&&)>;
+
+// Метрики запросов одного эндпоинта. Ряды в реестре ищутся один раз, на запрос — только Increment и Observe.
+class EndpointMetrics {
+public:
+    explicit EndpointMetrics(std::string_view endpoint);
+
+    EndpointMetrics(const EndpointMetrics&) = delete;
+    EndpointMetrics& operator=(const EndpointMetrics&) = delete;
+
+    // Учитывает обработанный запрос: число запросов по коду ответа и время ответа
+    void ObserveRequest(unsigned status, std::chrono::steady_clock::duration duration);
+
+private:
+    static constexpr unsigned MIN_STATUS = 100;
+    static constexpr unsigned MAX_STATUS = 599;
+
+    metrics::Counter& GetRequestsCounter(unsigned status);
+
+    const std::string endpoint_;
+    metrics::Histogram& duration_;
+    // Счётчик кода ответа находится в реестре при первом таком ответе
+    std::array<std::atomic<metrics::Counter*>, MAX_STATUS - MIN_STATUS + 1> requests_{};
+};
 
+// Метрики эндпоинта запроса. Метка — путь без параметров запроса и id карты, чтобы число рядов было ограничено.
+EndpointMetrics& GetEndpointMetrics(std::string_view target);
+
+// Запросы, принятые сервером и ещё не получившие ответ
+metrics::Gauge& GetRequestsInFlight();
+
+// Пишет запросы и ответы в асинхронный журнал: здесь только заполняются записи, форматирует их поток журнала
 template<class BaseRequestHandler>
 class LoggingRequestHandler : public std::enable_shared_from_this<LoggingRequestHandler<BaseRequestHandler>> {
 public:
     explicit LoggingRequestHandler(BaseRequestHandler& decorated)
     : decorated_{decorated}
     {
-        InitBoostLogFilter();
     }
 
     void LogStartServer(const boost::asio::ip::address& address, const net::ip::port_type& port) {
-        json::value entry{
-            {"port"s, port},
-            {"address"s, address.to_string()}
-        };
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "server started"); 
+        async_log::LogServerStarted(address.to_string(), port);
     }
 
     void LogStopServer(int code) {
-        json::value entry{
-            {"code"s, code}
-        };
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "server exited"); 
+        async_log::LogServerExited(code);
     }
 
     void LogStopServer(int code, const char* exception) {
-        json::value entry{
-            {"code"s, code},
-            {"exception"s, *exception}
-        };
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "server exited"); 
+        async_log::LogServerExited(code, exception);
     }
 
     template <typename Body, typename Allocator, typename Send>
     void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send, std::string& root_path, boost::asio::ip::tcp::endpoint& endpoint) {
-        auto client_ip = endpoint.address().to_string();
-
         auto reqst = std::forward<decltype(req)>(req);
-        LogRequest(reqst, client_ip);
-
-        std::chrono::system_clock::time_point start_ts = std::chrono::system_clock::now();
-        auto resp = decorated_(reqst, root_path);
-        std::chrono::system_clock::time_point end_ts = std::chrono::system_clock::now();
-        auto ms_int = std::chrono::duration_cast<std::chrono::milliseconds>(end_ts - start_ts);
-
-        if (std::holds_alternative<StringResponse>(resp)) {
-            LogResponse(std::get<http::response<http::string_body>>(resp), ms_int.count(), client_ip);
-            send(std::get<http::response<http::string_body>>(resp));
-        } else if (std::holds_alternative<FileResponse>(resp)) {
-            LogResponse(std::get<http::response<http::file_body>>(resp), ms_int.count(), client_ip);
-            send(std::get<http::response<http::file_body>>(resp));
+        // Выборка решается один раз на запрос, чтобы запрос и ответ попадали в журнал вместе
+        const bool logged = async_log::GetLogger().IsEnabled(async_log::Level::INFO) && async_log::GetLogger().SampleRequest();
+        std::string client_ip;
+        if (logged) {
+            client_ip = endpoint.address().to_string();
+            async_log::LogRequestReceived(client_ip, reqst.target(), reqst.method_string());
         }
+
+        EndpointMetrics* endpoint_metrics = &GetEndpointMetrics(reqst.target());
+        GetRequestsInFlight().Add();
+        // steady_clock не скачет при переводе системных часов
+        const auto start_ts = std::chrono::steady_clock::now();
+        // Ответ может быть готов позже и в другом потоке: запросы к игре выполняются в strand сессии
+        decorated_(std::move(reqst), root_path,
+            [self = this->shared_from_this(), send = std::forward<Send>(send), client_ip = std::move(client_ip), logged,
+             start_ts, endpoint_metrics](Response&& resp) mutable {
+                const auto duration = std::chrono::steady_clock::now() - start_ts;
+                auto ms_int = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+
+                std::visit([&](auto& response) {
+                    endpoint_metrics->ObserveRequest(response.result_int(), duration);
+                    if (logged) {
+                        self->LogResponse(response, ms_int.count(), client_ip);
+                    }
+                    send(std::move(response));
+                }, resp);
+                GetRequestsInFlight().Sub();
+            });
     }
 
 private:
     BaseRequestHandler& decorated_;
 
-    static void LogFormatter(logging::record_view const& rec, logging::formatting_ostream& strm) {
-        // Момент времени приходится вручную конвертировать в строку.
-        // Для получения истинного значения атрибута нужно добавить
-        // разыменование. 
-        auto ts = *rec[timestamp];
-        json::value data{
-            {"timestamp", to_iso_extended_string(ts)},
-            {"data", rec[additional_data] ? *rec[additional_data] : json::value{}},
-            {"message", rec[custom_message] ? *rec[custom_message] : std::string{}}
-        };
-
-        strm << json::serialize(data);
-    }
-
-    void InitBoostLogFilter() {
-        logging::add_common_attributes();
-
-        logging::add_console_log(
-            std::clog,
-            keywords::format = &LogFormatter, 
-            keywords::auto_flush = true
-        );
-    }
-
-    void LogRequest(const StringRequest& r, std::string& ip) {
-        json::value entry{
-            {"ip"s, ip},
-            {"URI"s, r.target()},
-            {"method"s, r.method_string()}
-        };
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "request received"); 
-    }
-
     template<typename T>
-    void LogResponse(http::response<T>& r, int resp_time, std::string& ip) {
-        json::value entry{
-            {"ip"s, ip},
-            {"response_time"s, resp_time},
-            {"code"s, r.result_int()},
-            {"content_type"s, r[http::field::content_type]}
-        };
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, entry) << logging::add_value(custom_message, "response sent"); 
+    void LogResponse(http::response<T>& r, std::int64_t resp_time, const std::string& ip) {
+        async_log::LogResponseSent(ip, resp_time, r.result_int(), r[http::field::content_type]);
     }
 };
 
 //! ------------------------- Serialization Listener --------------------------------
 
-struct SerializationObj {
+// Сохранённое состояние одного экземпляра сессии
+struct SessionStateRepr {
     template<class Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned int version) {
         ar & lost_objects;
         ar & tokens_dog;
     }
-    
-    std::unordered_map<std::string, std::unordered_map<int, LostObjectRepr>> lost_objects;
-    std::unordered_map<std::string, std::unordered_map<std::string, DogRepr>> tokens_dog;
+
+    std::unordered_map<int, LostObjectRepr> lost_objects;
+    std::unordered_map<std::string, DogRepr> tokens_dog;
+};
+
+struct SerializationObj {
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int version) {
+        if (version == 0) {
+            // Формат до появления нескольких экземпляров сессии: одна сессия на карту
+            std::unordered_map<std::string, std::unordered_map<int, LostObjectRepr>> lost_objects;
+            std::unordered_map<std::string, std::unordered_map<std::string, DogRepr>> tokens_dog;
+            ar & lost_objects;
+            ar & tokens_dog;
+            for (auto& [map_id, objects] : lost_objects) {
+                SessionInstance(map_id, 0).lost_objects = std::move(objects);
+            }
+            for (auto& [map_id, dogs] : tokens_dog) {
+                SessionInstance(map_id, 0).tokens_dog = std::move(dogs);
+            }
+        } else {
+            ar & sessions;
+        }
+    }
+
+    SessionStateRepr& SessionInstance(const std::string& map_id, std::size_t instance) {
+        auto& instances = sessions[map_id];
+        if (instances.size() <= instance) {
+            instances.resize(instance + 1);
+        }
+        return instances[instance];
+    }
+
+    // Экземпляры сессий каждой карты по номерам
+    std::unordered_map<std::string, std::vector<SessionStateRepr>> sessions;
 };
 
 class SerializationListener : public ApplicationListener, public std::enable_shared_from_this<SerializationListener> {
@@ -184,44 +207,25 @@ public:
         path_ = path;
     }
 
-    void OnTick(double delta, model::Game* game) override {
+    bool OnTick(double delta, model::Game* game) override {
         if (game->GetGameTime() - last_save_time_ >= save_interval_) {
-            SaveState(game);
             last_save_time_ = game->GetGameTime();
+            return true;
         }
+        return false;
     }
 
-    void SaveState(model::Game* game) {
+    void SaveState(const std::vector<SessionSnapshot>& snapshots) override {
         
         std::ofstream ofs(path_);
         if (ofs.is_open()) {
             try {
                 SerializationObj s_object;
 
-                auto maps = game->GetMaps();
-
-                for (const auto& map : maps) {
-                    auto map_id = *map.GetId();
-
-                    for (const auto& [id, lost_obj] : map.GetLostObjects()) {
-                        LostObjectRepr lor;
-                        lor.pos = lost_obj.pos;
-                        lor.type = lost_obj.loot->GetLootType();
-                        s_object.lost_objects[map_id][id] = lor;
-                    }
-                }
-
-                const auto players_with_tokens = const_cast<Players*>(game->GetPlayers())->GetPlayersWithTokens()->TokenAndPlayer();
-
-                for (const auto& [token, player_ptr] : players_with_tokens) {
-                    if (player_ptr) {
-                        auto session = player_ptr->GetSession();
-                        auto map = session->GetMap();
-                        auto map_id = *(map->GetId());
-                        auto dog = DogRepr{*(player_ptr->GetDog())};
-
-                        s_object.tokens_dog[map_id][*(token)] = dog;
-                    }
+                for (const auto& snapshot : snapshots) {
+                    SessionStateRepr& state = s_object.SessionInstance(snapshot.map_id, snapshot.instance);
+                    state.lost_objects = snapshot.lost_objects;
+                    state.tokens_dog = snapshot.tokens_dog;
                 }
 
                 boost::archive::text_oarchive oa{ofs};
@@ -244,29 +248,30 @@ public:
             boost::archive::text_iarchive ia{ifs};
             ia >> s_object;
 
-            for (const auto& [map_id, tokens_dogs] : s_object.tokens_dog) {
-                auto session = game->GetSession(map_id);
-                auto map = const_cast<Map*>(session->GetMap());
+            for (const auto& [map_id, instances] : s_object.sessions) {
+                for (std::size_t instance = 0; instance < instances.size(); ++instance) {
+                    auto session = game->GetSessionInstance(map_id, instance);
+                    if (session == nullptr) {
+                        continue;
+                    }
+                    auto map = const_cast<Map*>(session->GetMap());
+
+                    // Восстановленные игроки занимают места без учёта вместимости
+                    for (const auto& [token, dog_repr] : instances[instance].tokens_dog) {
+                        Dog& dog = session->AddDog(dog_repr.GetId(), dog_repr.GetName());
+                        dog_repr.Restore(dog);
+                        const_cast<Players*>(game->GetPlayers())->AddPlayerWithToken(Player{session, &dog}, token);
+                        session->TakeSeat();
+                    }
 
-                for (const auto& [token, dog_repr] : tokens_dogs) {
-                    session->AddDog(dog_repr.Restore());
-                    Player player{session, &session->GetDogsList().back()};
-                    auto players = const_cast<Players*>(game->GetPlayers());
-                    players->AddPlayer(player);
-                    players->GetPlayersWithTokens()->AddPlayerWithToken(token, players->GetAllPlayers().back());
+                    for (const auto& [id, lost_object_repr] : instances[instance].lost_objects) {
+                        LostObject lo;
+                        lo.pos = lost_object_repr.pos;
+                        lo.loot = map->GetLootByType(lost_object_repr.type);
+                        session->RestoreLostObject(id, lo);
+                    }
                 }
             }
-
-            for (const auto& [map_id, lost_object_reprs] : s_object.lost_objects) {
-                auto session = game->GetSession(map_id);
-                auto map = const_cast<Map*>(session->GetMap());
-                for (const auto& [id, lost_object_repr] : lost_object_reprs) {
-                    LostObject lo;
-                    lo.pos = lost_object_repr.pos;
-                    lo.loot = map->GetLootByType(lost_object_repr.type);
-                    map->SetLostObject(id, lo);
-                }    
-            }
             ifs.close();
             
         } else {
@@ -281,52 +286,99 @@ private:
 
 //! -------------------------API handler --------------------------------
 
+// Эндпоинты API; таблица маршрутов — в request_handler.cpp
+enum class ApiEndpoint {
+    MAPS,
+    MAP,
+    JOIN,
+    PLAYERS,
+    STATE,
+    PLAYER_ACTION,
+    TICK,
+    RECORDS,
+    TICK_STATS
+};
+
+// Запрос, сопоставленный с маршрутом. Представления ссылаются на target запроса.
+struct ApiRequest {
+    ApiEndpoint endpoint;
+    // Параметр :id маршрута карты
+    std::string_view map_id;
+    std::string_view query;
+};
+
 class ApiHandler {
 public:
-    explicit ApiHandler(Application* app, Strand& api_strand)
-        : app_(app),
-        api_strand_(api_strand)
+    // Запускает тик всех сессий, не дожидаясь его окончания
+    using TickRunner = std::function<void(int delta)>;
+    // Счётчики планировщика с фиксированным шагом, nullopt — планировщик не запущен
+    using SchedulerStatsProvider = std::function<std::optional<TickStats>()>;
+
+    explicit ApiHandler(Application* app)
+        : app_(app)
     {
     }
 
     ApiHandler(const ApiHandler&) = delete;
     ApiHandler& operator=(const ApiHandler&) = delete;
 
-    Response operator()(http::status status, std::vector<std::string>& target_uri, StringRequest& req) {
-        return ProcessApiRequest(status, target_uri, req);      
+    // session — сессия, в strand которой выполняется запрос; в неё входит новый игрок
+    // Метод запроса уже проверен по таблице маршрутов
+    Response operator()(http::status status, const ApiRequest& api_request, StringRequest& req, GameSession* session = nullptr) {
+        return ProcessApiRequest(status, api_request, req, session);
     }
+
+    void SetTickRunner(TickRunner tick_runner) {
+        tick_runner_ = std::move(tick_runner);
+    }
+
+    void SetSchedulerStatsProvider(SchedulerStatsProvider provider) {
+        scheduler_stats_provider_ = std::move(provider);
+    }
+
+    // Сессия игрока, от имени которого сделан запрос, или nullptr
+    GameSession* FindRequestSession(StringRequest& req);
+
+    // Сессия, в которую просится игрок в запросе join (создаётся при необходимости), или nullptr
+    GameSession* FindJoinSession(StringRequest& req);
+
 private:
     Application* app_;
-    Strand& api_strand_;
+    TickRunner tick_runner_;
+    SchedulerStatsProvider scheduler_stats_provider_;
     
-    Response ProcessApiRequest(http::status status, std::vector<std::string>& target_uri, StringRequest& req,
-                                                std::string_view content_type = "application/json");
+    Response ProcessApiRequest(http::status status, const ApiRequest& api_request, StringRequest& req,
+                                                GameSession* session, std::string_view content_type = "application/json");
 
     std::optional<std::vector<std::string>> GetPlayerTokenFromRequest(StringRequest& req);
 
-    std::string MakeMapBody(std::vector<std::string>& target_uri);
-    StringResponse GetMapResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    StringResponse GetMapsResponse(StringResponse& response, StringRequest& req);
+    StringResponse GetMapResponse(StringResponse& response, std::string_view map_id, StringRequest& req);
 
-    std::string MakeJoinBody(std::string&, std::string& map_id);
-    StringResponse GetPlayerJoinResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    std::string MakeJoinBody(const Player& player, const Token& token);
+    StringResponse GetPlayerJoinResponse(StringResponse& response, StringRequest& req, GameSession* session);
 
     std::string MakePlayersBody(Player* player);
-    StringResponse GetPlayersResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    StringResponse GetPlayersResponse(StringResponse& response, StringRequest& req);
 
-    std::string MakeStateBody(Player* player) const;
-    StringResponse GetStateResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    // Тело — снимок состояния сессии, общий для всех запросов до её следующего изменения.
+    // С параметром since=<тик> — только изменения после этого тика, если сессия их ещё помнит.
+    Response GetStateResponse(StringRequest& req, std::string_view query);
 
     StringResponse MakeUnauthorizedError(int version, bool keep_alive);
 
-    StringResponse GetPlayerActionResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    StringResponse GetPlayerActionResponse(StringResponse& response, StringRequest& req);
 
-    StringResponse GetTickResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req);
+    StringResponse GetTickResponse(StringResponse& response, StringRequest& req);
 
     std::string MakeRecordsBody(int start_elem, int max_elem_count) const;
-    StringResponse GetRecordsResponse(StringResponse& response, std::vector<std::string>& target_uri, StringRequest& req, std::string params);
+    StringResponse GetRecordsResponse(StringResponse& response, StringRequest& req, std::string_view query);
+
+    std::string MakeTickStatsBody() const;
+    StringResponse GetTickStatsResponse(StringResponse& response, StringRequest& req);
 
     template <typename Fn>
-    StringResponse ExecuteAuthorized(Fn&& action, StringRequest& req) {
+    std::invoke_result_t<Fn, Token> ExecuteAuthorized(Fn&& action, StringRequest& req) {
         if (auto token = GetPlayerTokenFromRequest(req)) {
             return action(Token{token.value()[1]});
         }
@@ -341,115 +393,43 @@ public:
 
     FileHandler& operator=(const FileHandler&) = delete;
 
-    Response operator()(http::status status, std::string& root_path, std::string& target, StringRequest& req) {
-        return ProcessNoneApiRequest(status, root_path, target, req);      
-    }
-
-private:
-
-    const std::unordered_map<std::string_view, std::string> content_types_ = {
-        {".htm", "text/html"},
-        {".html", "text/html"},
-        {".css", "text/css"},
-        {".txt", "text/plain"},
-        {".js", "text/javascript"},
-        {".json", "application/json"},
-        {".xml", "application/xml"},
-        {".png", "image/png"},
-        {".jpg", "image/jpeg"},
-        {".jpe", "image/jpeg"},
-        {".jpeg", "image/jpeg"},
-        {".gif", "image/gif"},
-        {".bmp", "image/bmp"},
-        {".ico", "image/vnd.microsoft.icon"},
-        {".tiff", "image/tiff"},
-        {".tif", "image/tiff"},
-        {".svg", "image/svg+xml"},
-        {".svgz", "image/svg+xml"},
-        {".mp3", "audio/mpeg"},
-        {"unknown", "application/octet-stream"}
-    };
-
-    std::string_view GetContentType(std::string_view file_ext);
-
-    std::string UrlDecode(const std::string& target);
-
-    bool IsSubPath(std::filesystem::path path, std::filesystem::path base);
-
-    http::file_body::value_type MakeFileBody(std::filesystem::path& full_path);
-
-    Response ProcessNoneApiRequest(http::status status, std::string& root_path, std::string& target, StringRequest& req);
-
-};
-
-class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
-public:
-
-    explicit RequestHandler(model::Game& game, Strand api_strand, Application& app)
-        : game_{game},
-        app_(app),
-        api_strand_{api_strand},
-        api_handler_(ApiHandler{&app_, api_strand_})
-    {
+    // Файлы отдаются из кэша в памяти с ETag и gzip; изменения под root отслеживаются через inotify
+    void EnableCache(const std::filesystem::path& root, static_cache::StaticCache::Options options) {
+        cache_ = std::make_unique<static_cache::StaticCache>(root, options);
+        cache_->StartWatching();
     }
 
-    RequestHandler(const RequestHandler&) = delete;
-    RequestHandler& operator=(const RequestHandler&) = delete;
-
-    template <typename Body, typename Allocator>
-    Response operator()(http::request<Body, http::basic_fields<Allocator>>& req, std::string& root_path) {
-        // Обработать запрос request и отправить ответ, используя send
-        auto resp = HandleRequest(req, root_path);
-        return resp;      
+    // Файлы отдаются только из пакета, файловая система не используется
+    void SetBundle(std::shared_ptr<const static_bundle::Bundle> bundle) {
+        bundle_ = std::move(bundle);
     }
 
-    void Update(int tick) {
-        app_.SetTickAvailable();
-        app_.Tick(tick);
+    // Сколько браузер может не перепроверять файл; 0 — перепроверять каждый раз (ответ 304, если файл не менялся)
+    void SetMaxAge(std::chrono::seconds max_age) {
+        cache_control_ = max_age.count() == 0 ? "no-cache"s : "public, max-age="s + std::to_string(max_age.count());
     }
 
-    void SetRandomize() {
-        app_.SetRandomSpawnAvailable();
+    Response operator()(http::status status, std::string& root_path, std::string& target, StringRequest& req) {
+        return ProcessNoneApiRequest(status, root_path, target, req);      
     }
 
 private:
-    model::Game& game_;
-    FileHandler file_handler_ = FileHandler{};
-    ApiHandler api_handler_;
-    Strand api_strand_;
-    Application app_;
 
-    bool CheckRequestValid(Response& response, std::vector<std::string>& target_uri, StringRequest& req);
+    std::string UrlDecode(const std::string& target);
 
-    std::vector<std::string> GetURIPath(std::string& target);
+    bool IsSubPath(std::filesystem::path path, std::filesystem::path base);
 
-    Response HandleRequest(StringRequest& req, std::string& root_path) {
-        using namespace std::literals;
+    http::file_body::value_type MakeFileBody(std::filesystem::path& full_path);
 
-        Response response;
+    Response ProcessNoneApiRequest(http::status status, std::string& root_path, std::string& target, StringRequest& req);
 
-        std::string target = std::string(req.target().data(), req.target().size());
-        std::vector<std::string> target_uri = GetURIPath(target);
+    Response MakeCachedResponse(const static_cache::Entry& entry, StringRequest& req) const;
 
-        auto check_result = CheckRequestValid(response, target_uri, req);
+    Response ProcessBundleRequest(std::filesystem::path relative, StringRequest& req) const;
 
-        if (check_result) {
-            if (target_uri.size() < 2 || target_uri[0] != "api") {
-                response = file_handler_(http::status::ok, root_path, target, req);
-            } else {
-                auto handle = [self = shared_from_this(), &response, &target_uri, &req] {
-                    try {
-                        response = self->api_handler_(http::status::ok, target_uri, req);
-                    } catch (const std::exception& ex) {
-                        std::cout << "Something went wrong: " << ex.what() << '\n';
-                    }
-                };
-                net::dispatch(api_strand_, handle);
-            }
-        }
-
-        return response;
-    }
+    std::unique_ptr<static_cache::StaticCache> cache_;
+    std::shared_ptr<const static_bundle::Bundle> bundle_;
+    std::string cache_control_ = "no-cache"s;
 };
 
 class Ticker : public std::enable_shared_from_this<Ticker> {
@@ -503,5 +483,119 @@ private:
     std::chrono::steady_clock::time_point last_tick_;
 }; 
 
+/*
+ *  Каждая игровая сессия — актор со своим strand: в нём выполняются запросы её игроков
+ *  и её тики, поэтому нагрузка на одну карту не задерживает остальные.
+ *  Через общий strand координатора идут только глобальные операции: поиск и создание
+ *  сессии при входе в игру, таблица рекордов, ручной тик и сохранение состояния.
+ */
+class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
+public:
+
+    explicit RequestHandler(model::Game& game, net::io_context& ioc, Application& app)
+        : game_{game},
+        ioc_(ioc),
+        app_(app),
+        coordinator_strand_{net::make_strand(ioc)},
+        api_handler_(&app_)
+    {
+        api_handler_.SetTickRunner([this](int delta) {
+            RunTick(delta);
+        });
+        // Планировщик создаётся до запуска рабочих потоков и не пересоздаётся
+        api_handler_.SetSchedulerStatsProvider([this]() -> std::optional<TickStats> {
+            if (!scheduler_) {
+                return std::nullopt;
+            }
+            return scheduler_->GetStats();
+        });
+    }
+
+    RequestHandler(const RequestHandler&) = delete;
+    RequestHandler& operator=(const RequestHandler&) = delete;
+
+    template <typename Body, typename Allocator>
+    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, std::string& root_path, ResponseSender send) {
+        // Обработать запрос request и отправить ответ, используя send
+        HandleRequest(std::move(req), root_path, std::move(send));
+    }
+
+    // Включает автоматический тик: у каждой сессии свой таймер в её strand,
+    // а координатор с тем же периодом ведёт общее время игры и сохранение
+    void StartTicker(std::chrono::milliseconds period);
+
+    // Включает тик с фиксированным шагом: отдельный поток планировщика ведёт шкалу
+    // сроков и по одному запускает шаги во всех сессиях, догоняя не больше max_catch_up шагов
+    void StartFixedStepTicker(std::chrono::milliseconds step, unsigned max_catch_up);
+
+    // Останавливает поток планировщика, если он был запущен
+    void StopTicker();
+
+    void SetRandomize() {
+        app_.SetRandomSpawnAvailable();
+    }
+
+    // Вызывается до запуска рабочих потоков
+    void EnableStaticCache(const std::filesystem::path& root, static_cache::StaticCache::Options options) {
+        file_handler_.EnableCache(root, options);
+    }
+
+    // Вызывается до запуска рабочих потоков
+    void UseStaticBundle(std::shared_ptr<const static_bundle::Bundle> bundle) {
+        file_handler_.SetBundle(std::move(bundle));
+    }
+
+    void SetStaticMaxAge(std::chrono::seconds max_age) {
+        file_handler_.SetMaxAge(max_age);
+    }
+
+private:
+    struct SessionActor {
+        GameSession* session;
+        Strand strand;
+        std::shared_ptr<Ticker> ticker;
+    };
+
+    using SessionTargets = std::vector<std::pair<GameSession*, Strand>>;
+
+    model::Game& game_;
+    net::io_context& ioc_;
+    FileHandler file_handler_ = FileHandler{};
+    Application app_;
+    Strand coordinator_strand_;
+    ApiHandler api_handler_;
+
+    std::shared_mutex actors_mutex_;
+    std::unordered_map<const GameSession*, SessionActor> actors_;
+    std::optional<std::chrono::milliseconds> tick_period_;
+    std::shared_ptr<Ticker> coordinator_ticker_;
+    std::unique_ptr<SimScheduler> scheduler_;
+
+    void HandleRequest(StringRequest&& req, std::string& root_path, ResponseSender send);
+
+    // Strand сессии; актор создаётся при первом обращении
+    Strand GetSessionStrand(GameSession* session);
+
+    // Создаёт акторы для сессий, появившихся после прошлого вызова. Выполняется в strand координатора.
+    void EnsureSessionActors();
+
+    SessionTargets GetSessionTargets();
+
+    // Выполняет fn(session, index) в strand каждой сессии из targets,
+    // после завершения всех вызовов выполняет done в strand координатора
+    void ForEachSession(SessionTargets targets, std::function<void(GameSession&, std::size_t)> fn, std::function<void()> done);
+
+    // Тик всех сессий в их strand; затем координатор продвигает время игры и при необходимости сохраняет её.
+    // on_done вызывается в strand координатора после продвижения времени.
+    void RunTick(int delta, std::function<void()> on_done = nullptr);
+
+    void AdvanceGameTime(double delta);
+
+    // Снимки сессий делаются в их strand, файл пишется в strand координатора
+    void SaveStateAsync();
+};
 
 }  // namespace http_handler
+
+// Версия 1: несколько экземпляров сессии на карту
+BOOST_CLASS_VERSION(http_handler::SerializationObj, 1)
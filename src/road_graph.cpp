@@ -0,0 +1,118 @@
+#include "road_graph.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Проекция прямоугольника на ось движения.
+// При движении в отрицательную сторону ось разворачивается, чтобы всегда двигаться к большим значениям.
+struct Span {
+    double from;
+    double to;
+};
+
+Span AlongAxis(const RoadBounds& bounds, bool horizontal, double sign) {
+    const double lo = horizontal ? bounds.min_x : bounds.min_y;
+    const double hi = horizontal ? bounds.max_x : bounds.max_y;
+    return sign > 0 ? Span{lo, hi} : Span{-hi, -lo};
+}
+
+bool CrossContains(const RoadBounds& bounds, bool horizontal, double cross) {
+    return horizontal ? cross >= bounds.min_y && cross <= bounds.max_y
+                      : cross >= bounds.min_x && cross <= bounds.max_x;
+}
+
+} // namespace
+
+void RoadGraph::Build(const RoadIndex& road_index) {
+    const std::size_t roads_count = road_index.GetRoadsCount();
+    link_begin_.assign(roads_count + 1, 0);
+    links_.clear();
+
+    std::vector<std::size_t> neighbours;
+    for (std::size_t road_id = 0; road_id < roads_count; ++road_id) {
+        const RoadBounds& bounds = road_index.GetBounds(road_id);
+
+        neighbours.clear();
+        road_index.ForEachRoadInBox(bounds, [road_id, &neighbours](std::size_t other_id) {
+            if (other_id != road_id) {
+                neighbours.push_back(other_id);
+            }
+        });
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+        for (std::size_t other_id : neighbours) {
+            const RoadBounds& other = road_index.GetBounds(other_id);
+            links_.push_back(Link{static_cast<std::uint32_t>(other_id),
+                                  RoadBounds{std::max(bounds.min_x, other.min_x), std::max(bounds.min_y, other.min_y),
+                                             std::min(bounds.max_x, other.max_x), std::min(bounds.max_y, other.max_y)}});
+        }
+        link_begin_[road_id + 1] = static_cast<std::uint32_t>(links_.size());
+    }
+}
+
+std::span<const RoadGraph::Link> RoadGraph::GetLinks(std::size_t road_id) const {
+    return std::span<const Link>(links_).subspan(link_begin_.at(road_id), link_begin_.at(road_id + 1) - link_begin_[road_id]);
+}
+
+RoadWalk RoadGraph::Walk(const RoadIndex& road_index, std::size_t road_id, double x, double y, double dx, double dy) const {
+    const bool horizontal = dx != 0.0;
+    const double sign = (horizontal ? dx : dy) > 0 ? 1.0 : -1.0;
+    const double cross = horizontal ? y : x;
+    // Координата вдоль (возможно, развёрнутой) оси движения
+    double pos = sign * (horizontal ? x : y);
+    const double target = pos + std::abs(horizontal ? dx : dy);
+
+    auto make_result = [&](double along, std::size_t road, bool stopped) {
+        const double coord = sign * along;
+        return horizontal ? RoadWalk{coord, y, road, stopped} : RoadWalk{x, coord, road, stopped};
+    };
+
+    // Если собака не на своей дороге, выбираем из дорог под ней ту, что ведёт дальше всех
+    if (road_id == RoadIndex::NO_ROAD || !road_index.GetBounds(road_id).Contains(x, y)) {
+        road_id = RoadIndex::NO_ROAD;
+        double best_reach = 0.0;
+        road_index.ForEachRoadAt(x, y, [&](std::size_t candidate) {
+            const double reach = AlongAxis(road_index.GetBounds(candidate), horizontal, sign).to;
+            if (road_id == RoadIndex::NO_ROAD || reach > best_reach) {
+                road_id = candidate;
+                best_reach = reach;
+            }
+        });
+        if (road_id == RoadIndex::NO_ROAD) {
+            return make_result(pos, road_id, true);
+        }
+    }
+
+    while (true) {
+        const double reach = AlongAxis(road_index.GetBounds(road_id), horizontal, sign).to;
+        if (target <= reach) {
+            return make_result(target, road_id, false);
+        }
+
+        // Ищем перекрёсток впереди, через который можно уйти дальше по ходу движения
+        std::size_t next_road = RoadIndex::NO_ROAD;
+        double next_reach = reach;
+        double next_entry = pos;
+        for (const Link& link : GetLinks(road_id)) {
+            const Span junction = AlongAxis(link.junction, horizontal, sign);
+            if (junction.to < pos || !CrossContains(link.junction, horizontal, cross)) {
+                continue;
+            }
+            const double link_reach = AlongAxis(road_index.GetBounds(link.road_id), horizontal, sign).to;
+            if (link_reach > next_reach) {
+                next_road = link.road_id;
+                next_reach = link_reach;
+                next_entry = std::max(pos, junction.from);
+            }
+        }
+
+        if (next_road == RoadIndex::NO_ROAD) {
+            return make_result(reach, road_id, true);
+        }
+        road_id = next_road;
+        pos = next_entry;
+    }
+}
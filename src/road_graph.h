@@ -0,0 +1,48 @@
+#pragma once
+
+#include "road_index.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Результат перемещения по дорогам за один шаг
+struct RoadWalk {
+    double x;
+    double y;
+    std::size_t road_id;
+    // true, если движение упёрлось в край дороги раньше, чем закончилось перемещение
+    bool stopped;
+};
+
+/*
+ *  Граф смежности дорог карты. Для каждой дороги хранится список дорог,
+ *  с которыми она пересекается, вместе с прямоугольником перекрёстка.
+ *  Строится один раз после построения RoadIndex.
+ */
+class RoadGraph {
+public:
+    struct Link {
+        std::uint32_t road_id;
+        // Пересечение расширенных границ двух дорог
+        RoadBounds junction;
+    };
+
+    void Build(const RoadIndex& road_index);
+
+    std::span<const Link> GetLinks(std::size_t road_id) const;
+
+    /*
+     * Перемещает точку (x, y), находящуюся на дороге road_id, на (dx, dy) вдоль одной из осей.
+     * Переходы между дорогами делаются через перекрёстки, поэтому за один вызов можно
+     * пройти любое количество участков. Если дорога заканчивается, точка останавливается на её краю.
+     * Если road_id не задана или точка не на ней, дорога ищется через road_index.
+     */
+    RoadWalk Walk(const RoadIndex& road_index, std::size_t road_id, double x, double y, double dx, double dy) const;
+
+private:
+    // Связи дороги i занимают отрезок [link_begin_[i], link_begin_[i + 1]) в links_
+    std::vector<std::uint32_t> link_begin_;
+    std::vector<Link> links_;
+};
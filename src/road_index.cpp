@@ -0,0 +1,116 @@
+#include "road_index.h"
+#include "map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Ограничение на размер сетки по каждой из осей
+const std::size_t MAX_CELLS_PER_AXIS = 1024;
+
+} // namespace
+
+void RoadIndex::Build(const std::vector<Road>& roads, double half_width) {
+    bounds_.clear();
+    cell_begin_.clear();
+    entries_.clear();
+    cols_ = rows_ = 0;
+
+    if (roads.empty()) {
+        return;
+    }
+
+    bounds_.reserve(roads.size());
+    RoadBounds extent{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                      std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for (const auto& road : roads) {
+        const Point start = road.GetStart();
+        const Point end = road.GetEnd();
+        RoadBounds b{std::min(start.x, end.x) - half_width, std::min(start.y, end.y) - half_width,
+                     std::max(start.x, end.x) + half_width, std::max(start.y, end.y) + half_width};
+        extent.min_x = std::min(extent.min_x, b.min_x);
+        extent.min_y = std::min(extent.min_y, b.min_y);
+        extent.max_x = std::max(extent.max_x, b.max_x);
+        extent.max_y = std::max(extent.max_y, b.max_y);
+        bounds_.push_back(b);
+    }
+
+    // Размер ячейки подбираем так, чтобы ячеек было порядка удвоенного числа дорог
+    const double width = extent.max_x - extent.min_x;
+    const double height = extent.max_y - extent.min_y;
+    const double target_cells = 2.0 * static_cast<double>(roads.size());
+    cell_size_ = std::max({1.0, std::sqrt(width * height / target_cells),
+                           width / MAX_CELLS_PER_AXIS, height / MAX_CELLS_PER_AXIS});
+    origin_x_ = extent.min_x;
+    origin_y_ = extent.min_y;
+    cols_ = static_cast<std::size_t>(width / cell_size_) + 1;
+    rows_ = static_cast<std::size_t>(height / cell_size_) + 1;
+
+    // Раскладываем дороги по ячейкам в два прохода: подсчёт и заполнение
+    std::vector<std::uint32_t> counts(cols_ * rows_ + 1, 0);
+    auto for_each_cell = [this](const RoadBounds& b, auto&& fn) {
+        const auto [first_col, last_col] = CellRange(b.min_x, b.max_x, origin_x_, cols_);
+        const auto [first_row, last_row] = CellRange(b.min_y, b.max_y, origin_y_, rows_);
+        for (std::size_t row = first_row; row <= last_row; ++row) {
+            for (std::size_t col = first_col; col <= last_col; ++col) {
+                fn(row * cols_ + col);
+            }
+        }
+    };
+    for (const auto& b : bounds_) {
+        for_each_cell(b, [&counts](std::size_t cell) {
+            ++counts[cell];
+        });
+    }
+
+    cell_begin_.assign(cols_ * rows_ + 1, 0);
+    for (std::size_t cell = 0; cell < cols_ * rows_; ++cell) {
+        cell_begin_[cell + 1] = cell_begin_[cell] + counts[cell];
+    }
+
+    entries_.resize(cell_begin_.back());
+    std::vector<std::uint32_t> fill(cell_begin_.begin(), cell_begin_.end() - 1);
+    for (std::size_t road_id = 0; road_id < bounds_.size(); ++road_id) {
+        for_each_cell(bounds_[road_id], [this, &fill, road_id](std::size_t cell) {
+            entries_[fill[cell]++] = Entry{bounds_[road_id], static_cast<std::uint32_t>(road_id)};
+        });
+    }
+}
+
+std::size_t RoadIndex::GetRoadsCount() const noexcept {
+    return bounds_.size();
+}
+
+const RoadBounds& RoadIndex::GetBounds(std::size_t road_id) const {
+    return bounds_.at(road_id);
+}
+
+std::size_t RoadIndex::FindRoadAt(double x, double y) const {
+    std::size_t found = NO_ROAD;
+    ForEachRoadAt(x, y, [&found](std::size_t road_id) {
+        found = std::min(found, road_id);
+    });
+    return found;
+}
+
+std::size_t RoadIndex::FindCell(double x, double y) const noexcept {
+    if (cols_ == 0 || x < origin_x_ || y < origin_y_) {
+        return NO_CELL;
+    }
+    const auto col = static_cast<std::size_t>((x - origin_x_) / cell_size_);
+    const auto row = static_cast<std::size_t>((y - origin_y_) / cell_size_);
+    if (col >= cols_ || row >= rows_) {
+        return NO_CELL;
+    }
+    return row * cols_ + col;
+}
+
+std::pair<std::size_t, std::size_t> RoadIndex::CellRange(double min, double max, double origin, std::size_t count) const noexcept {
+    auto to_cell = [this, origin, count](double v) {
+        const double cell = std::floor((v - origin) / cell_size_);
+        return static_cast<std::size_t>(std::clamp(cell, 0.0, static_cast<double>(count - 1)));
+    };
+    return {to_cell(min), to_cell(max)};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+class Road;
+
+// Прямоугольник дороги, расширенный на половину ширины дороги
+struct RoadBounds {
+    double min_x = 0.0;
+    double min_y = 0.0;
+    double max_x = 0.0;
+    double max_y = 0.0;
+
+    bool Contains(double x, double y) const noexcept {
+        return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+    }
+
+    bool Intersects(const RoadBounds& other) const noexcept {
+        return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+    }
+};
+
+/*
+ *  Пространственный индекс дорог карты: равномерная сетка, в каждой ячейке которой
+ *  хранятся расширенные границы всех дорог, пересекающих ячейку.
+ *  Строится один раз при загрузке карты, дальше используется только для чтения.
+ */
+class RoadIndex {
+public:
+    static constexpr std::size_t NO_ROAD = std::numeric_limits<std::size_t>::max();
+
+    void Build(const std::vector<Road>& roads, double half_width);
+
+    std::size_t GetRoadsCount() const noexcept;
+
+    const RoadBounds& GetBounds(std::size_t road_id) const;
+
+    // Первая дорога, на которой находится точка, или NO_ROAD
+    std::size_t FindRoadAt(double x, double y) const;
+
+    // Вызывает fn(road_id) для каждой дороги, на которой находится точка (x, y)
+    template <typename Fn>
+    void ForEachRoadAt(double x, double y, Fn&& fn) const {
+        const std::size_t cell = FindCell(x, y);
+        if (cell == NO_CELL) {
+            return;
+        }
+        for (std::uint32_t i = cell_begin_[cell]; i < cell_begin_[cell + 1]; ++i) {
+            const Entry& entry = entries_[i];
+            if (entry.bounds.Contains(x, y)) {
+                fn(static_cast<std::size_t>(entry.road_id));
+            }
+        }
+    }
+
+    // Вызывает fn(road_id) для каждой дороги, границы которой пересекают bounds.
+    // Дорога может встретиться несколько раз, если bounds покрывает несколько ячеек.
+    template <typename Fn>
+    void ForEachRoadInBox(const RoadBounds& bounds, Fn&& fn) const {
+        if (cols_ == 0) {
+            return;
+        }
+        const auto [first_col, last_col] = CellRange(bounds.min_x, bounds.max_x, origin_x_, cols_);
+        const auto [first_row, last_row] = CellRange(bounds.min_y, bounds.max_y, origin_y_, rows_);
+        for (std::size_t row = first_row; row <= last_row; ++row) {
+            for (std::size_t col = first_col; col <= last_col; ++col) {
+                const std::size_t cell = row * cols_ + col;
+                for (std::uint32_t i = cell_begin_[cell]; i < cell_begin_[cell + 1]; ++i) {
+                    if (entries_[i].bounds.Intersects(bounds)) {
+                        fn(static_cast<std::size_t>(entries_[i].road_id));
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t NO_CELL = std::numeric_limits<std::size_t>::max();
+
+    struct Entry {
+        RoadBounds bounds;
+        std::uint32_t road_id;
+    };
+
+    std::size_t FindCell(double x, double y) const noexcept;
+
+    std::pair<std::size_t, std::size_t> CellRange(double min, double max, double origin, std::size_t count) const noexcept;
+
+    std::vector<RoadBounds> bounds_;
+    double origin_x_ = 0.0;
+    double origin_y_ = 0.0;
+    double cell_size_ = 1.0;
+    std::size_t cols_ = 0;
+    std::size_t rows_ = 0;
+    // Ячейка i занимает отрезок [cell_begin_[i], cell_begin_[i + 1]) в entries_
+    std::vector<std::uint32_t> cell_begin_;
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+/*
+ *  Маршрутизация запросов без выделения памяти. Шаблоны маршрутов разбираются на сегменты
+ *  при компиляции (ошибка в шаблоне — ошибка компиляции), target запроса — на представления
+ *  std::string_view в массиве фиксированного размера. Сопоставление маршрута — сравнение
+ *  числа сегментов и нескольких коротких строк; параметры пути и строки запроса
+ *  возвращаются как представления в target запроса.
+ */
+namespace router {
+
+inline constexpr std::size_t MAX_SEGMENTS = 8;
+inline constexpr std::size_t MAX_PARAMS = 2;
+
+// Значения параметров пути в порядке их появления в шаблоне
+using Params = std::array<std::string_view, MAX_PARAMS>;
+
+// Методы, разрешённые маршруту
+struct Methods {
+    bool get_head = false;
+    bool post = false;
+
+    constexpr bool Allows(boost::beast::http::verb method) const noexcept {
+        using boost::beast::http::verb;
+        return (get_head && (method == verb::get || method == verb::head)) || (post && method == verb::post);
+    }
+
+    // Значение заголовка Allow для ответа 405
+    constexpr std::string_view GetAllow() const noexcept {
+        if (get_head && post) {
+            return "GET, HEAD, POST";
+        }
+        return post ? "POST" : "GET, HEAD";
+    }
+};
+
+inline constexpr Methods GET_HEAD{.get_head = true};
+inline constexpr Methods POST{.post = true};
+
+// Пустые сегменты и сегменты из пробелов пропускаются: "//api/ /v1" — то же, что "/api/v1"
+constexpr bool IsBlank(std::string_view segment) noexcept {
+    return segment.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+// Разобранный target запроса. Представления ссылаются на исходную строку.
+class Target {
+public:
+    constexpr explicit Target(std::string_view target) noexcept {
+        const std::size_t query_pos = target.find('?');
+        path_ = target.substr(0, query_pos);
+        if (query_pos != std::string_view::npos) {
+            query_ = target.substr(query_pos + 1);
+        }
+        std::size_t pos = 0;
+        while (pos < path_.size()) {
+            const std::size_t end = std::min(path_.find('/', pos), path_.size());
+            const std::string_view segment = path_.substr(pos, end - pos);
+            pos = end + 1;
+            if (IsBlank(segment)) {
+                continue;
+            }
+            if (size_ == MAX_SEGMENTS) {
+                // Такой путь не совпадёт ни с одним маршрутом
+                overflow_ = true;
+                break;
+            }
+            segments_[size_++] = segment;
+        }
+    }
+
+    constexpr std::string_view GetPath() const noexcept {
+        return path_;
+    }
+
+    constexpr std::string_view GetQuery() const noexcept {
+        return query_;
+    }
+
+    constexpr std::span<const std::string_view> GetSegments() const noexcept {
+        return {segments_.data(), size_};
+    }
+
+    // Сегментов больше MAX_SEGMENTS, сохранены только первые
+    constexpr bool IsOverflow() const noexcept {
+        return overflow_;
+    }
+
+private:
+    std::string_view path_;
+    std::string_view query_;
+    std::array<std::string_view, MAX_SEGMENTS> segments_{};
+    std::size_t size_ = 0;
+    bool overflow_ = false;
+};
+
+/*
+ *  Шаблон пути: "/api/v1/maps/:id". Сегмент, начинающийся с ':', — параметр,
+ *  совпадает с любым непустым сегментом.
+ */
+class Pattern {
+public:
+    consteval Pattern(std::string_view text)
+        : text_(text)
+    {
+        if (text.empty() || text.front() != '/') {
+            throw std::invalid_argument("Route pattern must start with '/'");
+        }
+        std::size_t pos = 1;
+        while (pos <= text.size()) {
+            const std::size_t end = std::min(text.find('/', pos), text.size());
+            const std::string_view segment = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (segment.empty() || IsBlank(segment) || size_ == MAX_SEGMENTS) {
+                throw std::invalid_argument("Route pattern has an empty segment or too many segments");
+            }
+            if (segment.front() == ':' && ++params_ > MAX_PARAMS) {
+                throw std::invalid_argument("Route pattern has too many parameters");
+            }
+            segments_[size_++] = segment;
+        }
+    }
+
+    // Таблица маршрутов записывается строковыми литералами
+    template <std::size_t N>
+    consteval Pattern(const char (&text)[N])
+        : Pattern(std::string_view{text, N - 1})
+    {
+    }
+
+    constexpr std::string_view GetText() const noexcept {
+        return text_;
+    }
+
+    // При совпадении заполняет params значениями параметров
+    constexpr bool Match(const Target& target, Params& params) const noexcept {
+        const auto segments = target.GetSegments();
+        if (target.IsOverflow() || segments.size() != size_) {
+            return false;
+        }
+        std::size_t param = 0;
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (IsParam(i)) {
+                params[param++] = segments[i];
+            } else if (segments_[i] != segments[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Есть путь, совпадающий с обоими шаблонами
+    constexpr bool Overlaps(const Pattern& other) const noexcept {
+        if (size_ != other.size_) {
+            return false;
+        }
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (!IsParam(i) && !other.IsParam(i) && segments_[i] != other.segments_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    constexpr bool IsParam(std::size_t i) const noexcept {
+        return segments_[i].front() == ':';
+    }
+
+    std::string_view text_;
+    std::array<std::string_view, MAX_SEGMENTS> segments_{};
+    std::size_t size_ = 0;
+    std::size_t params_ = 0;
+};
+
+template <typename Value>
+struct Route {
+    Pattern pattern;
+    Value value;
+};
+
+template <typename Value>
+struct Match {
+    // nullptr — ни один маршрут не подошёл
+    const Route<Value>* route = nullptr;
+    Params params{};
+};
+
+template <typename Value, std::size_t N>
+constexpr Match<Value> FindRoute(const Route<Value> (&routes)[N], const Target& target) noexcept {
+    Match<Value> match;
+    for (const auto& route : routes) {
+        if (route.pattern.Match(target, match.params)) {
+            match.route = &route;
+            return match;
+        }
+    }
+    return {};
+}
+
+// Каждый путь подходит не больше чем к одному маршруту таблицы
+template <typename Value, std::size_t N>
+constexpr bool IsUnambiguous(const Route<Value> (&routes)[N]) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = i + 1; j < N; ++j) {
+            if (routes[i].pattern.Overlaps(routes[j].pattern)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Значение параметра name из строки запроса "a=1&b=2" без декодирования; nullopt — параметра нет
+constexpr std::optional<std::string_view> GetQueryParam(std::string_view query, std::string_view name) noexcept {
+    while (!query.empty()) {
+        const std::size_t end = std::min(query.find('&'), query.size());
+        const std::string_view pair = query.substr(0, end);
+        query.remove_prefix(std::min(end + 1, query.size()));
+
+        const std::size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+        }
+    }
+    return std::nullopt;
+}
+
+// Число, занимающее всю строку, иначе nullopt
+template <typename T>
+std::optional<T> ParseNumber(std::string_view text) noexcept {
+    T value{};
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace router
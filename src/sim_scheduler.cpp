@@ -0,0 +1,165 @@
+#include "sim_scheduler.h"
+#include "async_log.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+using namespace std::literals;
+
+// Как часто поток, ждущий завершения шага, проверяет запрос остановки
+const std::chrono::milliseconds STOP_POLL_PERIOD{50};
+
+void ReportStepFailure(std::string_view what) {
+    static metrics::Counter& failures = metrics::GetRegistry().GetCounter("game_task_failures_total",
+        "Simulation steps and session tasks that ended with an exception", {"task"}, {"step"});
+    failures.Increment();
+    async_log::LogError(0, what, "simulation step"sv);
+}
+
+double ToMilliseconds(FixedStepTimeline::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+//! ------ FixedStepTimeline ------
+
+FixedStepTimeline::FixedStepTimeline(Clock::duration step, unsigned max_catch_up)
+    : step_(std::max(step, Clock::duration{1})),
+    max_catch_up_(std::max(1u, max_catch_up))
+{
+}
+
+void FixedStepTimeline::Start(Clock::time_point now) {
+    next_deadline_ = now + step_;
+}
+
+FixedStepTimeline::Clock::duration FixedStepTimeline::GetStep() const noexcept {
+    return step_;
+}
+
+FixedStepTimeline::Clock::time_point FixedStepTimeline::GetNextDeadline() const noexcept {
+    return next_deadline_;
+}
+
+unsigned FixedStepTimeline::TakeDueSteps(Clock::time_point now) {
+    if (now < next_deadline_) {
+        return 0;
+    }
+    const auto lag = now - next_deadline_;
+    const auto due = static_cast<std::uint64_t>(lag / step_) + 1;
+    next_deadline_ += step_ * static_cast<Clock::duration::rep>(due);
+
+    stats_.last_lag = ToMilliseconds(lag);
+    stats_.max_lag = std::max(stats_.max_lag, stats_.last_lag);
+    if (due > 1) {
+        ++stats_.catch_up_wakeups;
+    }
+    if (due > max_catch_up_) {
+        stats_.dropped_steps += due - max_catch_up_;
+        return max_catch_up_;
+    }
+    return static_cast<unsigned>(due);
+}
+
+void FixedStepTimeline::OnStepFinished(Clock::duration cost) {
+    ++stats_.steps;
+    stats_.last_step_cost = ToMilliseconds(cost);
+    stats_.max_step_cost = std::max(stats_.max_step_cost, stats_.last_step_cost);
+    stats_.total_step_cost += stats_.last_step_cost;
+    if (cost > step_) {
+        ++stats_.overrun_steps;
+    }
+}
+
+const TickStats& FixedStepTimeline::GetStats() const noexcept {
+    return stats_;
+}
+
+//! ------ SimScheduler ------
+
+SimScheduler::SimScheduler(std::chrono::milliseconds step, unsigned max_catch_up, StepFn step_fn)
+    : step_(step),
+    step_fn_(std::move(step_fn)),
+    timeline_(step, max_catch_up)
+{
+}
+
+SimScheduler::~SimScheduler() {
+    Stop();
+}
+
+void SimScheduler::Start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock{mutex_};
+        timeline_.Start(Clock::now());
+    }
+    thread_ = std::jthread([this](std::stop_token stop) {
+        Run(std::move(stop));
+    });
+}
+
+void SimScheduler::Stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        wake_.notify_all();
+        thread_.join();
+    }
+}
+
+TickStats SimScheduler::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return timeline_.GetStats();
+}
+
+void SimScheduler::Run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        unsigned due = 0;
+        {
+            std::unique_lock lock{mutex_};
+            // Ждём абсолютный срок шага: опоздание одного пробуждения не сдвигает следующие
+            wake_.wait_until(lock, stop, timeline_.GetNextDeadline(), [] {
+                return false;
+            });
+            if (stop.stop_requested()) {
+                return;
+            }
+            due = timeline_.TakeDueSteps(Clock::now());
+        }
+        for (unsigned i = 0; i < due; ++i) {
+            const auto start = Clock::now();
+            std::future<void> done = step_fn_(step_);
+            if (!WaitStep(done, stop)) {
+                return;
+            }
+            std::lock_guard lock{mutex_};
+            timeline_.OnStepFinished(Clock::now() - start);
+        }
+    }
+}
+
+bool SimScheduler::WaitStep(std::future<void>& done, const std::stop_token& stop) {
+    if (!done.valid()) {
+        return true;
+    }
+    while (done.wait_for(STOP_POLL_PERIOD) != std::future_status::ready) {
+        if (stop.stop_requested()) {
+            return false;
+        }
+    }
+    // Ошибка одного шага не останавливает игру, как и в таймерном тикере
+    try {
+        done.get();
+    } catch (const std::exception& e) {
+        ReportStepFailure(e.what());
+    } catch (...) {
+        ReportStepFailure("unknown exception"sv);
+    }
+    return true;
+}
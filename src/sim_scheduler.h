@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+// Счётчики планировщика тиков. Длительности в миллисекундах.
+struct TickStats {
+    // Выполнено шагов
+    std::uint64_t steps = 0;
+    // Шаги, пропущенные из-за ограничения догоняющих шагов
+    std::uint64_t dropped_steps = 0;
+    // Шаги, расчёт которых занял больше периода шага
+    std::uint64_t overrun_steps = 0;
+    // Пробуждения, на которых пришлось догонять больше одного шага
+    std::uint64_t catch_up_wakeups = 0;
+    // Опоздание пробуждения относительно срока первого из выполняемых шагов
+    double last_lag = 0.0;
+    double max_lag = 0.0;
+    double last_step_cost = 0.0;
+    double max_step_cost = 0.0;
+    double total_step_cost = 0.0;
+};
+
+/*
+ *  Временная шкала с фиксированным шагом. Сроки шагов отсчитываются от момента старта,
+ *  а не от фактического времени прошлого шага, поэтому задержки не накапливаются.
+ *  Если к пробуждению просрочено больше max_catch_up шагов, лишние пропускаются
+ *  и шкала сдвигается вперёд — после перегрузки игра замедляется, но не уходит в
+ *  бесконечное догоняние.
+ */
+class FixedStepTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FixedStepTimeline(Clock::duration step, unsigned max_catch_up);
+
+    void Start(Clock::time_point now);
+
+    Clock::duration GetStep() const noexcept;
+
+    Clock::time_point GetNextDeadline() const noexcept;
+
+    // Число шагов, которые нужно выполнить к моменту now. Сдвигает срок следующего шага.
+    unsigned TakeDueSteps(Clock::time_point now);
+
+    // Учитывает время расчёта одного выполненного шага
+    void OnStepFinished(Clock::duration cost);
+
+    const TickStats& GetStats() const noexcept;
+
+private:
+    Clock::duration step_;
+    unsigned max_catch_up_;
+    Clock::time_point next_deadline_;
+    TickStats stats_;
+};
+
+/*
+ *  Планировщик тиков в отдельном потоке. Поток спит до срока очередного шага по
+ *  FixedStepTimeline и вызывает step_fn с постоянной длиной шага. step_fn запускает
+ *  расчёт и возвращает future его завершения: следующий шаг начинается только после
+ *  окончания предыдущего, поэтому стоимость шага не зависит от нагрузки запросами.
+ */
+class SimScheduler {
+public:
+    using Clock = FixedStepTimeline::Clock;
+    using StepFn = std::function<std::future<void>(std::chrono::milliseconds step)>;
+
+    SimScheduler(std::chrono::milliseconds step, unsigned max_catch_up, StepFn step_fn);
+
+    SimScheduler(const SimScheduler&) = delete;
+    SimScheduler& operator=(const SimScheduler&) = delete;
+
+    ~SimScheduler();
+
+    void Start();
+
+    // Останавливает поток. Шаг, который ещё выполняется, дожидаться не обязательно.
+    void Stop();
+
+    TickStats GetStats() const;
+
+private:
+    void Run(std::stop_token stop);
+
+    // Ждёт завершения шага; false, если планировщик остановлен раньше
+    bool WaitStep(std::future<void>& done, const std::stop_token& stop);
+
+    std::chrono::milliseconds step_;
+    StepFn step_fn_;
+    mutable std::mutex mutex_;
+    std::condition_variable_any wake_;
+    FixedStepTimeline timeline_;
+    std::jthread thread_;
+};
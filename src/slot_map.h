@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+ *  Хранилище со стабильными id и переиспользованием освободившихся мест.
+ *  Значения лежат в плотном массиве без дыр, поэтому обход идёт по непрерывной памяти,
+ *  а объём хранилища определяется числом живых объектов, а не числом когда-либо созданных.
+ *
+ *  id = (поколение << INDEX_BITS) | номер слота. При удалении поколение слота растёт,
+ *  поэтому старый id не находит объект, позже занявший тот же слот.
+ */
+template <typename T>
+class SlotMap {
+public:
+    using Id = int;
+
+    static constexpr unsigned INDEX_BITS = 20;
+    static constexpr std::uint32_t MAX_SLOTS = 1u << INDEX_BITS;
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<Id, const T&>;
+        using difference_type = std::ptrdiff_t;
+
+        ConstIterator(const SlotMap* map, std::size_t pos)
+            : map_(map), pos_(pos) {
+        }
+
+        value_type operator*() const {
+            return {map_->ids_[pos_], map_->values_[pos_]};
+        }
+
+        ConstIterator& operator++() {
+            ++pos_;
+            return *this;
+        }
+
+        bool operator==(const ConstIterator& other) const = default;
+
+    private:
+        const SlotMap* map_;
+        std::size_t pos_;
+    };
+
+    Id Insert(T value) {
+        std::uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            if (slots_.size() >= MAX_SLOTS) {
+                throw std::length_error("SlotMap is full");
+            }
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back(Slot{});
+        }
+        return Place(index, std::move(value));
+    }
+
+    // Кладёт значение под заданным id (восстановление сохранённого состояния).
+    // Объект с тем же id заменяется. Возвращает false, если слот id занят другим объектом.
+    bool InsertWithId(Id id, T value) {
+        if (id < 0) {
+            return false;
+        }
+        const std::uint32_t index = IndexOf(id);
+        if (index < slots_.size() && slots_[index].dense != NONE) {
+            if (slots_[index].generation != GenerationOf(id)) {
+                return false;
+            }
+            values_[slots_[index].dense] = std::move(value);
+            return true;
+        }
+        while (slots_.size() <= index) {
+            free_.push_back(static_cast<std::uint32_t>(slots_.size()));
+            slots_.push_back(Slot{});
+        }
+        // Восстановление редкое, поэтому линейный поиск в списке свободных слотов допустим
+        std::erase(free_, index);
+        slots_[index].generation = GenerationOf(id);
+        Place(index, std::move(value));
+        return true;
+    }
+
+    bool Erase(Id id) {
+        const std::uint32_t index = IndexOf(id);
+        if (!Contains(id)) {
+            return false;
+        }
+        // Последний элемент плотного массива переезжает на место удалённого
+        const std::uint32_t dense = slots_[index].dense;
+        const std::uint32_t last = static_cast<std::uint32_t>(values_.size() - 1);
+        if (dense != last) {
+            values_[dense] = std::move(values_[last]);
+            ids_[dense] = ids_[last];
+            slots_[IndexOf(ids_[dense])].dense = dense;
+        }
+        values_.pop_back();
+        ids_.pop_back();
+
+        slots_[index].dense = NONE;
+        slots_[index].generation = (slots_[index].generation + 1) & GENERATION_MASK;
+        free_.push_back(index);
+        return true;
+    }
+
+    bool Contains(Id id) const noexcept {
+        if (id < 0) {
+            return false;
+        }
+        const std::uint32_t index = IndexOf(id);
+        return index < slots_.size() && slots_[index].dense != NONE
+            && slots_[index].generation == GenerationOf(id);
+    }
+
+    T* Find(Id id) noexcept {
+        return Contains(id) ? &values_[slots_[IndexOf(id)].dense] : nullptr;
+    }
+
+    const T* Find(Id id) const noexcept {
+        return Contains(id) ? &values_[slots_[IndexOf(id)].dense] : nullptr;
+    }
+
+    std::size_t Size() const noexcept {
+        return values_.size();
+    }
+
+    bool Empty() const noexcept {
+        return values_.empty();
+    }
+
+    // Число слотов, созданных за всё время: наибольший номер слота + 1. Освободившиеся слоты
+    // занимаются повторно, поэтому оно ограничено наибольшим числом одновременно живых значений.
+    std::size_t SlotCount() const noexcept {
+        return slots_.size();
+    }
+
+    // Номер слота id: меньше SlotCount(), годится как индекс во внешних массивах по слотам
+    static std::uint32_t IndexOf(Id id) noexcept {
+        return static_cast<std::uint32_t>(id) & (MAX_SLOTS - 1);
+    }
+
+    // Плотные массивы: Ids()[i] — id значения Values()[i]. Порядок меняется при удалении.
+    std::span<const Id> Ids() const noexcept {
+        return ids_;
+    }
+
+    std::span<const T> Values() const noexcept {
+        return values_;
+    }
+
+    // Обход пар (id, значение) без копирования
+    ConstIterator begin() const noexcept {
+        return ConstIterator{this, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator{this, values_.size()};
+    }
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+    // id остаётся неотрицательным int
+    static constexpr std::uint32_t GENERATION_MASK = (1u << (31 - INDEX_BITS)) - 1;
+
+    struct Slot {
+        std::uint32_t generation = 0;
+        // Позиция значения в плотном массиве или NONE для свободного слота
+        std::uint32_t dense = NONE;
+    };
+
+    static std::uint32_t GenerationOf(Id id) noexcept {
+        return (static_cast<std::uint32_t>(id) >> INDEX_BITS) & GENERATION_MASK;
+    }
+
+    static Id MakeId(std::uint32_t index, std::uint32_t generation) noexcept {
+        return static_cast<Id>((generation << INDEX_BITS) | index);
+    }
+
+    Id Place(std::uint32_t index, T value) {
+        const Id id = MakeId(index, slots_[index].generation);
+        slots_[index].dense = static_cast<std::uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        ids_.push_back(id);
+        return id;
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_;
+    std::vector<T> values_;
+    std::vector<Id> ids_;
+};
@@ -0,0 +1,35 @@
+#include "spatial_grid.h"
+
+void SpatialGrid::Insert(int id, double x, double y) {
+    cells_[MakeKey(ToCell(x), ToCell(y))].push_back(Item{id, x, y});
+    ++size_;
+}
+
+bool SpatialGrid::Remove(int id, double x, double y) {
+    auto it = cells_.find(MakeKey(ToCell(x), ToCell(y)));
+    if (it == cells_.end()) {
+        return false;
+    }
+    auto& items = it->second;
+    auto item = std::find_if(items.begin(), items.end(), [id](const Item& i) {
+        return i.id == id;
+    });
+    if (item == items.end()) {
+        return false;
+    }
+    // Порядок внутри ячейки не важен, поэтому удаляем обменом с последним
+    // Пустые ячейки не удаляем: предметы снова появятся на тех же дорогах
+    *item = items.back();
+    items.pop_back();
+    --size_;
+    return true;
+}
+
+void SpatialGrid::Clear() {
+    cells_.clear();
+    size_ = 0;
+}
+
+std::size_t SpatialGrid::Size() const noexcept {
+    return size_;
+}
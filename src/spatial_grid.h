@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+ *  Разреженная равномерная сетка точечных объектов с целочисленными id.
+ *  Используется как широкая фаза при сборе предметов: для отрезка перемещения
+ *  собаки перебираются только объекты из ячеек, которые этот отрезок задевает.
+ *  Объекты добавляются и удаляются по одному, без перестроения сетки.
+ */
+class SpatialGrid {
+public:
+    struct Item {
+        int id;
+        double x;
+        double y;
+    };
+
+    explicit SpatialGrid(double cell_size)
+        : cell_size_(cell_size) {
+    }
+
+    void Insert(int id, double x, double y);
+
+    // Удаляет объект id, лежащий в точке (x, y). Возвращает false, если его там нет.
+    bool Remove(int id, double x, double y);
+
+    void Clear();
+
+    std::size_t Size() const noexcept;
+
+    // Вызывает fn(const Item&) для объектов из всех ячеек, которые задевает
+    // прямоугольник отрезка (x0, y0) - (x1, y1), расширенный на radius
+    template <typename Fn>
+    void ForEachNearSegment(double x0, double y0, double x1, double y1, double radius, Fn&& fn) const {
+        if (size_ == 0) {
+            return;
+        }
+        const std::int64_t first_col = ToCell(std::min(x0, x1) - radius);
+        const std::int64_t last_col = ToCell(std::max(x0, x1) + radius);
+        const std::int64_t first_row = ToCell(std::min(y0, y1) - radius);
+        const std::int64_t last_row = ToCell(std::max(y0, y1) + radius);
+        for (std::int64_t row = first_row; row <= last_row; ++row) {
+            for (std::int64_t col = first_col; col <= last_col; ++col) {
+                auto it = cells_.find(MakeKey(col, row));
+                if (it == cells_.end()) {
+                    continue;
+                }
+                for (const Item& item : it->second) {
+                    fn(item);
+                }
+            }
+        }
+    }
+
+private:
+    std::int64_t ToCell(double coord) const noexcept {
+        return static_cast<std::int64_t>(std::floor(coord / cell_size_));
+    }
+
+    static std::uint64_t MakeKey(std::int64_t col, std::int64_t row) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(col)) << 32) | static_cast<std::uint32_t>(row);
+    }
+
+    double cell_size_;
+    std::unordered_map<std::uint64_t, std::vector<Item>> cells_;
+    std::size_t size_ = 0;
+};
@@ -0,0 +1,178 @@
+#include "static_bundle.h"
+#include "static_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace static_bundle {
+
+using namespace std::literals;
+
+// Индекс читается из отображённой памяти как есть
+static_assert(std::endian::native == std::endian::little, "Static bundle format is little-endian");
+static_assert(std::is_trivially_copyable_v<Bundle::Header> && std::is_trivially_copyable_v<Bundle::IndexEntry>);
+static_assert(sizeof(Bundle::Header) == 32 && sizeof(Bundle::IndexEntry) == 96);
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path& file) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Failed to open "s + file.string());
+    }
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+// Дописывает данные в конец пакета и запоминает их положение
+class DataWriter {
+public:
+    explicit DataWriter(std::uint64_t offset)
+        : offset_(offset)
+    {
+    }
+
+    Bundle::Slice Append(std::string_view data) {
+        const Bundle::Slice slice{offset_ + data_.size(), data.size()};
+        data_.append(data);
+        return slice;
+    }
+
+    const std::string& GetData() const noexcept {
+        return data_;
+    }
+
+private:
+    std::uint64_t offset_;
+    std::string data_;
+};
+
+} // namespace
+
+//! ------ Bundle ------
+
+std::shared_ptr<const Bundle> Bundle::Open(const std::filesystem::path& path) {
+    return std::shared_ptr<const Bundle>(new Bundle(path));
+}
+
+Bundle::Bundle(const std::filesystem::path& path) {
+    const auto fail = [&path](std::string_view reason) {
+        return std::runtime_error("Invalid static bundle "s + path.string() + ": "s + std::string(reason));
+    };
+
+    try {
+        file_.open(path.string());
+    } catch (const std::exception& e) {
+        throw fail(e.what());
+    }
+    data_ = file_.data();
+    const std::uint64_t size = file_.size();
+
+    Header header;
+    if (size < sizeof(header)) {
+        throw fail("file is too small"sv);
+    }
+    std::copy_n(data_, sizeof(header), reinterpret_cast<char*>(&header));
+    if (!std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic) || header.version != VERSION) {
+        throw fail("unknown format"sv);
+    }
+    if (header.file_size != size || header.index_offset % alignof(IndexEntry) != 0 ||
+        header.index_offset > size || (size - header.index_offset) / sizeof(IndexEntry) < header.count) {
+        throw fail("file is truncated"sv);
+    }
+    index_ = {reinterpret_cast<const IndexEntry*>(data_ + header.index_offset), header.count};
+
+    // Проверяем всё один раз при открытии, чтобы Find доверял индексу
+    const auto in_file = [size](const Slice& slice) {
+        return slice.offset <= size && slice.size <= size - slice.offset;
+    };
+    for (std::size_t i = 0; i < index_.size(); ++i) {
+        const IndexEntry& entry = index_[i];
+        if (!in_file(entry.key) || !in_file(entry.content_type) || !in_file(entry.content) ||
+            !in_file(entry.etag) || !in_file(entry.gzip) || !in_file(entry.gzip_etag)) {
+            throw fail("entry is out of file"sv);
+        }
+        if (i > 0 && GetView(index_[i - 1].key) >= GetView(entry.key)) {
+            throw fail("index is not sorted"sv);
+        }
+    }
+}
+
+std::optional<File> Bundle::Find(std::string_view key) const {
+    const auto it = std::lower_bound(index_.begin(), index_.end(), key, [this](const IndexEntry& entry, std::string_view key) {
+        return GetView(entry.key) < key;
+    });
+    if (it == index_.end() || GetView(it->key) != key) {
+        return std::nullopt;
+    }
+    return File{
+        .content_type = GetView(it->content_type),
+        .content = GetView(it->content),
+        .etag = GetView(it->etag),
+        .gzip = GetView(it->gzip),
+        .gzip_etag = GetView(it->gzip_etag)
+    };
+}
+
+//! ------ Pack ------
+
+void Pack(const std::filesystem::path& root, const std::filesystem::path& output) {
+    using Header = Bundle::Header;
+    using IndexEntry = Bundle::IndexEntry;
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root)) {
+        if (item.is_regular_file()) {
+            files.push_back(item.path());
+        }
+    }
+
+    std::vector<std::pair<std::string, std::filesystem::path>> keys;
+    keys.reserve(files.size());
+    for (const auto& file : files) {
+        keys.emplace_back(file.lexically_relative(root).generic_string(), file);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    const std::uint64_t index_offset = sizeof(Header);
+    std::vector<IndexEntry> index;
+    index.reserve(keys.size());
+    DataWriter data(index_offset + keys.size() * sizeof(IndexEntry));
+    for (const auto& [key, file] : keys) {
+        const auto entry = static_cache::MakeEntry(ReadFile(file), std::string(static_cache::GetContentType(file)));
+        IndexEntry& item = index.emplace_back();
+        item.key = data.Append(key);
+        item.content_type = data.Append(entry->content_type);
+        item.content = data.Append(*entry->content);
+        item.etag = data.Append(entry->etag);
+        item.gzip = entry->gzip ? data.Append(*entry->gzip) : Bundle::Slice{};
+        item.gzip_etag = data.Append(entry->gzip_etag);
+    }
+
+    Header header{};
+    std::copy(std::begin(Bundle::MAGIC), std::end(Bundle::MAGIC), header.magic);
+    header.version = Bundle::VERSION;
+    header.count = static_cast<std::uint32_t>(index.size());
+    header.index_offset = index_offset;
+    header.file_size = index_offset + index.size() * sizeof(IndexEntry) + data.GetData().size();
+
+    std::filesystem::path temp = output;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+        out.write(data.GetData().data(), static_cast<std::streamsize>(data.GetData().size()));
+        if (!out.flush()) {
+            throw std::runtime_error("Failed to write "s + temp.string());
+        }
+    }
+    std::filesystem::rename(temp, output);
+}
+
+} // namespace static_bundle
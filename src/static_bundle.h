@@ -0,0 +1,136 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+/*
+ *  Пакет статических файлов: один неизменяемый файл, собранный при сборке (цель static_bundle).
+ *  В нём для каждого файла лежат тип содержимого, строгий ETag, само содержимое и заранее
+ *  сжатый gzip-вариант, а индекс отсортирован по ключу для двоичного поиска.
+ *  Сервер отображает пакет в память (--www-bundle) и отдаёт тела ответов прямо из отображённых
+ *  страниц: при запуске ничего не читается и не сжимается, на запрос — ни одного обращения к диску.
+ *
+ *  Формат (little-endian, все смещения — от начала файла):
+ *      Header
+ *      IndexEntry[count], по возрастанию ключа
+ *      ключи, строки заголовков и тела файлов
+ */
+namespace static_bundle {
+
+// Файл пакета: представления указывают в отображённую память
+struct File {
+    std::string_view content_type;
+    std::string_view content;
+    std::string_view etag;
+    // Пустое — сжатие не даёт выигрыша
+    std::string_view gzip;
+    std::string_view gzip_etag;
+};
+
+class Bundle {
+public:
+    // Отображает пакет в память и проверяет его; при повреждённом файле бросает std::runtime_error
+    static std::shared_ptr<const Bundle> Open(const std::filesystem::path& path);
+
+    Bundle(const Bundle&) = delete;
+    Bundle& operator=(const Bundle&) = delete;
+
+    // key — нормализованный путь относительно корня: "index.html", "assets/model.fbx"
+    std::optional<File> Find(std::string_view key) const;
+
+    std::size_t GetCount() const noexcept {
+        return index_.size();
+    }
+
+    //! ------ Формат файла ------
+
+    static constexpr char MAGIC[8] = {'G', 'S', 'B', 'U', 'N', 'D', 'L', 'E'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    struct Slice {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint64_t index_offset;
+        std::uint64_t file_size;
+    };
+
+    struct IndexEntry {
+        Slice key;
+        Slice content_type;
+        Slice content;
+        Slice etag;
+        // size == 0 — без сжатого варианта
+        Slice gzip;
+        Slice gzip_etag;
+    };
+
+private:
+    explicit Bundle(const std::filesystem::path& path);
+
+    std::string_view GetView(const Slice& slice) const noexcept {
+        return {data_ + slice.offset, static_cast<std::size_t>(slice.size)};
+    }
+
+    boost::iostreams::mapped_file_source file_;
+    const char* data_ = nullptr;
+    std::span<const IndexEntry> index_;
+};
+
+// Собирает пакет из всех файлов под root. Файл записывается целиком под временным именем и затем переименовывается.
+void Pack(const std::filesystem::path& root, const std::filesystem::path& output);
+
+// Тело ответа — участок отображённого пакета. Ответ держит пакет, пока не отправлен.
+struct MappedBody {
+    struct value_type {
+        std::shared_ptr<const Bundle> bundle;
+        std::string_view data;
+    };
+
+    static std::uint64_t size(const value_type& body) noexcept {
+        return body.data.size();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body)
+        {
+        }
+
+        void init(boost::beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec) {
+            ec = {};
+            if (body_.data.empty()) {
+                return boost::none;
+            }
+            return std::make_pair(const_buffers_type(body_.data.data(), body_.data.size()), false);
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+} // namespace static_bundle
@@ -0,0 +1,371 @@
+#include "static_cache.h"
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace static_cache {
+
+namespace {
+
+// Сжатый вариант хранится, только если он меньше оригинала хотя бы на десятую часть
+const double MIN_GZIP_RATIO = 0.9;
+
+#ifdef __linux__
+const std::uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+std::string_view TrimSpaces(std::string_view value) noexcept {
+    const auto begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const auto end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+// Вызывает fn для каждого элемента списка через запятую без пробелов по краям
+template <typename Fn>
+bool AnyListItem(std::string_view list, Fn&& fn) {
+    while (!list.empty()) {
+        const std::size_t end = std::min(list.find(','), list.size());
+        if (fn(TrimSpaces(list.substr(0, end)))) {
+            return true;
+        }
+        list.remove_prefix(std::min(end + 1, list.size()));
+    }
+    return false;
+}
+
+const std::unordered_map<std::string_view, std::string_view> CONTENT_TYPES = {
+    {".htm", "text/html"},
+    {".html", "text/html"},
+    {".css", "text/css"},
+    {".txt", "text/plain"},
+    {".js", "text/javascript"},
+    {".json", "application/json"},
+    {".xml", "application/xml"},
+    {".png", "image/png"},
+    {".jpg", "image/jpeg"},
+    {".jpe", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".gif", "image/gif"},
+    {".bmp", "image/bmp"},
+    {".ico", "image/vnd.microsoft.icon"},
+    {".tiff", "image/tiff"},
+    {".tif", "image/tiff"},
+    {".svg", "image/svg+xml"},
+    {".svgz", "image/svg+xml"},
+    {".mp3", "audio/mpeg"}
+};
+
+const std::string_view UNKNOWN_CONTENT_TYPE = "application/octet-stream";
+
+// Уже сжатые форматы не пытаемся сжимать
+bool IsCompressible(std::string_view content_type) noexcept {
+    return !content_type.starts_with("image/") || content_type == "image/svg+xml";
+}
+
+std::string ReadFile(const std::filesystem::path& file, std::uintmax_t size) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Failed to open " + file.string());
+    }
+    std::string content(size, '\0');
+    input.read(content.data(), static_cast<std::streamsize>(size));
+    // Файл мог укоротиться между file_size и чтением
+    content.resize(static_cast<std::size_t>(input.gcount()));
+    return content;
+}
+
+std::uintmax_t GetEntrySize(const Entry& entry) noexcept {
+    return entry.content->size() + (entry.gzip ? entry.gzip->size() : 0);
+}
+
+} // namespace
+
+std::string MakeEtag(std::string_view data) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    static constexpr char HEX[] = "0123456789abcdef";
+    std::string etag = "\"";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        etag += HEX[(hash >> shift) & 0xF];
+    }
+    etag += '"';
+    return etag;
+}
+
+bool MatchesEtag(std::string_view if_none_match, std::string_view etag) noexcept {
+    if (TrimSpaces(if_none_match) == "*") {
+        return true;
+    }
+    return AnyListItem(if_none_match, [etag](std::string_view item) {
+        if (item.starts_with("W/")) {
+            item.remove_prefix(2);
+        }
+        return item == etag;
+    });
+}
+
+bool AcceptsGzip(std::string_view accept_encoding) noexcept {
+    return AnyListItem(accept_encoding, [](std::string_view item) {
+        const std::size_t params = item.find(';');
+        if (TrimSpaces(item.substr(0, params)) != "gzip") {
+            return false;
+        }
+        // gzip;q=0 — клиент явно отказывается
+        const std::string_view q = params == std::string_view::npos ? std::string_view{} : TrimSpaces(item.substr(params + 1));
+        return !(q == "q=0" || q == "q=0.0" || q == "q=0.00" || q == "q=0.000");
+    });
+}
+
+std::string Gzip(std::string_view data) {
+    namespace io = boost::iostreams;
+    std::string result;
+    {
+        io::filtering_ostream output;
+        output.push(io::gzip_compressor(io::gzip_params(io::gzip::best_compression)));
+        output.push(io::back_inserter(result));
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+        // Закрытие цепочки дописывает конец потока gzip
+        output.reset();
+    }
+    return result;
+}
+
+std::string_view GetContentType(const std::filesystem::path& file) {
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    const auto it = CONTENT_TYPES.find(extension);
+    return it == CONTENT_TYPES.end() ? UNKNOWN_CONTENT_TYPE : it->second;
+}
+
+std::shared_ptr<Entry> MakeEntry(std::string content, std::string content_type) {
+    auto entry = std::make_shared<Entry>();
+    entry->content = std::make_shared<const std::string>(std::move(content));
+    entry->etag = MakeEtag(*entry->content);
+    if (IsCompressible(content_type) && !entry->content->empty()) {
+        auto gzip = Gzip(*entry->content);
+        if (static_cast<double>(gzip.size()) < static_cast<double>(entry->content->size()) * MIN_GZIP_RATIO) {
+            entry->gzip_etag = entry->etag;
+            entry->gzip_etag.insert(entry->gzip_etag.size() - 1, "-gz");
+            entry->gzip = std::make_shared<const std::string>(std::move(gzip));
+        }
+    }
+    entry->content_type = std::move(content_type);
+    return entry;
+}
+
+//! ------ StaticCache ------
+
+StaticCache::StaticCache(std::filesystem::path root, Options options)
+    : root_(std::filesystem::weakly_canonical(root)),
+    options_(options)
+{
+}
+
+StaticCache::~StaticCache() {
+    if (watcher_.joinable()) {
+        watcher_.request_stop();
+        watcher_.join();
+    }
+#ifdef __linux__
+    if (inotify_fd_ >= 0) {
+        ::close(inotify_fd_);
+    }
+#endif
+}
+
+std::shared_ptr<const Entry> StaticCache::Find(std::string_view key) const {
+    std::shared_lock lock{mutex_};
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const Entry> StaticCache::Load(std::string_view key, const std::filesystem::path& file, std::string content_type) {
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(file, ec);
+    if (ec || size > options_.max_file_size || size > options_.max_size) {
+        return nullptr;
+    }
+    const std::uint64_t generation = generation_.load(std::memory_order_acquire);
+
+    std::shared_ptr<Entry> entry;
+    try {
+        entry = MakeEntry(ReadFile(file, size), std::move(content_type));
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+    Insert(key, entry, generation);
+    return entry;
+}
+
+void StaticCache::Insert(std::string_view key, std::shared_ptr<const Entry> entry, std::uint64_t generation) {
+    const std::uintmax_t entry_size = GetEntrySize(*entry);
+    std::unique_lock lock{mutex_};
+    // Файл менялся, пока его читали: прочитанное отдаём, но не кэшируем
+    if (generation != generation_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto [it, inserted] = entries_.try_emplace(std::string(key));
+    if (!inserted) {
+        size_ -= GetEntrySize(*it->second);
+    }
+    if (size_ + entry_size > options_.max_size) {
+        entries_.erase(it);
+        return;
+    }
+    it->second = std::move(entry);
+    size_ += entry_size;
+}
+
+void StaticCache::Invalidate(std::string_view key) {
+    std::unique_lock lock{mutex_};
+    generation_.fetch_add(1, std::memory_order_release);
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        size_ -= GetEntrySize(*it->second);
+        entries_.erase(it);
+    }
+}
+
+void StaticCache::InvalidateDirectory(std::string_view prefix) {
+    std::string dir(prefix);
+    if (!dir.empty() && dir.back() != '/') {
+        dir += '/';
+    }
+    std::unique_lock lock{mutex_};
+    generation_.fetch_add(1, std::memory_order_release);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (dir.empty() || it->first.starts_with(dir)) {
+            size_ -= GetEntrySize(*it->second);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void StaticCache::Clear() {
+    InvalidateDirectory({});
+}
+
+std::uintmax_t StaticCache::GetSize() const noexcept {
+    std::shared_lock lock{mutex_};
+    return size_;
+}
+
+#ifdef __linux__
+
+void StaticCache::StartWatching() {
+    if (watcher_.joinable()) {
+        return;
+    }
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "inotify_init1");
+    }
+    AddWatches(root_);
+    watcher_ = std::jthread([this](std::stop_token stop) {
+        WatchLoop(stop);
+    });
+}
+
+void StaticCache::AddWatches(const std::filesystem::path& dir) {
+    std::error_code ec;
+    auto add = [this](const std::filesystem::path& path) {
+        const int wd = ::inotify_add_watch(inotify_fd_, path.c_str(), WATCH_MASK);
+        if (wd >= 0) {
+            const auto relative = path.lexically_relative(root_).generic_string();
+            watches_[wd] = relative == "." ? std::string{} : relative;
+        }
+    };
+    add(dir);
+    for (std::filesystem::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            add(it->path());
+        }
+    }
+}
+
+void StaticCache::WatchLoop(std::stop_token stop) {
+    alignas(inotify_event) std::array<char, 16 * 1024> buffer;
+    while (!stop.stop_requested()) {
+        pollfd fd{inotify_fd_, POLLIN, 0};
+        // Короткий таймаут, чтобы заметить остановку
+        if (::poll(&fd, 1, 200) <= 0) {
+            continue;
+        }
+        const ssize_t length = ::read(inotify_fd_, buffer.data(), buffer.size());
+        for (ssize_t pos = 0; pos < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + pos);
+            pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // События потеряны — неизвестно, что поменялось
+                Clear();
+                continue;
+            }
+            const auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(watch);
+                continue;
+            }
+            if (event->len == 0) {
+                // Событие самого каталога: удалён или перемещён
+                InvalidateDirectory(watch->second);
+                continue;
+            }
+            std::string key = watch->second.empty() ? std::string{} : watch->second + '/';
+            key += event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    AddWatches(root_ / key);
+                }
+                InvalidateDirectory(key);
+            } else {
+                Invalidate(key);
+            }
+        }
+    }
+}
+
+#else
+
+void StaticCache::StartWatching() {
+}
+
+void StaticCache::AddWatches(const std::filesystem::path&) {
+}
+
+void StaticCache::WatchLoop(std::stop_token) {
+}
+
+#endif
+
+} // namespace static_cache
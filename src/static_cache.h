@@ -0,0 +1,157 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+/*
+ *  Кэш статических файлов в памяти. Ключ — нормализованный путь относительно корня
+ *  (без syscalls на каждый запрос), значение — байты файла, тип содержимого, строгий ETag
+ *  и заранее сжатый gzip-вариант. Файлы под корнем отслеживаются через inotify:
+ *  изменённый или удалённый файл выбрасывается из кэша и при следующем запросе читается заново.
+ */
+namespace static_cache {
+
+// Тело ответа — общий неизменяемый буфер кэша: файл не копируется в каждый ответ
+struct SharedBufferBody {
+    using value_type = std::shared_ptr<const std::string>;
+
+    static std::uint64_t size(const value_type& body) noexcept {
+        return body ? body->size() : 0;
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body)
+        {
+        }
+
+        void init(boost::beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec) {
+            ec = {};
+            if (!body_ || body_->empty()) {
+                return boost::none;
+            }
+            return std::make_pair(const_buffers_type(body_->data(), body_->size()), false);
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+struct Entry {
+    std::string content_type;
+    std::shared_ptr<const std::string> content;
+    // nullptr — сжатие не даёт выигрыша
+    std::shared_ptr<const std::string> gzip;
+    // У сжатого варианта свой строгий ETag: байты ответа другие
+    std::string etag;
+    std::string gzip_etag;
+};
+
+// Строгий ETag по содержимому: "<FNV-1a 64 в hex>"
+std::string MakeEtag(std::string_view data);
+
+// Совпадает ли etag с одним из значений If-None-Match (слабое сравнение, как требует RFC 9110)
+bool MatchesEtag(std::string_view if_none_match, std::string_view etag) noexcept;
+
+// Принимает ли клиент gzip по заголовку Accept-Encoding
+bool AcceptsGzip(std::string_view accept_encoding) noexcept;
+
+std::string Gzip(std::string_view data);
+
+// Тип содержимого по расширению файла, без учёта регистра
+std::string_view GetContentType(const std::filesystem::path& file);
+
+// Запись для содержимого файла: ETag и gzip-вариант, если сжатие даёт выигрыш
+std::shared_ptr<Entry> MakeEntry(std::string content, std::string content_type);
+
+class StaticCache {
+public:
+    struct Options {
+        // Суммарный размер содержимого в кэше; файлы сверх него отдаются с диска
+        std::uintmax_t max_size = 256 * 1024 * 1024;
+        std::uintmax_t max_file_size = 16 * 1024 * 1024;
+    };
+
+    StaticCache(std::filesystem::path root, Options options);
+
+    StaticCache(const StaticCache&) = delete;
+    StaticCache& operator=(const StaticCache&) = delete;
+
+    ~StaticCache();
+
+    const std::filesystem::path& GetRoot() const noexcept {
+        return root_;
+    }
+
+    // key — нормализованный путь относительно корня: "index.html", "assets/model.fbx"
+    std::shared_ptr<const Entry> Find(std::string_view key) const;
+
+    // Читает файл и кладёт его в кэш. nullptr — файл не помещается или не читается, его нужно отдать с диска.
+    std::shared_ptr<const Entry> Load(std::string_view key, const std::filesystem::path& file, std::string content_type);
+
+    void Invalidate(std::string_view key);
+
+    // Выбрасывает все файлы каталога prefix
+    void InvalidateDirectory(std::string_view prefix);
+
+    void Clear();
+
+    std::uintmax_t GetSize() const noexcept;
+
+    // Следит за изменениями под корнем в отдельном потоке. Без inotify (не Linux) ничего не делает.
+    void StartWatching();
+
+private:
+    void Insert(std::string_view key, std::shared_ptr<const Entry> entry, std::uint64_t generation);
+
+    void WatchLoop(std::stop_token stop);
+
+    // Поиск по string_view без временной строки
+    struct KeyHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view key) const noexcept {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    void AddWatches(const std::filesystem::path& dir);
+
+    const std::filesystem::path root_;
+    const Options options_;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const Entry>, KeyHash, std::equal_to<>> entries_;
+    std::uintmax_t size_ = 0;
+    // Растёт при каждой инвалидации: файл, прочитанный до неё, в кэш не попадает
+    std::atomic<std::uint64_t> generation_{0};
+
+    // Состояние наблюдателя, с ним работает только его поток (и StartWatching до запуска потока)
+    int inotify_fd_ = -1;
+    std::unordered_map<int, std::string> watches_;
+    std::jthread watcher_;
+};
+
+} // namespace static_cache
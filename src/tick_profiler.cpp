@@ -0,0 +1,212 @@
+#include "tick_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+
+// Записей файла состояния на слот окна: сохранения редкие
+const std::uint64_t SAVES_PER_SLOT = 16;
+
+} // namespace
+
+std::string_view GetTickPhaseName(TickPhase phase) noexcept {
+    switch (phase) {
+    case TickPhase::SPAWN:
+        return "spawn";
+    case TickPhase::MOVE:
+        return "move";
+    case TickPhase::COLLECT:
+        return "collect";
+    case TickPhase::RETIRE:
+        return "retire";
+    case TickPhase::DB_WRITE:
+        return "dbWrite";
+    case TickPhase::SNAPSHOT:
+        return "snapshot";
+    default:
+        return "unknown";
+    }
+}
+
+//! ------ DurationHistogram ------
+
+void DurationHistogram::Record(double ms) noexcept {
+    std::size_t bucket = 0;
+    double bound = MIN_BOUND;
+    while (bucket + 1 < BUCKETS && ms > bound) {
+        bound *= 2.0;
+        ++bucket;
+    }
+    ++buckets_[bucket];
+    ++count_;
+    sum_ += ms;
+    max_ = std::max(max_, ms);
+}
+
+void DurationHistogram::Merge(const DurationHistogram& other) noexcept {
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+}
+
+void DurationHistogram::Clear() noexcept {
+    *this = DurationHistogram{};
+}
+
+std::uint64_t DurationHistogram::GetCount() const noexcept {
+    return count_;
+}
+
+double DurationHistogram::GetSum() const noexcept {
+    return sum_;
+}
+
+double DurationHistogram::GetMax() const noexcept {
+    return max_;
+}
+
+double DurationHistogram::GetMean() const noexcept {
+    return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_);
+}
+
+double DurationHistogram::GetPercentile(double p) const noexcept {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(count_)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            return std::min(GetBucketBound(i), max_);
+        }
+    }
+    return max_;
+}
+
+double DurationHistogram::GetBucketBound(std::size_t bucket) noexcept {
+    return std::ldexp(MIN_BOUND, static_cast<int>(bucket));
+}
+
+//! ------ RollingHistogram ------
+
+void RollingHistogram::Record(double ms, std::uint64_t epoch) noexcept {
+    const std::size_t slot = epoch % SLOTS;
+    if (slot_epochs_[slot] != epoch) {
+        slots_[slot].Clear();
+        slot_epochs_[slot] = epoch;
+    }
+    slots_[slot].Record(ms);
+}
+
+DurationHistogram RollingHistogram::GetWindow(std::uint64_t epoch) const noexcept {
+    DurationHistogram result;
+    for (std::size_t slot = 0; slot < SLOTS; ++slot) {
+        if (slot_epochs_[slot] <= epoch && slot_epochs_[slot] + SLOTS > epoch) {
+            result.Merge(slots_[slot]);
+        }
+    }
+    return result;
+}
+
+//! ------ SessionTickProfile ------
+
+SessionTickProfile::SessionTickProfile(std::string map_id, std::size_t instance)
+    : map_id_(std::move(map_id)),
+    instance_(instance)
+{
+}
+
+void SessionTickProfile::RecordTick(const TickPhaseTimes& phases, std::uint64_t dogs, std::uint64_t moving_dogs,
+                                    std::uint64_t lost_objects, std::uint64_t players) {
+    std::lock_guard lock{mutex_};
+    const std::uint64_t epoch = ticks_ / TICKS_PER_SLOT;
+    ++ticks_;
+    dogs_ = dogs;
+    moving_dogs_ = moving_dogs;
+    lost_objects_ = lost_objects;
+    players_ = players;
+
+    tick_.Record(phases.spawn + phases.move + phases.collect + phases.retire + phases.db_write, epoch);
+    phases_[static_cast<std::size_t>(TickPhase::SPAWN)].Record(phases.spawn, epoch);
+    phases_[static_cast<std::size_t>(TickPhase::MOVE)].Record(phases.move, epoch);
+    phases_[static_cast<std::size_t>(TickPhase::COLLECT)].Record(phases.collect, epoch);
+    phases_[static_cast<std::size_t>(TickPhase::RETIRE)].Record(phases.retire, epoch);
+    phases_[static_cast<std::size_t>(TickPhase::DB_WRITE)].Record(phases.db_write, epoch);
+}
+
+void SessionTickProfile::RecordSnapshot(double ms) {
+    std::lock_guard lock{mutex_};
+    phases_[static_cast<std::size_t>(TickPhase::SNAPSHOT)].Record(ms, GetLastEpoch());
+}
+
+SessionTickReport SessionTickProfile::GetReport() const {
+    SessionTickReport report;
+    report.map_id = map_id_;
+    report.instance = instance_;
+
+    std::lock_guard lock{mutex_};
+    const std::uint64_t epoch = GetLastEpoch();
+    report.ticks = ticks_;
+    report.dogs = dogs_;
+    report.moving_dogs = moving_dogs_;
+    report.lost_objects = lost_objects_;
+    report.players = players_;
+    report.tick = tick_.GetWindow(epoch);
+    for (std::size_t i = 0; i < TICK_PHASES_COUNT; ++i) {
+        report.phases[i] = phases_[i].GetWindow(epoch);
+    }
+    return report;
+}
+
+std::uint64_t SessionTickProfile::GetLastEpoch() const noexcept {
+    return ticks_ == 0 ? 0 : (ticks_ - 1) / TICKS_PER_SLOT;
+}
+
+//! ------ TickProfiler ------
+
+SessionTickProfile& TickProfiler::GetSessionProfile(const GameSession& session) {
+    {
+        std::shared_lock lock{sessions_mutex_};
+        if (auto it = sessions_.find(&session); it != sessions_.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock lock{sessions_mutex_};
+    auto& profile = sessions_[&session];
+    if (!profile) {
+        profile = std::make_unique<SessionTickProfile>(*session.GetMap()->GetId(), session.GetInstance());
+    }
+    return *profile;
+}
+
+void TickProfiler::RecordSave(double ms) {
+    std::lock_guard lock{save_mutex_};
+    save_.Record(ms, saves_ / SAVES_PER_SLOT);
+    ++saves_;
+}
+
+TickProfileReport TickProfiler::GetReport() const {
+    TickProfileReport report;
+    {
+        std::shared_lock lock{sessions_mutex_};
+        report.sessions.reserve(sessions_.size());
+        for (const auto& [session, profile] : sessions_) {
+            report.sessions.push_back(profile->GetReport());
+        }
+    }
+    std::sort(report.sessions.begin(), report.sessions.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.map_id, lhs.instance) < std::tie(rhs.map_id, rhs.instance);
+    });
+
+    std::lock_guard lock{save_mutex_};
+    report.saves = saves_;
+    // Эпоха последней записи: окно заканчивается на ней
+    report.save = save_.GetWindow(saves_ == 0 ? 0 : (saves_ - 1) / SAVES_PER_SLOT);
+    return report;
+}
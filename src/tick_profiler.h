@@ -0,0 +1,158 @@
+#pragma once
+
+#include "game_session.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Фазы тика сессии, время которых учитывается профилировщиком
+enum class TickPhase : std::size_t {
+    SPAWN,
+    MOVE,
+    COLLECT,
+    RETIRE,
+    DB_WRITE,
+    // Снимок сессии для сохранения, снимается не на каждом тике
+    SNAPSHOT,
+    COUNT
+};
+
+inline constexpr std::size_t TICK_PHASES_COUNT = static_cast<std::size_t>(TickPhase::COUNT);
+
+std::string_view GetTickPhaseName(TickPhase phase) noexcept;
+
+/*
+ *  Гистограмма длительностей с логарифмическими корзинами: верхняя граница корзины i —
+ *  MIN_BOUND * 2^i мс, последняя корзина открыта сверху. Запись — несколько сравнений
+ *  и инкремент, память не выделяется.
+ */
+class DurationHistogram {
+public:
+    static constexpr std::size_t BUCKETS = 24;
+    // 1 мкс; последняя ограниченная корзина заканчивается на ~4 с
+    static constexpr double MIN_BOUND = 0.001;
+
+    void Record(double ms) noexcept;
+
+    void Merge(const DurationHistogram& other) noexcept;
+
+    void Clear() noexcept;
+
+    std::uint64_t GetCount() const noexcept;
+
+    double GetSum() const noexcept;
+
+    double GetMax() const noexcept;
+
+    double GetMean() const noexcept;
+
+    // Верхняя граница корзины, в которую попадает p-я доля записей (не больше максимума)
+    double GetPercentile(double p) const noexcept;
+
+    static double GetBucketBound(std::size_t bucket) noexcept;
+
+private:
+    std::array<std::uint64_t, BUCKETS> buckets_{};
+    std::uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double max_ = 0.0;
+};
+
+/*
+ *  Скользящее окно из SLOTS гистограмм. Номер эпохи задаёт вызывающий (номер тика,
+ *  делённый на длину слота), поэтому окну не нужны часы: при переходе в новую эпоху
+ *  её слот очищается, а в отчёт попадают только последние SLOTS эпох.
+ */
+class RollingHistogram {
+public:
+    static constexpr std::size_t SLOTS = 8;
+
+    void Record(double ms, std::uint64_t epoch) noexcept;
+
+    DurationHistogram GetWindow(std::uint64_t epoch) const noexcept;
+
+private:
+    std::array<DurationHistogram, SLOTS> slots_;
+    std::array<std::uint64_t, SLOTS> slot_epochs_{};
+};
+
+// Статистика сессии на момент запроса
+struct SessionTickReport {
+    std::string map_id;
+    std::size_t instance = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t dogs = 0;
+    std::uint64_t moving_dogs = 0;
+    std::uint64_t lost_objects = 0;
+    std::uint64_t players = 0;
+    // Время всего тика сессии и отдельных фаз за окно
+    DurationHistogram tick;
+    std::array<DurationHistogram, TICK_PHASES_COUNT> phases;
+};
+
+/*
+ *  Профиль тиков одной сессии. Пишется в strand сессии, читается из обработчика запроса,
+ *  поэтому данные под мьютексом: он захватывается один раз за тик и почти всегда свободен.
+ */
+class SessionTickProfile {
+public:
+    // Длина слота скользящего окна в тиках
+    static constexpr std::uint64_t TICKS_PER_SLOT = 256;
+
+    SessionTickProfile(std::string map_id, std::size_t instance);
+
+    void RecordTick(const TickPhaseTimes& phases, std::uint64_t dogs, std::uint64_t moving_dogs,
+                    std::uint64_t lost_objects, std::uint64_t players);
+
+    void RecordSnapshot(double ms);
+
+    SessionTickReport GetReport() const;
+
+private:
+    // Эпоха последнего тика: окно отчёта заканчивается на ней
+    std::uint64_t GetLastEpoch() const noexcept;
+
+    const std::string map_id_;
+    const std::size_t instance_;
+
+    mutable std::mutex mutex_;
+    std::uint64_t ticks_ = 0;
+    std::uint64_t dogs_ = 0;
+    std::uint64_t moving_dogs_ = 0;
+    std::uint64_t lost_objects_ = 0;
+    std::uint64_t players_ = 0;
+    RollingHistogram tick_;
+    std::array<RollingHistogram, TICK_PHASES_COUNT> phases_;
+};
+
+struct TickProfileReport {
+    std::vector<SessionTickReport> sessions;
+    // Запись файла состояния, общая для всех сессий
+    DurationHistogram save;
+    std::uint64_t saves = 0;
+};
+
+// Профили тиков всех сессий. Профиль создаётся при первом тике сессии и живёт, пока жива игра.
+class TickProfiler {
+public:
+    SessionTickProfile& GetSessionProfile(const GameSession& session);
+
+    void RecordSave(double ms);
+
+    TickProfileReport GetReport() const;
+
+private:
+    mutable std::shared_mutex sessions_mutex_;
+    std::unordered_map<const GameSession*, std::unique_ptr<SessionTickProfile>> sessions_;
+
+    mutable std::mutex save_mutex_;
+    std::uint64_t saves_ = 0;
+    RollingHistogram save_;
+};
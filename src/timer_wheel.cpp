@@ -0,0 +1,109 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+
+void TimerWheel::Schedule(std::uint32_t id, double deadline) {
+    if (id >= nodes_.size()) {
+        nodes_.resize(id + 1);
+    }
+    if (nodes_[id].bucket != NONE) {
+        Unlink(id);
+    }
+    const std::uint64_t key = static_cast<std::uint64_t>(std::ceil(std::max(deadline, 0.0)));
+    // Просроченный таймер сработает на ближайшем шаге колеса
+    Link(id, std::max(key, current_ + 1));
+}
+
+void TimerWheel::Cancel(std::uint32_t id) {
+    if (IsScheduled(id)) {
+        Unlink(id);
+    }
+}
+
+bool TimerWheel::IsScheduled(std::uint32_t id) const noexcept {
+    return id < nodes_.size() && nodes_[id].bucket != NONE;
+}
+
+std::size_t TimerWheel::Size() const noexcept {
+    return size_;
+}
+
+std::size_t TimerWheel::BucketFor(std::uint64_t key) const noexcept {
+    // Уровень определяется старшей 6-битной группой, в которой срок отличается от текущего времени
+    const std::uint64_t diff = key ^ current_;
+    const unsigned level = (static_cast<unsigned>(std::bit_width(diff | 1)) - 1) / SLOT_BITS;
+    if (level >= LEVELS) {
+        return OVERFLOW_BUCKET;
+    }
+    return level * SLOTS + ((key >> (level * SLOT_BITS)) & SLOT_MASK);
+}
+
+void TimerWheel::Link(std::uint32_t id, std::uint64_t key) {
+    const std::size_t bucket = BucketFor(key);
+    Node& node = nodes_[id];
+    node.key = key;
+    node.bucket = static_cast<std::uint32_t>(bucket);
+    node.prev = NONE;
+    node.next = heads_[bucket];
+    if (node.next != NONE) {
+        nodes_[node.next].prev = id;
+    }
+    heads_[bucket] = id;
+    if (bucket < SLOTS) {
+        level0_occupied_ |= std::uint64_t{1} << bucket;
+    }
+    ++size_;
+}
+
+void TimerWheel::Unlink(std::uint32_t id) {
+    Node& node = nodes_[id];
+    if (node.prev != NONE) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.bucket] = node.next;
+        if (node.next == NONE && node.bucket < SLOTS) {
+            level0_occupied_ &= ~(std::uint64_t{1} << node.bucket);
+        }
+    }
+    if (node.next != NONE) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = NONE;
+    node.next = NONE;
+    node.bucket = NONE;
+    --size_;
+}
+
+std::uint64_t TimerWheel::NextStep() const noexcept {
+    // На нулевом уровне лежат сроки из текущего блока в SLOTS мс, все позже current_
+    const std::uint64_t offset = current_ & SLOT_MASK;
+    const std::uint64_t later = offset == SLOT_MASK ? 0 : level0_occupied_ & (~std::uint64_t{0} << (offset + 1));
+    if (later != 0) {
+        return (current_ & ~SLOT_MASK) + static_cast<std::uint64_t>(std::countr_zero(later));
+    }
+    // До конца блока таймеров нет: следующий шаг — граница блока, где переносятся таймеры верхних уровней
+    return (current_ | SLOT_MASK) + 1;
+}
+
+void TimerWheel::Cascade() {
+    if ((current_ & ((std::uint64_t{1} << (LEVELS * SLOT_BITS)) - 1)) == 0) {
+        Rehash(OVERFLOW_BUCKET);
+    }
+    for (unsigned level = LEVELS - 1; level > 0; --level) {
+        if ((current_ & ((std::uint64_t{1} << (level * SLOT_BITS)) - 1)) == 0) {
+            Rehash(level * SLOTS + ((current_ >> (level * SLOT_BITS)) & SLOT_MASK));
+        }
+    }
+}
+
+void TimerWheel::Rehash(std::size_t bucket) {
+    std::uint32_t id = heads_[bucket];
+    while (id != NONE) {
+        const std::uint32_t next = nodes_[id].next;
+        const std::uint64_t key = nodes_[id].key;
+        Unlink(id);
+        Link(id, key);
+        id = next;
+    }
+}
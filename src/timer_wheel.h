@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ *  Иерархическое колесо таймеров. Ключ таймера — момент игрового времени в миллисекундах,
+ *  id — плотный номер объекта (слот собаки). Постановка и отмена таймера стоят O(1),
+ *  продвижение времени — O(число сработавших таймеров) плюс перенос таймеров
+ *  с верхних уровней колеса по мере приближения их срока. Пустые ячейки нулевого уровня
+ *  пропускаются по битовой карте: время идёт скачками до ближайшего таймера или переноса.
+ */
+class TimerWheel {
+public:
+    // Ставит таймер id на момент deadline (мс). Ранее поставленный таймер id отменяется.
+    // Таймер со сроком в прошлом сработает при следующем продвижении времени.
+    void Schedule(std::uint32_t id, double deadline);
+
+    void Cancel(std::uint32_t id);
+
+    bool IsScheduled(std::uint32_t id) const noexcept;
+
+    std::size_t Size() const noexcept;
+
+    // Продвигает время до now и вызывает fn(id) для каждого таймера со сроком не позже now
+    template <typename Fn>
+    void Advance(double now, Fn&& fn) {
+        const std::uint64_t target = static_cast<std::uint64_t>(std::floor(std::max(now, 0.0)));
+        if (size_ == 0) {
+            current_ = std::max(current_, target);
+            return;
+        }
+        while (current_ < target) {
+            current_ = std::min(NextStep(), target);
+            Cascade();
+            // После переноса в ячейке нулевого уровня лежат только таймеры со сроком current_
+            std::uint32_t& head = heads_[current_ & SLOT_MASK];
+            while (head != NONE) {
+                const std::uint32_t id = head;
+                Unlink(id);
+                fn(id);
+            }
+            if (size_ == 0) {
+                current_ = target;
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr std::uint64_t SLOTS = 1u << SLOT_BITS;
+    static constexpr std::uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr unsigned LEVELS = 4;
+    // Ячейка для сроков дальше, чем покрывают уровни колеса (~4.6 часа)
+    static constexpr std::size_t OVERFLOW_BUCKET = LEVELS * SLOTS;
+
+    struct Node {
+        std::uint32_t prev = NONE;
+        std::uint32_t next = NONE;
+        std::uint32_t bucket = NONE;
+        std::uint64_t key = 0;
+    };
+
+    std::size_t BucketFor(std::uint64_t key) const noexcept;
+
+    void Link(std::uint32_t id, std::uint64_t key);
+
+    void Unlink(std::uint32_t id);
+
+    // Ближайший момент после current_, когда срабатывает таймер нулевого уровня или нужен перенос с верхних
+    std::uint64_t NextStep() const noexcept;
+
+    // Переносит на нижние уровни таймеры, чей срок оказался в пределах следующего уровня
+    void Cascade();
+
+    void Rehash(std::size_t bucket);
+
+    std::array<std::uint32_t, LEVELS * SLOTS + 1> heads_ = MakeEmptyHeads();
+    std::vector<Node> nodes_;
+    std::uint64_t current_ = 0;
+    std::size_t size_ = 0;
+    // Бит i — ячейка i нулевого уровня не пуста
+    std::uint64_t level0_occupied_ = 0;
+
+    static constexpr std::array<std::uint32_t, LEVELS * SLOTS + 1> MakeEmptyHeads() {
+        std::array<std::uint32_t, LEVELS * SLOTS + 1> heads{};
+        for (auto& head : heads) {
+            head = NONE;
+        }
+        return heads;
+    }
+};
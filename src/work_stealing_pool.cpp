@@ -0,0 +1,130 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    threads = std::max(1u, threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads - 1);
+    for (unsigned i = 0; i + 1 < threads; ++i) {
+        workers_.emplace_back([this, i] {
+            WorkerLoop(i);
+        });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock{sleep_mutex_};
+        stop_ = true;
+    }
+    wake_.notify_all();
+    workers_.clear();
+}
+
+unsigned WorkStealingPool::GetThreadsCount() const noexcept {
+    return static_cast<unsigned>(queues_.size());
+}
+
+void WorkStealingPool::ParallelFor(std::size_t count, std::size_t grain, const RangeFn& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(1, grain);
+    const std::size_t tasks_count = (count + grain - 1) / grain;
+    if (tasks_count == 1 || workers_.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    Job job{&fn, tasks_count, {}, {}, nullptr};
+    {
+        std::lock_guard lock{sleep_mutex_};
+        pending_ += tasks_count;
+    }
+    // Куски раскладываются по очередям по кругу, дальше потоки выравнивают нагрузку кражей
+    for (std::size_t t = 0; t < tasks_count; ++t) {
+        Queue& queue = *queues_[t % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        queue.tasks.push_back(Task{&job, t * grain, std::min(count, (t + 1) * grain)});
+    }
+    wake_.notify_all();
+
+    const std::size_t own_queue = queues_.size() - 1;
+    Task task;
+    while (TryTake(own_queue, task)) {
+        Run(task);
+    }
+    // Свободных кусков нет — остаётся дождаться тех, что выполняются в других потоках
+    {
+        std::unique_lock lock{job.mutex};
+        job.done.wait(lock, [&job] {
+            return job.remaining == 0;
+        });
+    }
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void WorkStealingPool::WorkerLoop(std::size_t queue_idx) {
+    Task task;
+    while (true) {
+        if (TryTake(queue_idx, task)) {
+            Run(task);
+            continue;
+        }
+        std::unique_lock lock{sleep_mutex_};
+        wake_.wait(lock, [this] {
+            return stop_ || pending_.load() != 0;
+        });
+        if (stop_ && pending_.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::TryTake(std::size_t queue_idx, Task& task) {
+    // Сначала своя очередь с конца, затем чужие с начала
+    {
+        Queue& own = *queues_[queue_idx];
+        std::lock_guard lock{own.mutex};
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            --pending_;
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(queue_idx + i) % queues_.size()];
+        std::lock_guard lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            --pending_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(const Task& task) {
+    Job& job = *task.job;
+    try {
+        (*job.fn)(task.begin, task.end);
+    } catch (...) {
+        std::lock_guard lock{job.mutex};
+        if (!job.error) {
+            job.error = std::current_exception();
+        }
+    }
+    // Уведомление под тем же мьютексом: вызывающий не выйдет из ожидания, пока мьютекс не отпущен
+    std::lock_guard lock{job.mutex};
+    if (--job.remaining == 0) {
+        job.done.notify_all();
+    }
+}
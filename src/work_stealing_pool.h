@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ *  Пул потоков для расчёта тика. ParallelFor режет диапазон на куски и раскладывает
+ *  их по очередям потоков; поток берёт работу с конца своей очереди, а закончив её,
+ *  крадёт куски с начала чужих. Вызывающий поток тоже участвует в работе и
+ *  возвращается, только когда выполнены все куски его диапазона.
+ */
+class WorkStealingPool {
+public:
+    using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // threads — общее число потоков расчёта, включая вызывающий
+    explicit WorkStealingPool(unsigned threads);
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool();
+
+    unsigned GetThreadsCount() const noexcept;
+
+    // Вызывает fn(begin, end) для кусков [0, count) длиной не больше grain.
+    // Исключение из fn пробрасывается вызывающему после завершения всех кусков.
+    void ParallelFor(std::size_t count, std::size_t grain, const RangeFn& fn);
+
+private:
+    // Job живёт на стеке ParallelFor. remaining меняется и проверяется только под mutex:
+    // иначе вызывающий может вернуться и разрушить Job, пока поток, выполнивший последний кусок, ещё будит его.
+    struct Job {
+        const RangeFn* fn;
+        std::size_t remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        Job* job;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(std::size_t queue_idx);
+
+    bool TryTake(std::size_t queue_idx, Task& task);
+
+    void Run(const Task& task);
+
+    // Последняя очередь принадлежит вызывающим ParallelFor потокам
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<std::size_t> pending_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::vector<std::jthread> workers_;
+};
@@ -162,6 +162,9 @@ class GameState {
     this.requestInstantUpdate = false;
     this.cameraPos = undefined;
     this.lostObjects = {};
+    // Состояние сервера на тике stateTick, к нему применяются ответы с изменениями
+    this.serverState = {players: {}, lostObjects: {}};
+    this.stateTick = undefined;
     this.disappearingLoot = {};
     this.player_elems = {};
 
@@ -411,19 +414,44 @@ class GameState {
 
   _updateState(then) {
     let self = this;
+    // После первого ответа сервер присылает только то, что изменилось после известного нам тика.
+    // Метку из X-Game-Tick возвращаем как есть: после перезапуска сервера она устареет, и придёт полное состояние
+    const since = self.stateTick !== undefined ? '?since=' + encodeURIComponent(self.stateTick) : '';
     $.get({
-      url: '/api/v1/game/state',
+      url: '/api/v1/game/state' + since,
       dataType: 'json',
       beforeSend: function(xhr) {
         xhr.setRequestHeader("Authorization", "Bearer " + Cookies.get('authToken'));
       }
-    }).done(function(x){
-      self.desiredState = x;
+    }).done(function(x, status, xhr){
+      self._mergeServerState(x, xhr.getResponseHeader('X-Game-State') === 'delta');
+      self.stateTick = xhr.getResponseHeader('X-Game-Tick') || undefined;
+      // _applyDesiredState дополняет объекты игроков, поэтому каждый раз отдаём ему копии
+      const players = {};
+      Object.entries(self.serverState.players).forEach(([id, player]) => {
+        players[id] = Object.assign({}, player);
+      });
+      self.desiredState = {players: players, lostObjects: Object.assign({}, self.serverState.lostObjects)};
       self.stateTime = performance.now();
       then();
     })
   }
 
+  _mergeServerState(x, delta) {
+    if (!delta) {
+      this.serverState = {players: x.players, lostObjects: x.lostObjects};
+      return;
+    }
+    Object.assign(this.serverState.players, x.players);
+    Object.assign(this.serverState.lostObjects, x.lostObjects);
+    for (const id of x.removedPlayers) {
+      delete this.serverState.players[id];
+    }
+    for (const id of x.removedLostObjects) {
+      delete this.serverState.lostObjects[id];
+    }
+  }
+
   _interpolateRotation(old_pos, new_pos) {
     const pi = Math.PI;
     const rot_speed = pi / 300;
@@ -0,0 +1,45 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/alias_table.h"
+
+#include <vector>
+
+SCENARIO("Alias table") {
+    GIVEN("a table built from unequal weights") {
+        const std::vector<double> weights{1.0, 3.0, 0.0, 6.0};
+        const AliasTable table{weights};
+        REQUIRE(table.Size() == 4);
+
+        WHEN("many indices are sampled") {
+            rng::Xoshiro256 random{7};
+            const int samples = 200000;
+            std::vector<int> counts(weights.size(), 0);
+            for (int i = 0; i < samples; ++i) {
+                ++counts[table.Sample(random)];
+            }
+
+            THEN("frequencies follow the weights and zero weights are never chosen") {
+                CHECK(counts[0] / double(samples) == Catch::Approx(0.1).margin(0.01));
+                CHECK(counts[1] / double(samples) == Catch::Approx(0.3).margin(0.01));
+                CHECK(counts[2] == 0);
+                CHECK(counts[3] / double(samples) == Catch::Approx(0.6).margin(0.01));
+            }
+        }
+    }
+
+    GIVEN("a table with all weights zero") {
+        const std::vector<double> weights{0.0, 0.0};
+        const AliasTable table{weights};
+
+        THEN("every index can be chosen") {
+            rng::Xoshiro256 random{1};
+            std::vector<int> counts(2, 0);
+            for (int i = 0; i < 1000; ++i) {
+                ++counts[table.Sample(random)];
+            }
+            CHECK(counts[0] > 0);
+            CHECK(counts[1] > 0);
+        }
+    }
+}
@@ -0,0 +1,252 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/request_handler.h"
+#include "test_maps.h"
+
+#include <string>
+#include <tuple>
+
+using namespace std::literals;
+
+namespace {
+
+namespace http = http_handler::http;
+namespace json = boost::json;
+
+unsigned GetStatus(const http_handler::Response& response) {
+    return std::visit([](const auto& r) {
+        return r.result_int();
+    }, response);
+}
+
+std::string GetHeader(const http_handler::Response& response, std::string_view name) {
+    return std::visit([name](const auto& r) {
+        return std::string(r[name]);
+    }, response);
+}
+
+// Тело ответа API: строка или общий буфер снимка
+std::string GetBody(const http_handler::Response& response) {
+    if (const auto* cached = std::get_if<http_handler::CachedResponse>(&response)) {
+        return *cached->body();
+    }
+    return std::get<http_handler::StringResponse>(response).body();
+}
+
+// Игра с одной картой и игроком в её сессии
+struct GameFixture {
+    GameFixture() {
+        game.AddMap(MakeTestMap());
+        session = app.FindJoinableSession("map"s);
+        REQUIRE(session);
+        std::string name = "dog"s;
+        std::tie(player, token) = app.JoinPlayer(name, *session);
+    }
+
+    http_handler::Response RequestState(std::string_view query) {
+        http_handler::StringRequest req{http::verb::get, "/api/v1/game/state", 11};
+        req.set(http::field::authorization, "Bearer "s + *token);
+        return handler(http::status::ok, http_handler::ApiRequest{http_handler::ApiEndpoint::STATE, {}, query}, req, session);
+    }
+
+    model::Game game;
+    Application app{&game, nullptr};
+    http_handler::ApiHandler handler{&app};
+    GameSession* session = nullptr;
+    Player* player = nullptr;
+    Token token{""s};
+};
+
+} // namespace
+
+SCENARIO("Game state requests") {
+    GIVEN("a player in a session") {
+        GameFixture fixture;
+        Application& app = fixture.app;
+        GameSession* session = fixture.session;
+        auto request_state = [&fixture](std::string_view query) {
+            return fixture.RequestState(query);
+        };
+        const std::string epoch = std::to_string(app.GetStateEpoch());
+
+        WHEN("the state is requested without since") {
+            const auto response = request_state(""sv);
+
+            THEN("the full state is tagged with the server epoch and the session tick") {
+                CHECK(GetStatus(response) == 200);
+                CHECK(GetHeader(response, "X-Game-State") == "full"s);
+                CHECK(GetHeader(response, "X-Game-Tick") == epoch + ".0"s);
+            }
+        }
+
+        WHEN("the client passes back the tag it got") {
+            const std::string tag = GetHeader(request_state(""sv), "X-Game-Tick");
+            session->AdvanceTick();
+            const auto response = request_state("since="s + tag);
+
+            THEN("only changes are sent") {
+                CHECK(GetStatus(response) == 200);
+                CHECK(GetHeader(response, "X-Game-State") == "delta"s);
+                CHECK(GetHeader(response, "X-Game-Tick") == epoch + ".1"s);
+            }
+        }
+
+        WHEN("dogs and lost objects change after the tag") {
+            Loot loot{json::object{{"name", "key"}, {"value", 10}}};
+            session->AddLostObject(5.0, 0.0, &loot);
+            const int removed = session->AddLostObject(6.0, 0.0, &loot);
+            std::string name = "cat"s;
+            const auto [cat, cat_token] = app.JoinPlayer(name, *session);
+            const std::string dog_id = std::to_string(fixture.player->GetDog()->GetId());
+            const std::string cat_id = std::to_string(cat->GetDog()->GetId());
+            session->SetDogRetirementTime(1500.0);
+            session->AdvanceTick();
+            const std::string tag = GetHeader(request_state(""sv), "X-Game-Tick");
+
+            // Собака игрока идёт, кот стоит дольше срока и уходит, одна вещь появляется, другая исчезает
+            const double start_x = fixture.player->GetDog()->GetPosition().x;
+            app.MakePlayerAction(fixture.player, "R"s);
+            session->MoveDogs(2000.0);
+            const int added = session->AddLostObject(7.0, 0.0, &loot);
+            session->RemoveLostObject(removed);
+            session->AdvanceTick();
+            const auto response = request_state("since="s + tag);
+
+            THEN("the body holds only what changed since the tag") {
+                CHECK(GetHeader(response, "X-Game-State") == "delta"s);
+                const json::value body = json::parse(GetBody(response));
+
+                const json::object& players = body.at("players").as_object();
+                REQUIRE(players.size() == 1);
+                const json::value& dog = players.at(dog_id);
+                CHECK(dog.at("pos").at(0).as_double() > start_x);
+                CHECK(dog.at("dir").as_string() == "R"sv);
+                CHECK(body.at("removedPlayers").as_array() == json::array{json::value(cat_id)});
+
+                const json::object& lost_objects = body.at("lostObjects").as_object();
+                REQUIRE(lost_objects.size() == 1);
+                const json::value& lost = lost_objects.at(std::to_string(added));
+                CHECK(lost.at("type").as_int64() == 0);
+                CHECK(lost.at("pos").at(0).as_double() == 7.0);
+                CHECK(body.at("removedLostObjects").as_array() == json::array{json::value(std::to_string(removed))});
+            }
+        }
+
+        WHEN("since is malformed") {
+            THEN("the request is rejected") {
+                CHECK(GetStatus(request_state("since=abc"sv)) == 400);
+                CHECK(GetStatus(request_state("since=0"sv)) == 400);
+                CHECK(GetStatus(request_state("since="s + epoch + ".x"s)) == 400);
+                CHECK(GetStatus(request_state("since=."sv)) == 400);
+            }
+        }
+
+        WHEN("since comes from another server run") {
+            const std::string other_epoch = std::to_string(app.GetStateEpoch() + 1);
+            const auto response = request_state("since="s + other_epoch + ".0"s);
+
+            THEN("the full state is sent") {
+                CHECK(GetStatus(response) == 200);
+                CHECK(GetHeader(response, "X-Game-State") == "full"s);
+            }
+        }
+
+        WHEN("since is older than the session remembers") {
+            for (std::size_t i = 0; i <= STATE_CHANGES_TICKS; ++i) {
+                session->AdvanceTick();
+            }
+            const auto response = request_state("since="s + epoch + ".0"s);
+
+            THEN("the full state is sent") {
+                CHECK(GetStatus(response) == 200);
+                CHECK(GetHeader(response, "X-Game-State") == "full"s);
+            }
+        }
+    }
+}
+
+SCENARIO("Shared state snapshots") {
+    GIVEN("a player in a session") {
+        GameFixture fixture;
+        GameSession& session = *fixture.session;
+        auto state_body = [&fixture] {
+            auto response = fixture.RequestState(""sv);
+            return std::get<http_handler::CachedResponse>(std::move(response)).body();
+        };
+
+        WHEN("the state is requested twice in the same tick") {
+            const auto first = state_body();
+            const auto second = state_body();
+
+            THEN("both responses share one buffer equal to the serialized session") {
+                REQUIRE(first);
+                CHECK(first.get() == second.get());
+                CHECK(*first == json_loader::GetSerializedSessionState(session));
+            }
+        }
+
+        WHEN("the session ticks") {
+            const auto before = state_body();
+            fixture.game.UpdateSession(session, 100);
+            const auto after = state_body();
+
+            THEN("the snapshot is built again") {
+                CHECK(before.get() != after.get());
+                CHECK(*after == json_loader::GetSerializedSessionState(session));
+                CHECK(state_body().get() == after.get());
+            }
+        }
+
+        WHEN("two clients ask for changes since the same tag within one tick") {
+            const std::string since = GetHeader(fixture.RequestState(""sv), "X-Game-Tick");
+            fixture.game.UpdateSession(session, 100);
+            auto changes_body = [&fixture, &since] {
+                auto response = fixture.RequestState("since="s + since);
+                REQUIRE(GetHeader(response, "X-Game-State") == "delta"s);
+                return std::get<http_handler::CachedResponse>(std::move(response)).body();
+            };
+            const auto first = changes_body();
+            const auto second = changes_body();
+
+            THEN("both get one shared delta buffer") {
+                REQUIRE(first);
+                CHECK(first.get() == second.get());
+                CHECK(*first == json_loader::GetSerializedSessionChanges(session, *session.GetChangesSince(0)));
+
+                AND_WHEN("the next tick passes") {
+                    fixture.game.UpdateSession(session, 100);
+
+                    THEN("the delta is built again") {
+                        CHECK(changes_body().get() != first.get());
+                    }
+                }
+            }
+        }
+
+        WHEN("another player joins") {
+            const auto before = state_body();
+            GameSession* joined = fixture.app.FindJoinableSession("map"s);
+            REQUIRE(joined == &session);
+            std::string name = "cat"s;
+            fixture.app.JoinPlayer(name, session);
+            const auto after = state_body();
+
+            THEN("the snapshot is built again") {
+                CHECK(before.get() != after.get());
+                CHECK(*after == json_loader::GetSerializedSessionState(session));
+            }
+        }
+
+        WHEN("the player moves") {
+            const auto before = state_body();
+            fixture.app.MakePlayerAction(fixture.player, "R"s);
+            const auto after = state_body();
+
+            THEN("the snapshot is built again") {
+                CHECK(before.get() != after.get());
+                CHECK(*after == json_loader::GetSerializedSessionState(session));
+                CHECK(*after != *before);
+            }
+        }
+    }
+}
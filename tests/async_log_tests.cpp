@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/async_log.h"
+
+#include <boost/json.hpp>
+
+#include <thread>
+#include <vector>
+
+SCENARIO("Bounded MPSC ring") {
+    GIVEN("a ring with capacity rounded up to a power of two") {
+        MpscRing<int> ring{3};
+        REQUIRE(ring.GetCapacity() == 4);
+
+        WHEN("it is filled") {
+            for (int i = 0; i < 4; ++i) {
+                REQUIRE(ring.TryPush(i));
+            }
+
+            THEN("further pushes fail instead of waiting") {
+                CHECK_FALSE(ring.TryPush(4));
+            }
+
+            THEN("values are popped in order and free the cells") {
+                int value = -1;
+                for (int i = 0; i < 4; ++i) {
+                    REQUIRE(ring.TryPop(value));
+                    CHECK(value == i);
+                }
+                CHECK_FALSE(ring.TryPop(value));
+                CHECK(ring.TryPush(5));
+            }
+        }
+    }
+
+    GIVEN("several producers and one consumer") {
+        constexpr int PRODUCERS = 4;
+        constexpr int PER_PRODUCER = 10000;
+        MpscRing<int> ring{64};
+
+        WHEN("producers retry until every value is pushed") {
+            std::vector<std::jthread> producers;
+            for (int p = 0; p < PRODUCERS; ++p) {
+                producers.emplace_back([&ring, p] {
+                    for (int i = 0; i < PER_PRODUCER; ++i) {
+                        while (!ring.TryPush(p * PER_PRODUCER + i)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+
+            std::vector<int> last(PRODUCERS, -1);
+            bool ordered = true;
+            int received = 0;
+            int value = 0;
+            while (received < PRODUCERS * PER_PRODUCER) {
+                if (!ring.TryPop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const int producer = value / PER_PRODUCER;
+                ordered = ordered && value % PER_PRODUCER == last[producer] + 1;
+                last[producer] = value % PER_PRODUCER;
+                ++received;
+            }
+
+            THEN("each value arrives once and in the order of its producer") {
+                CHECK(ordered);
+                CHECK(ring.TryPop(value) == false);
+            }
+        }
+    }
+}
+
+SCENARIO("Log record formatting") {
+    using namespace async_log;
+
+    GIVEN("a response record") {
+        Record record;
+        record.event = Event::RESPONSE_SENT;
+        record.address.Assign("127.0.0.1");
+        record.response_time = 12;
+        record.code = 200;
+        record.text.Assign("application/json");
+
+        THEN("it is formatted as the old Boost.Log entry") {
+            const auto line = boost::json::parse(FormatRecord(record)).as_object();
+            CHECK(line.at("message").as_string() == "response sent");
+            CHECK(line.contains("timestamp"));
+            const auto& data = line.at("data").as_object();
+            CHECK(data.at("ip").as_string() == "127.0.0.1");
+            CHECK(data.at("response_time").as_int64() == 12);
+            CHECK(data.at("code").as_int64() == 200);
+            CHECK(data.at("content_type").as_string() == "application/json");
+        }
+    }
+
+    GIVEN("a value longer than the record field") {
+        Record record;
+        record.uri.Assign(std::string(1000, 'a'));
+
+        THEN("it is truncated") {
+            CHECK(record.uri.View().size() == sizeof(record.uri.data));
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/collision_detector.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace model::collision_detector;
+
+namespace {
+
+class TestProvider : public ItemGathererProvider {
+public:
+    TestProvider(std::vector<Item> items, std::vector<Gatherer> gatherers)
+        : items_(std::move(items)), gatherers_(std::move(gatherers)) {
+    }
+
+    std::size_t ItemsCount() const override {
+        return items_.size();
+    }
+
+    Item GetItem(std::size_t idx) const override {
+        return items_[idx];
+    }
+
+    std::size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+
+    Gatherer GetGatherer(std::size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Gatherer> gatherers_;
+};
+
+bool SameValue(double lhs, double rhs) {
+    if (std::isnan(lhs) || std::isnan(rhs)) {
+        return std::isnan(lhs) && std::isnan(rhs);
+    }
+    return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+}
+
+} // namespace
+
+SCENARIO("Batch point collection") {
+    GIVEN("a packed set of random points") {
+        std::mt19937 generator{42};
+        std::uniform_real_distribution<double> coord{-50.0, 50.0};
+
+        // Нечётное количество, чтобы задеть хвосты векторных циклов
+        const std::size_t count = 203;
+        std::vector<double> xs(count), ys(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            xs[i] = coord(generator);
+            ys[i] = coord(generator);
+        }
+
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            WHEN("segments are checked with instruction set " << static_cast<int>(level)) {
+                THEN("results match the single point reference") {
+                    for (int segment = 0; segment < 20; ++segment) {
+                        DogPosition a{coord(generator), coord(generator)};
+                        DogPosition b = segment % 2 ? DogPosition{coord(generator), a.y} : DogPosition{a.x, coord(generator)};
+
+                        std::vector<double> proj_ratios(count), sq_distances(count);
+                        TryCollectPoints(level, a, b, xs, ys, proj_ratios, sq_distances);
+
+                        for (std::size_t i = 0; i < count; ++i) {
+                            CollectionResult expected = TryCollectPoint(a, b, LostObjectPosition{xs[i], ys[i]});
+                            INFO("point " << i);
+                            CHECK(SameValue(proj_ratios[i], expected.proj_ratio));
+                            CHECK(SameValue(sq_distances[i], expected.sq_distance));
+                        }
+                    }
+                }
+            }
+        }
+
+        WHEN("the segment has zero length") {
+            DogPosition a{1.0, 2.0};
+            std::vector<double> proj_ratios(count), sq_distances(count);
+            TryCollectPoints(a, a, xs, ys, proj_ratios, sq_distances);
+
+            THEN("nothing is collected") {
+                for (std::size_t i = 0; i < count; ++i) {
+                    CHECK_FALSE((CollectionResult{sq_distances[i], proj_ratios[i]}.IsCollected(1000.0)));
+                }
+            }
+        }
+    }
+
+    GIVEN("a dog walking along a road with items beside it") {
+        std::vector<double> xs{5.0, 5.0, 12.0, -1.0};
+        std::vector<double> ys{0.2, 0.7, 0.0, 0.0};
+        std::vector<double> proj_ratios(xs.size()), sq_distances(xs.size());
+
+        TryCollectPoints(DogPosition{0.0, 0.0}, DogPosition{10.0, 0.0}, xs, ys, proj_ratios, sq_distances);
+
+        THEN("only items within reach on the way are collected") {
+            CHECK((CollectionResult{sq_distances[0], proj_ratios[0]}.IsCollected(0.3)));
+            CHECK_FALSE((CollectionResult{sq_distances[1], proj_ratios[1]}.IsCollected(0.3)));
+            CHECK_FALSE((CollectionResult{sq_distances[2], proj_ratios[2]}.IsCollected(0.3)));
+            CHECK_FALSE((CollectionResult{sq_distances[3], proj_ratios[3]}.IsCollected(0.3)));
+            CHECK(proj_ratios[0] == 0.5);
+        }
+    }
+}
+
+SCENARIO("Gather events") {
+    GIVEN("two dogs heading for the same item") {
+        // Первая собака начинает дальше от вещи, вторая — ближе
+        TestProvider provider{
+            {Item{5.0, 0.0, 0.0}, Item{8.0, 0.1, 0.25}, Item{20.0, 0.0, 0.0}},
+            {Gatherer{{0.0, 0.0}, {10.0, 0.0}, 0.3},
+             Gatherer{{5.0, -4.0}, {5.0, 1.0}, 0.3},
+             Gatherer{{1.0, 1.0}, {1.0, 1.0}, 0.3}}
+        };
+
+        WHEN("events are found") {
+            auto events = FindGatherEvents(provider);
+
+            THEN("they are sorted by the time of arrival") {
+                REQUIRE(events.size() == 3);
+                CHECK(events[0].gatherer_id == 0);
+                CHECK(events[0].item_id == 0);
+                CHECK(events[0].time == 0.5);
+                CHECK(events[1].gatherer_id == 0);
+                CHECK(events[1].item_id == 1);
+                CHECK(events[2].gatherer_id == 1);
+                CHECK(events[2].item_id == 0);
+                CHECK(events[2].time == 0.8);
+            }
+        }
+    }
+
+    GIVEN("a dog that stops short at a road end and a dog that walks the whole tick") {
+        // Первая упирается в край дороги, пройдя 1.4 из 10, вторая идёт весь тик
+        TestProvider provider{
+            {Item{10.0, 0.0, 0.0}},
+            {Gatherer{{10.0, -1.0}, {10.0, 0.4}, 0.3, 0.14},
+             Gatherer{{5.0, 0.0}, {15.0, 0.0}, 0.3}}
+        };
+
+        WHEN("events are found") {
+            auto events = FindGatherEvents(provider);
+
+            THEN("times are fractions of the tick, so the dog that stopped reaches the item first") {
+                REQUIRE(events.size() == 2);
+                CHECK(events[0].gatherer_id == 0);
+                CHECK(std::abs(events[0].time - 0.1) < 1e-9);
+                CHECK(events[1].gatherer_id == 1);
+                CHECK(events[1].time == 0.5);
+            }
+        }
+    }
+}
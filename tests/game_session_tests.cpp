@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/game_session.h"
+#include "test_maps.h"
+
+#include <cmath>
+
+using namespace std::literals;
+
+SCENARIO("Session state changes") {
+    const Map map = MakeTestMap();
+    GameSession session{&map};
+    Dog& dog = session.AddDog(0, "dog"s);
+    session.AddDog(1, "cat"s);
+
+    GIVEN("a session with two new dogs") {
+        THEN("both are reported as changes since the start") {
+            const auto changes = session.GetChangesSince(0);
+            REQUIRE(changes);
+            CHECK(changes->dogs == std::vector<std::uint64_t>{0, 1});
+            CHECK(changes->lost_objects.empty());
+        }
+
+        WHEN("a tick passes without movement") {
+            session.AdvanceTick();
+
+            THEN("nothing changed after it") {
+                CHECK(session.GetTick() == 1);
+                const auto changes = session.GetChangesSince(1);
+                REQUIRE(changes);
+                CHECK(changes->dogs.empty());
+            }
+
+            AND_WHEN("a dog starts moving and the next tick passes") {
+                dog.SetSpeedAndDirection(DogSpeed{1.0, 0.0}, Direction::EAST);
+                session.MarkDogChanged(0);
+                CHECK(session.GetChangesSince(1)->dogs == std::vector<std::uint64_t>{0});
+
+                session.MoveDogs(1000.0);
+                session.AdvanceTick();
+
+                THEN("only this dog changed in the tick") {
+                    CHECK(session.GetChangesSince(1)->dogs == std::vector<std::uint64_t>{0});
+                    CHECK(session.GetChangesSince(2)->dogs.empty());
+                    CHECK(session.GetChangesSince(0)->dogs == std::vector<std::uint64_t>{0, 1});
+                }
+            }
+        }
+    }
+
+    GIVEN("an idle dog whose retirement time runs out") {
+        session.SetDogRetirementTime(1500.0);
+        session.AdvanceTick();
+        session.MoveDogs(1000.0);
+        session.AdvanceTick();
+
+        THEN("standing dogs are not reported while they wait") {
+            CHECK(session.GetChangesSince(1)->dogs.empty());
+        }
+
+        AND_WHEN("the idle time expires in the next tick") {
+            session.MoveDogs(1000.0);
+            session.AdvanceTick();
+
+            THEN("both retired dogs are reported in this tick only") {
+                CHECK(session.GetChangesSince(1)->dogs == std::vector<std::uint64_t>{0, 1});
+                CHECK(session.GetChangesSince(3)->dogs.empty());
+            }
+        }
+    }
+
+    GIVEN("lost objects added and removed") {
+        const int kept = session.AddLostObject(1.0, 0.0, nullptr);
+        const int removed = session.AddLostObject(2.0, 0.0, nullptr);
+        session.AdvanceTick();
+        session.RemoveLostObject(removed);
+
+        THEN("both are reported, the removal after the tick") {
+            CHECK(session.GetChangesSince(0)->lost_objects.size() == 2);
+            CHECK(session.GetChangesSince(1)->lost_objects == std::vector<int>{removed});
+            CHECK(session.FindLostObject(kept) != nullptr);
+        }
+    }
+
+    GIVEN("a client that is too far behind or ahead") {
+        for (std::size_t i = 0; i <= STATE_CHANGES_TICKS; ++i) {
+            session.AdvanceTick();
+        }
+
+        THEN("changes are not available") {
+            CHECK_FALSE(session.GetChangesSince(0));
+            CHECK(session.GetChangesSince(1));
+            CHECK_FALSE(session.GetChangesSince(session.GetTick() + 1));
+        }
+    }
+
+    GIVEN("cached state snapshots") {
+        session.SetStateSnapshot(std::make_shared<const StateSnapshot>(StateSnapshot{.tick = 0, .body = "{}"s}));
+        session.AddChangesSnapshot(std::make_shared<const StateSnapshot>(StateSnapshot{.tick = 0, .since = 0, .body = "{}"s}));
+
+        THEN("a player action drops them") {
+            CHECK(session.FindChangesSnapshot(0));
+            session.MarkDogChanged(0);
+            CHECK_FALSE(session.GetStateSnapshot());
+            CHECK_FALSE(session.FindChangesSnapshot(0));
+        }
+    }
+}
+
+SCENARIO("Dog travel time") {
+    const Map map = MakeTestMap();
+    GameSession session{&map};
+    Dog& short_dog = session.AddDog(0, "short"s);
+    Dog& long_dog = session.AddDog(1, "long"s);
+    short_dog.SetPosition(DogPosition{99.0, 0.0});
+    long_dog.SetPosition(DogPosition{10.0, 0.0});
+
+    GIVEN("two dogs walking east for a tick with speed 10") {
+        short_dog.SetSpeedAndDirection(DogSpeed{10.0, 0.0}, Direction::EAST);
+        long_dog.SetSpeedAndDirection(DogSpeed{10.0, 0.0}, Direction::EAST);
+        session.MoveDogs(1000.0);
+
+        THEN("the dog that reached the road end walked only part of the tick") {
+            CHECK(std::abs(short_dog.GetPosition().x - 100.4) < 1e-9);
+            CHECK(std::abs(short_dog.GetTravelTime() - 0.14) < 1e-9);
+            CHECK(long_dog.GetPosition().x == 20.0);
+            CHECK(long_dog.GetTravelTime() == 1.0);
+        }
+    }
+}
+
+SCENARIO("Session seats") {
+    const Map map = MakeTestMap();
+    GameSession session{&map};
+
+    GIVEN("a session for two players") {
+        THEN("only two seats can be taken") {
+            CHECK(session.TryTakeSeat(2));
+            CHECK(session.TryTakeSeat(2));
+            CHECK_FALSE(session.TryTakeSeat(2));
+            CHECK(session.GetPlayersCount() == 2);
+
+            AND_THEN("a released seat can be taken again") {
+                session.ReleaseSeat();
+                CHECK(session.GetPlayersCount() == 1);
+                CHECK(session.TryTakeSeat(2));
+                CHECK_FALSE(session.TryTakeSeat(2));
+            }
+        }
+
+        THEN("a restored player takes a seat beyond the limit") {
+            CHECK(session.TryTakeSeat(2));
+            CHECK(session.TryTakeSeat(2));
+            session.TakeSeat();
+            CHECK(session.GetPlayersCount() == 3);
+            CHECK_FALSE(session.TryTakeSeat(2));
+        }
+    }
+
+    GIVEN("a session without a limit") {
+        THEN("seats are always available") {
+            for (int i = 0; i < 100; ++i) {
+                CHECK(session.TryTakeSeat(0));
+            }
+            CHECK(session.GetPlayersCount() == 100);
+        }
+    }
+
+    GIVEN("a seat taken for a joining player") {
+        REQUIRE(session.TryTakeSeat(1));
+
+        WHEN("the join fails") {
+            {
+                SeatGuard seat{&session};
+            }
+
+            THEN("the seat is returned") {
+                CHECK(session.GetPlayersCount() == 0);
+                CHECK(session.TryTakeSeat(1));
+            }
+        }
+
+        WHEN("the join fails with an exception") {
+            try {
+                SeatGuard seat{&session};
+                throw std::runtime_error("join failed");
+            } catch (const std::runtime_error&) {
+            }
+
+            THEN("the seat is returned") {
+                CHECK(session.GetPlayersCount() == 0);
+            }
+        }
+
+        WHEN("the player joins") {
+            {
+                SeatGuard seat{&session};
+                seat.Dismiss();
+            }
+
+            THEN("the seat stays taken") {
+                CHECK(session.GetPlayersCount() == 1);
+                CHECK_FALSE(session.TryTakeSeat(1));
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/metrics.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+SCENARIO("Sharded metrics") {
+    GIVEN("a counter and a histogram written from several threads") {
+        metrics::Registry registry;
+        auto& counter = registry.GetCounter("requests_total", "Requests", {"code"}, {"200"});
+        const std::uint64_t bounds[] = {100, 1000};
+        auto& histogram = registry.GetHistogram("latency_seconds", "Latency", {}, {}, bounds);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&counter, &histogram] {
+                for (int i = 0; i < 1000; ++i) {
+                    counter.Increment();
+                    histogram.Observe(std::uint64_t{i < 500 ? 50u : 5000u});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        THEN("shards add up to the total") {
+            CHECK(counter.GetValue() == 4000);
+            CHECK(&registry.GetCounter("requests_total", "Requests", {"code"}, {"200"}) == &counter);
+
+            const auto snapshot = histogram.Collect();
+            CHECK(snapshot.cumulative == std::vector<std::uint64_t>{2000, 2000, 4000});
+            CHECK(snapshot.count == 4000);
+            CHECK(snapshot.sum_us == 2000 * 50 + 2000 * 5000);
+        }
+
+        THEN("the registry renders Prometheus text format") {
+            const std::string text = registry.Render();
+            CHECK(text.find("# TYPE requests_total counter\n") != std::string::npos);
+            CHECK(text.find("requests_total{code=\"200\"} 4000\n") != std::string::npos);
+            CHECK(text.find("# TYPE latency_seconds histogram\n") != std::string::npos);
+            CHECK(text.find("latency_seconds_bucket{le=\"0.0001\"} 2000\n") != std::string::npos);
+            CHECK(text.find("latency_seconds_bucket{le=\"+Inf\"} 4000\n") != std::string::npos);
+            CHECK(text.find("latency_seconds_count 4000\n") != std::string::npos);
+        }
+    }
+}
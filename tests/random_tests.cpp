@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/random.h"
+
+#include <algorithm>
+#include <vector>
+
+SCENARIO("Seedable random streams") {
+    GIVEN("a fixed seed") {
+        rng::SetSeed(42);
+
+        WHEN("the same stream is created twice") {
+            rng::Xoshiro256 a = rng::MakeStream(rng::StreamId("map1"));
+            rng::Xoshiro256 b = rng::MakeStream(rng::StreamId("map1"));
+            rng::Xoshiro256 c = rng::MakeStream(rng::StreamId("map2"));
+
+            THEN("it repeats the sequence and differs from other streams") {
+                bool differs = false;
+                for (int i = 0; i < 100; ++i) {
+                    const auto value = a();
+                    CHECK(value == b());
+                    differs = differs || value != c();
+                }
+                CHECK(differs);
+            }
+        }
+
+        WHEN("numbers are generated in batches") {
+            rng::Xoshiro256 random = rng::MakeStream(1);
+            std::vector<double> doubles(1000);
+            std::vector<int> ints(1000);
+            random.FillDoubles(doubles, -2.5, 4.0);
+            random.FillInts(ints, 3, 7);
+
+            THEN("they stay within the requested ranges") {
+                CHECK(std::all_of(doubles.begin(), doubles.end(), [](double x) {
+                    return x >= -2.5 && x < 4.0;
+                }));
+                CHECK(std::all_of(ints.begin(), ints.end(), [](int x) {
+                    return x >= 3 && x <= 7;
+                }));
+                CHECK(std::count(ints.begin(), ints.end(), 3) > 0);
+                CHECK(std::count(ints.begin(), ints.end(), 7) > 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/map.h"
+#include "../src/road_graph.h"
+#include "../src/road_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+SCENARIO("Road index") {
+    GIVEN("a map with a cross of roads and a detached road") {
+        std::vector<Road> roads;
+        roads.emplace_back(Road::HORIZONTAL, Point{0, 0}, 40);
+        roads.emplace_back(Road::VERTICAL, Point{20, -10}, 30);
+        roads.emplace_back(Road::HORIZONTAL, Point{100, 100}, 90);
+
+        RoadIndex index;
+        index.Build(roads, map_const::HALF_OF_ROAD);
+
+        auto roads_at = [&index](double x, double y) {
+            std::vector<std::size_t> result;
+            index.ForEachRoadAt(x, y, [&result](std::size_t road_id) {
+                result.push_back(road_id);
+            });
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+
+        THEN("bounds are inflated by half of the road width") {
+            const RoadBounds& bounds = index.GetBounds(2);
+            CHECK(bounds.min_x == 90 - map_const::HALF_OF_ROAD);
+            CHECK(bounds.max_x == 100 + map_const::HALF_OF_ROAD);
+            CHECK(bounds.min_y == 100 - map_const::HALF_OF_ROAD);
+            CHECK(bounds.max_y == 100 + map_const::HALF_OF_ROAD);
+        }
+
+        WHEN("a point lies on a single road") {
+            THEN("only that road is found") {
+                CHECK(roads_at(5.0, 0.4) == std::vector<std::size_t>{0});
+                CHECK(roads_at(20.0, 25.0) == std::vector<std::size_t>{1});
+                CHECK(roads_at(90.0, 100.0) == std::vector<std::size_t>{2});
+            }
+        }
+
+        WHEN("a point lies on a crossroad") {
+            THEN("both roads are found") {
+                CHECK(roads_at(20.3, -0.2) == std::vector<std::size_t>{0, 1});
+            }
+        }
+
+        WHEN("a point lies outside of all roads") {
+            THEN("nothing is found") {
+                CHECK(roads_at(5.0, 0.41).empty());
+                CHECK(roads_at(-100.0, -100.0).empty());
+                CHECK(index.FindRoadAt(50.0, 50.0) == RoadIndex::NO_ROAD);
+            }
+        }
+    }
+}
+
+SCENARIO("Road graph") {
+    GIVEN("an L-shaped street continued by a second horizontal segment") {
+        std::vector<Road> roads;
+        roads.emplace_back(Road::HORIZONTAL, Point{0, 0}, 10);
+        roads.emplace_back(Road::HORIZONTAL, Point{10, 0}, 30);
+        roads.emplace_back(Road::VERTICAL, Point{30, 0}, 20);
+
+        RoadIndex index;
+        index.Build(roads, map_const::HALF_OF_ROAD);
+        RoadGraph graph;
+        graph.Build(index);
+
+        THEN("neighbouring roads are linked through junctions") {
+            REQUIRE(graph.GetLinks(0).size() == 1);
+            CHECK(graph.GetLinks(0)[0].road_id == 1);
+            CHECK(graph.GetLinks(1).size() == 2);
+            CHECK(graph.GetLinks(2).size() == 1);
+        }
+
+        WHEN("a dog walks through several segments in one step") {
+            RoadWalk walk = graph.Walk(index, 0, 2.0, 0.0, 25.0, 0.0);
+            THEN("it ends up on the last segment without stopping") {
+                CHECK(walk.x == 27.0);
+                CHECK(walk.y == 0.0);
+                CHECK(walk.road_id == 1);
+                CHECK_FALSE(walk.stopped);
+            }
+        }
+
+        WHEN("a dog walks past the end of the street") {
+            RoadWalk walk = graph.Walk(index, 0, 2.0, 0.0, 100.0, 0.0);
+            THEN("it stops at the road boundary") {
+                CHECK(walk.x == 30.0 + map_const::HALF_OF_ROAD);
+                CHECK(walk.road_id == 1);
+                CHECK(walk.stopped);
+            }
+        }
+
+        WHEN("a dog walks backwards along the vertical road") {
+            RoadWalk walk = graph.Walk(index, 2, 30.0, 15.0, 0.0, -100.0);
+            THEN("it stops at the upper boundary") {
+                CHECK(walk.x == 30.0);
+                CHECK(walk.y == -map_const::HALF_OF_ROAD);
+                CHECK(walk.stopped);
+            }
+        }
+
+        WHEN("a dog has lost its road") {
+            RoadWalk walk = graph.Walk(index, RoadIndex::NO_ROAD, 5.0, 0.0, -3.0, 0.0);
+            THEN("the road is found through the index") {
+                CHECK(walk.x == 2.0);
+                CHECK(walk.road_id == 0);
+                CHECK_FALSE(walk.stopped);
+            }
+        }
+    }
+}
+
+SCENARIO("Road offices") {
+    GIVEN("a grid map with offices scattered around the roads") {
+        using namespace std::literals;
+        // Целые координаты офисов: с reach 1.5 в списки попадают офисы в одной клетке от дороги, но не в двух
+        const double reach = 1.5;
+        const int step = 10;
+        const int lines = 6;
+        const int length = (lines - 1) * step;
+
+        Map map{Map::Id{"grid"s}, "Grid"s, 1.0, 3};
+        for (int i = 0; i < lines; ++i) {
+            map.AddRoad(Road{Road::HORIZONTAL, Point{0, i * step}, length});
+            map.AddRoad(Road{Road::VERTICAL, Point{i * step, 0}, length});
+        }
+        map.BuildRoadIndex();
+
+        std::mt19937 random{42};
+        std::uniform_int_distribution<int> coord{-3, length + 3};
+        std::uniform_int_distribution<int> offset{-2, 2};
+        for (int i = 0; i < 400; ++i) {
+            map.AddOffice(Office{Office::Id{"o"s + std::to_string(i)}, Point{coord(random), coord(random)},
+                                 Offset{offset(random), offset(random)}});
+        }
+        map.BuildRoadOffices(reach);
+
+        // Офис стоит в точке position - offset, как его видит сбор
+        auto office_point = [&map](std::size_t idx) {
+            const Office& office = map.GetOffices()[idx];
+            return std::pair{static_cast<double>(office.GetPosition().x - office.GetOffset().dx),
+                             static_cast<double>(office.GetPosition().y - office.GetOffset().dy)};
+        };
+        auto distance_to_segment = [](double px, double py, double ax, double ay, double bx, double by) {
+            const double dx = bx - ax;
+            const double dy = by - ay;
+            const double length_sq = dx * dx + dy * dy;
+            const double t = length_sq == 0.0 ? 0.0 : std::clamp(((px - ax) * dx + (py - ay) * dy) / length_sq, 0.0, 1.0);
+            return std::hypot(px - (ax + t * dx), py - (ay + t * dy));
+        };
+        auto listed = [&map](std::size_t road_id, std::size_t office_idx) {
+            const auto offices = map.GetRoadOffices(road_id);
+            return std::any_of(offices.begin(), offices.end(), [office_idx](const Map::RoadOffice& office) {
+                return office.office_idx == office_idx;
+            });
+        };
+
+        THEN("every office within reach of a road is in its list") {
+            REQUIRE(map.HasRoadOffices());
+            std::size_t in_reach = 0;
+            for (std::size_t road_id = 0; road_id < map.GetRoads().size(); ++road_id) {
+                const Road& road = map.GetRoads()[road_id];
+                for (std::size_t i = 0; i < map.GetOffices().size(); ++i) {
+                    const auto [x, y] = office_point(i);
+                    if (distance_to_segment(x, y, road.GetStart().x, road.GetStart().y, road.GetEnd().x, road.GetEnd().y) <= reach) {
+                        ++in_reach;
+                        CHECK(listed(road_id, i));
+                    }
+                }
+            }
+            CHECK(in_reach > 100);
+        }
+
+        THEN("offices found through the roads of a dog path match a brute-force search") {
+            std::uniform_int_distribution<std::size_t> pick_road{0, map.GetRoads().size() - 1};
+            std::uniform_real_distribution<double> lateral{-map_const::HALF_OF_ROAD, map_const::HALF_OF_ROAD};
+            std::uniform_real_distribution<double> along{-map_const::HALF_OF_ROAD, length + map_const::HALF_OF_ROAD};
+            for (int i = 0; i < 1000; ++i) {
+                // Путь собаки за тик лежит внутри одной дороги вместе с её шириной
+                const Road& road = map.GetRoads()[pick_road(random)];
+                const double side = lateral(random);
+                double ax = along(random), ay = along(random), bx = along(random), by = along(random);
+                if (road.IsHorizontal()) {
+                    ay = by = road.GetStart().y + side;
+                } else {
+                    ax = bx = road.GetStart().x + side;
+                }
+
+                std::vector<std::size_t> found;
+                const RoadBounds path{std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by)};
+                map.GetRoadIndex().ForEachRoadInBox(path, [&](std::size_t road_id) {
+                    for (const auto& office : map.GetRoadOffices(road_id)) {
+                        found.push_back(office.office_idx);
+                    }
+                });
+                for (std::size_t office_idx = 0; office_idx < map.GetOffices().size(); ++office_idx) {
+                    const auto [x, y] = office_point(office_idx);
+                    if (distance_to_segment(x, y, ax, ay, bx, by) <= reach) {
+                        CHECK(std::find(found.begin(), found.end(), office_idx) != found.end());
+                    }
+                }
+            }
+        }
+    }
+
+    GIVEN("a map whose road offices are not built") {
+        Map map{Map::Id{"map"}, "Map", 1.0, 3};
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 10});
+        map.BuildRoadIndex();
+
+        THEN("it reports that") {
+            CHECK_FALSE(map.HasRoadOffices());
+            map.BuildRoadOffices(1.0);
+            CHECK(map.HasRoadOffices());
+        }
+    }
+}
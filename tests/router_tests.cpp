@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/router.h"
+
+namespace {
+
+enum class Endpoint {
+    MAPS,
+    MAP,
+    ACTION
+};
+
+constexpr router::Route<Endpoint> ROUTES[] = {
+    {"/api/v1/maps", Endpoint::MAPS},
+    {"/api/v1/maps/:id", Endpoint::MAP},
+    {"/api/v1/game/player/action", Endpoint::ACTION}
+};
+
+static_assert(router::IsUnambiguous(ROUTES));
+
+constexpr router::Route<Endpoint> AMBIGUOUS_ROUTES[] = {
+    {"/api/v1/maps/:id", Endpoint::MAP},
+    {"/api/v1/maps/list", Endpoint::MAPS}
+};
+
+static_assert(!router::IsUnambiguous(AMBIGUOUS_ROUTES));
+
+} // namespace
+
+SCENARIO("Request target parsing") {
+    GIVEN("a target with blank segments and a query") {
+        const router::Target target{"//api/ /v1/maps/?a=1&b=2"};
+
+        THEN("blank segments are skipped and the query is split off") {
+            const auto segments = target.GetSegments();
+            REQUIRE(segments.size() == 3);
+            CHECK(segments[0] == "api");
+            CHECK(segments[2] == "maps");
+            CHECK(target.GetQuery() == "a=1&b=2");
+        }
+    }
+
+    GIVEN("a target with too many segments") {
+        const router::Target target{"/a/b/c/d/e/f/g/h/i"};
+
+        THEN("it is marked and matches no route") {
+            CHECK(target.IsOverflow());
+            CHECK(router::FindRoute(ROUTES, target).route == nullptr);
+        }
+    }
+}
+
+SCENARIO("Route matching") {
+    WHEN("a path has a parameter") {
+        const auto match = router::FindRoute(ROUTES, router::Target{"/api/v1/maps/town?x=1"});
+
+        THEN("the parameter route matches and gets the segment") {
+            REQUIRE(match.route != nullptr);
+            CHECK(match.route->value == Endpoint::MAP);
+            CHECK(match.route->pattern.GetText() == "/api/v1/maps/:id");
+            CHECK(match.params[0] == "town");
+        }
+    }
+
+    WHEN("a path differs in one segment") {
+        THEN("no route matches") {
+            CHECK(router::FindRoute(ROUTES, router::Target{"/api/v1/game/player/move"}).route == nullptr);
+            CHECK(router::FindRoute(ROUTES, router::Target{"/api/v2/maps"}).route == nullptr);
+        }
+    }
+
+    WHEN("methods are checked") {
+        using boost::beast::http::verb;
+        THEN("GET_HEAD and POST rules allow only their methods") {
+            CHECK(router::GET_HEAD.Allows(verb::head));
+            CHECK_FALSE(router::GET_HEAD.Allows(verb::post));
+            CHECK(router::POST.Allows(verb::post));
+            CHECK(router::POST.GetAllow() == "POST");
+        }
+    }
+}
+
+SCENARIO("Query parameters") {
+    GIVEN("a query string") {
+        constexpr std::string_view query = "start=10&maxItems=x&flag";
+
+        THEN("values are found by name without decoding") {
+            CHECK(router::GetQueryParam(query, "start") == "10");
+            CHECK(router::GetQueryParam(query, "flag") == "");
+            CHECK_FALSE(router::GetQueryParam(query, "max").has_value());
+        }
+
+        THEN("numbers must take the whole value") {
+            CHECK(router::ParseNumber<int>("10") == 10);
+            CHECK_FALSE(router::ParseNumber<int>("x").has_value());
+            CHECK_FALSE(router::ParseNumber<int>("10x").has_value());
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/model.h"
+#include "../src/request_handler.h"
+#include "test_maps.h"
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/unordered_map.hpp>
+
+#include <sstream>
+
+using namespace std::literals;
+
+namespace {
+
+// Сохранённое состояние в формате версии 0: одна сессия на карту
+struct LegacySerializationObj {
+    template<class Archive>
+    void serialize(Archive& ar, [[maybe_unused]] const unsigned int version) {
+        ar & lost_objects;
+        ar & tokens_dog;
+    }
+
+    std::unordered_map<std::string, std::unordered_map<int, LostObjectRepr>> lost_objects;
+    std::unordered_map<std::string, std::unordered_map<std::string, DogRepr>> tokens_dog;
+};
+
+} // namespace
+
+SCENARIO("Session instances") {
+    GIVEN("a game with two seats per session") {
+        model::Game game;
+        game.AddMap(MakeTestMap());
+        game.SetMaxPlayersPerSession(2);
+
+        WHEN("the first instance is full") {
+            GameSession* first = game.FindJoinableSession("map"s);
+            REQUIRE(first);
+            CHECK(game.FindJoinableSession("map"s) == first);
+            GameSession* second = game.FindJoinableSession("map"s);
+
+            THEN("a new instance is opened with the seat taken") {
+                REQUIRE(second);
+                CHECK(second != first);
+                CHECK(first->GetInstance() == 0);
+                CHECK(second->GetInstance() == 1);
+                CHECK(first->GetPlayersCount() == 2);
+                CHECK(second->GetPlayersCount() == 1);
+                CHECK(game.GetSessions()->size() == 2);
+            }
+
+            AND_WHEN("a seat in the first instance is released") {
+                first->ReleaseSeat();
+
+                THEN("the next player goes there") {
+                    CHECK(game.FindJoinableSession("map"s) == first);
+                }
+            }
+        }
+
+        THEN("an unknown map has no session") {
+            CHECK(game.FindJoinableSession("unknown"s) == nullptr);
+        }
+    }
+
+    GIVEN("a map without road office lists") {
+        model::Game game;
+        Map map{Map::Id{"map"s}, "Map"s, 1.0, 3};
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 100});
+        map.BuildRoadIndex();
+
+        THEN("the game rejects it") {
+            CHECK_THROWS_AS(game.AddMap(map), std::logic_error);
+            CHECK(game.FindMap(Map::Id{"map"s}) == nullptr);
+        }
+    }
+}
+
+SCENARIO("Saved state format") {
+    GIVEN("a state saved before session instances") {
+        const Map map = MakeTestMap();
+        GameSession session{&map};
+        Dog& dog = session.AddDog(7, "dog"s);
+        dog.SetPosition(DogPosition{5.0, 0.0});
+
+        LegacySerializationObj legacy;
+        legacy.lost_objects["map"s][3] = LostObjectRepr{LostObjectPosition{1.0, 0.0}, 0};
+        legacy.tokens_dog["map"s].emplace("token"s, DogRepr{dog});
+
+        std::stringstream file;
+        {
+            boost::archive::text_oarchive oa{file};
+            oa << legacy;
+        }
+
+        WHEN("it is loaded by the current version") {
+            http_handler::SerializationObj state;
+            boost::archive::text_iarchive ia{file};
+            ia >> state;
+
+            THEN("everything goes to instance 0 of the map") {
+                REQUIRE(state.sessions.size() == 1);
+                const auto& instances = state.sessions.at("map"s);
+                REQUIRE(instances.size() == 1);
+                CHECK(instances[0].lost_objects.size() == 1);
+                CHECK(instances[0].lost_objects.at(3).pos.x == 1.0);
+                REQUIRE(instances[0].tokens_dog.size() == 1);
+                CHECK(instances[0].tokens_dog.at("token"s).GetId() == 7);
+                CHECK(instances[0].tokens_dog.at("token"s).GetName() == "dog"s);
+            }
+        }
+    }
+
+    GIVEN("a state with several instances") {
+        http_handler::SerializationObj saved;
+        saved.SessionInstance("map"s, 1).lost_objects[5] = LostObjectRepr{LostObjectPosition{2.0, 0.0}, 0};
+
+        std::stringstream file;
+        {
+            boost::archive::text_oarchive oa{file};
+            oa << saved;
+        }
+        http_handler::SerializationObj loaded;
+        boost::archive::text_iarchive ia{file};
+        ia >> loaded;
+
+        THEN("instances keep their numbers") {
+            const auto& instances = loaded.sessions.at("map"s);
+            REQUIRE(instances.size() == 2);
+            CHECK(instances[0].lost_objects.empty());
+            CHECK(instances[1].lost_objects.at(5).pos.x == 2.0);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/metrics.h"
+#include "../src/sim_scheduler.h"
+
+#include <atomic>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+
+SCENARIO("Fixed step timeline") {
+    GIVEN("a timeline with 10 ms step and at most 3 catch-up steps") {
+        FixedStepTimeline timeline{10ms, 3};
+        const auto start = FixedStepTimeline::Clock::time_point{} + 1s;
+        timeline.Start(start);
+        REQUIRE(timeline.GetNextDeadline() == start + 10ms);
+
+        WHEN("the scheduler wakes up before the deadline") {
+            THEN("no steps are due") {
+                CHECK(timeline.TakeDueSteps(start + 9ms) == 0);
+                CHECK(timeline.GetNextDeadline() == start + 10ms);
+            }
+        }
+
+        WHEN("the scheduler wakes up a little late") {
+            const unsigned due = timeline.TakeDueSteps(start + 13ms);
+
+            THEN("one step is due and the next deadline stays on the timeline") {
+                CHECK(due == 1);
+                CHECK(timeline.GetNextDeadline() == start + 20ms);
+                CHECK(timeline.GetStats().last_lag == 3.0);
+                CHECK(timeline.GetStats().catch_up_wakeups == 0);
+            }
+        }
+
+        WHEN("several steps were missed") {
+            const unsigned due = timeline.TakeDueSteps(start + 35ms);
+
+            THEN("they are caught up") {
+                CHECK(due == 3);
+                CHECK(timeline.GetNextDeadline() == start + 40ms);
+                CHECK(timeline.GetStats().catch_up_wakeups == 1);
+                CHECK(timeline.GetStats().dropped_steps == 0);
+            }
+        }
+
+        WHEN("more steps were missed than the catch-up limit") {
+            const unsigned due = timeline.TakeDueSteps(start + 75ms);
+
+            THEN("the excess is dropped and the timeline moves past now") {
+                CHECK(due == 3);
+                CHECK(timeline.GetStats().dropped_steps == 4);
+                CHECK(timeline.GetNextDeadline() == start + 80ms);
+            }
+        }
+
+        WHEN("steps are finished") {
+            timeline.OnStepFinished(4ms);
+            timeline.OnStepFinished(12ms);
+
+            THEN("their cost and overruns are accounted") {
+                const TickStats& stats = timeline.GetStats();
+                CHECK(stats.steps == 2);
+                CHECK(stats.overrun_steps == 1);
+                CHECK(stats.last_step_cost == 12.0);
+                CHECK(stats.max_step_cost == 12.0);
+                CHECK(stats.total_step_cost == 16.0);
+            }
+        }
+    }
+}
+
+SCENARIO("Simulation scheduler") {
+    GIVEN("a scheduler running on its own thread") {
+        std::atomic<int> steps = 0;
+        std::atomic<bool> wrong_step = false;
+        SimScheduler scheduler{5ms, 2, [&](std::chrono::milliseconds step) {
+            if (step != 5ms) {
+                wrong_step = true;
+            }
+            ++steps;
+            std::promise<void> done;
+            done.set_value();
+            return done.get_future();
+        }};
+
+        WHEN("it runs for a while and is stopped") {
+            scheduler.Start();
+            std::this_thread::sleep_for(60ms);
+            scheduler.Stop();
+            const int stopped_at = steps;
+
+            THEN("steps were executed with fixed length and stop after Stop") {
+                CHECK(stopped_at > 0);
+                CHECK(!wrong_step);
+                CHECK(scheduler.GetStats().steps == static_cast<std::uint64_t>(stopped_at));
+                std::this_thread::sleep_for(20ms);
+                CHECK(steps == stopped_at);
+            }
+        }
+    }
+}
+
+SCENARIO("Failing simulation steps") {
+    GIVEN("a scheduler whose steps fail") {
+        metrics::Counter& failures = metrics::GetRegistry().GetCounter("game_task_failures_total",
+            "Simulation steps and session tasks that ended with an exception", {"task"}, {"step"});
+        const std::uint64_t failures_before = failures.GetValue();
+        std::atomic<int> steps = 0;
+        SimScheduler scheduler{5ms, 2, [&](std::chrono::milliseconds) {
+            ++steps;
+            std::promise<void> done;
+            done.set_exception(std::make_exception_ptr(std::runtime_error("step failed")));
+            return done.get_future();
+        }};
+
+        WHEN("it runs for a while") {
+            scheduler.Start();
+            std::this_thread::sleep_for(60ms);
+            scheduler.Stop();
+
+            THEN("it keeps stepping and counts every failure") {
+                CHECK(steps > 1);
+                CHECK(failures.GetValue() - failures_before == static_cast<std::uint64_t>(steps.load()));
+            }
+        }
+    }
+}
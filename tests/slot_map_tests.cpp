@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/slot_map.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+SCENARIO("Slot map") {
+    GIVEN("a slot map with several values") {
+        SlotMap<std::string> map;
+        const int a = map.Insert("a");
+        const int b = map.Insert("b");
+        const int c = map.Insert("c");
+        REQUIRE(map.Size() == 3);
+        REQUIRE(*map.Find(b) == "b");
+
+        WHEN("a value is erased") {
+            REQUIRE(map.Erase(a));
+
+            THEN("the remaining values stay dense and keep their ids") {
+                CHECK(map.Size() == 2);
+                CHECK(map.Find(a) == nullptr);
+                CHECK(*map.Find(b) == "b");
+                CHECK(*map.Find(c) == "c");
+                CHECK(map.Values().size() == 2);
+                for (const auto& [id, value] : map) {
+                    CHECK(*map.Find(id) == value);
+                }
+            }
+
+            AND_WHEN("a new value reuses the freed slot") {
+                const int d = map.Insert("d");
+
+                THEN("it gets a new id and the old id stays invalid") {
+                    CHECK(d != a);
+                    CHECK(map.Find(a) == nullptr);
+                    CHECK(*map.Find(d) == "d");
+                    CHECK(!map.Erase(a));
+                }
+            }
+        }
+
+        WHEN("values are inserted and erased many times") {
+            for (int i = 0; i < 1000; ++i) {
+                map.Erase(map.Insert("tmp"));
+            }
+
+            THEN("the storage does not grow") {
+                CHECK(map.Size() == 3);
+                CHECK(map.SlotCount() == 4);
+                CHECK(map.Insert("e") >= 0);
+                CHECK(map.Ids().size() == 4);
+                CHECK(map.SlotCount() == 4);
+            }
+        }
+
+        WHEN("batches of values are inserted and erased many times") {
+            std::vector<int> batch;
+            int max_slot = 0;
+            for (int round = 0; round < 200; ++round) {
+                for (int i = 0; i < 10; ++i) {
+                    batch.push_back(map.Insert("tmp"));
+                }
+                for (const int id : map.Ids()) {
+                    max_slot = std::max(max_slot, id & static_cast<int>(SlotMap<std::string>::MAX_SLOTS - 1));
+                }
+                for (const int id : batch) {
+                    REQUIRE(map.Erase(id));
+                }
+                batch.clear();
+            }
+
+            THEN("slots are reused: the highest slot index is bounded by the peak number of live values") {
+                CHECK(map.Size() == 3);
+                CHECK(map.SlotCount() == 13);
+                CHECK(max_slot == 12);
+            }
+        }
+
+        WHEN("values are restored with saved ids") {
+            SlotMap<std::string> restored;
+            REQUIRE(restored.InsertWithId(c, "c"));
+            REQUIRE(restored.InsertWithId(a, "a"));
+
+            THEN("they are found by those ids and new ids do not collide") {
+                CHECK(*restored.Find(a) == "a");
+                CHECK(*restored.Find(c) == "c");
+                const int e = restored.Insert("e");
+                CHECK(e != a);
+                CHECK(e != c);
+                CHECK(restored.Size() == 3);
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/spatial_grid.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<int> FindNear(const SpatialGrid& grid, double x0, double y0, double x1, double y1, double radius) {
+    std::vector<int> result;
+    grid.ForEachNearSegment(x0, y0, x1, y1, radius, [&result](const SpatialGrid::Item& item) {
+        result.push_back(item.id);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+SCENARIO("Spatial grid") {
+    GIVEN("a grid with 10x10 cells") {
+        SpatialGrid grid{10.0};
+
+        THEN("an empty grid finds nothing") {
+            CHECK(grid.Size() == 0);
+            CHECK(FindNear(grid, -100.0, -100.0, 100.0, 100.0, 1.0).empty());
+        }
+
+        WHEN("items are inserted into different cells") {
+            grid.Insert(1, 5.0, 5.0);
+            grid.Insert(2, 15.0, 5.0);
+            grid.Insert(3, 55.0, 55.0);
+
+            THEN("a query finds the items of the cells it touches") {
+                CHECK(grid.Size() == 3);
+                CHECK(FindNear(grid, 4.0, 4.0, 6.0, 6.0, 0.0) == std::vector<int>{1});
+                CHECK(FindNear(grid, 50.0, 50.0, 51.0, 51.0, 0.0) == std::vector<int>{3});
+            }
+
+            THEN("a segment crossing a cell border finds items on both sides") {
+                CHECK(FindNear(grid, 8.0, 5.0, 12.0, 5.0, 0.0) == std::vector<int>{1, 2});
+                CHECK(FindNear(grid, 0.0, 5.0, 60.0, 5.0, 0.0) == std::vector<int>{1, 2});
+            }
+
+            THEN("the radius extends the query into neighbouring cells") {
+                CHECK(FindNear(grid, 9.0, 5.0, 9.0, 5.0, 0.5) == std::vector<int>{1});
+                CHECK(FindNear(grid, 9.0, 5.0, 9.0, 5.0, 1.5) == std::vector<int>{1, 2});
+            }
+
+            AND_WHEN("an item is removed") {
+                REQUIRE(grid.Remove(2, 15.0, 5.0));
+
+                THEN("it is no longer found") {
+                    CHECK(grid.Size() == 2);
+                    CHECK(FindNear(grid, 0.0, 5.0, 20.0, 5.0, 0.0) == std::vector<int>{1});
+                }
+
+                THEN("it cannot be removed again") {
+                    CHECK_FALSE(grid.Remove(2, 15.0, 5.0));
+                    CHECK(grid.Size() == 2);
+                }
+            }
+
+            AND_WHEN("an item is removed with a position from another cell") {
+                THEN("it is not found there and stays in the grid") {
+                    CHECK_FALSE(grid.Remove(1, 15.0, 5.0));
+                    CHECK_FALSE(grid.Remove(1, 100.0, 100.0));
+                    CHECK(grid.Size() == 3);
+                    CHECK(FindNear(grid, 5.0, 5.0, 5.0, 5.0, 0.0) == std::vector<int>{1});
+                }
+            }
+
+            AND_WHEN("the grid is cleared") {
+                grid.Clear();
+
+                THEN("it is empty") {
+                    CHECK(grid.Size() == 0);
+                    CHECK(FindNear(grid, 0.0, 0.0, 60.0, 60.0, 0.0).empty());
+                }
+            }
+        }
+
+        WHEN("items lie exactly on cell borders") {
+            grid.Insert(1, 10.0, 0.0);
+            grid.Insert(2, 0.0, 10.0);
+            grid.Insert(3, 10.0, 10.0);
+
+            THEN("each belongs to the cell that starts at the border") {
+                CHECK(FindNear(grid, 10.0, 0.0, 10.0, 0.0, 0.0) == std::vector<int>{1});
+                CHECK(FindNear(grid, 5.0, 5.0, 9.9, 9.9, 0.0).empty());
+                CHECK(FindNear(grid, 10.0, 10.0, 19.0, 19.0, 0.0) == std::vector<int>{3});
+            }
+
+            THEN("a query ending at the border reaches them") {
+                CHECK(FindNear(grid, 5.0, 5.0, 10.0, 10.0, 0.0) == std::vector<int>{1, 2, 3});
+            }
+
+            THEN("they are removed by the same position") {
+                CHECK(grid.Remove(1, 10.0, 0.0));
+                CHECK(grid.Remove(3, 10.0, 10.0));
+                CHECK(FindNear(grid, 0.0, 0.0, 20.0, 20.0, 0.0) == std::vector<int>{2});
+            }
+        }
+
+        WHEN("items have negative coordinates") {
+            grid.Insert(1, -0.5, -0.5);
+            grid.Insert(2, 0.5, 0.5);
+            grid.Insert(3, -10.0, -15.0);
+            grid.Insert(4, -25.0, 5.0);
+
+            THEN("cells left of and below zero are separate from the ones after it") {
+                CHECK(FindNear(grid, -1.0, -1.0, -0.1, -0.1, 0.0) == std::vector<int>{1});
+                CHECK(FindNear(grid, 0.1, 0.1, 1.0, 1.0, 0.0) == std::vector<int>{2});
+                CHECK(FindNear(grid, -0.5, -0.5, 0.5, 0.5, 0.0) == std::vector<int>{1, 2});
+            }
+
+            THEN("far negative cells are found and do not collide with positive ones") {
+                CHECK(FindNear(grid, -10.0, -15.0, -10.0, -15.0, 0.0) == std::vector<int>{3});
+                CHECK(FindNear(grid, -21.0, 1.0, -29.0, 9.0, 0.0) == std::vector<int>{4});
+                CHECK(FindNear(grid, 20.0, 0.0, 29.0, 9.0, 0.0).empty());
+            }
+
+            THEN("they can be removed") {
+                CHECK(grid.Remove(3, -10.0, -15.0));
+                CHECK(grid.Remove(4, -25.0, 5.0));
+                CHECK(FindNear(grid, -30.0, -20.0, 0.0, 10.0, 0.0) == std::vector<int>{1, 2});
+            }
+        }
+    }
+
+    GIVEN("random items and queries") {
+        SpatialGrid grid{3.0};
+        std::mt19937 random{5};
+        std::uniform_real_distribution<double> coord{-50.0, 50.0};
+        std::vector<SpatialGrid::Item> items;
+        for (int id = 0; id < 500; ++id) {
+            items.push_back(SpatialGrid::Item{id, coord(random), coord(random)});
+            grid.Insert(id, items.back().x, items.back().y);
+        }
+        // Каждый третий удаляется, чтобы проверить и поиск после удаления
+        for (int id = 0; id < 500; id += 3) {
+            REQUIRE(grid.Remove(id, items[id].x, items[id].y));
+        }
+
+        THEN("every item inside the widened segment box is found") {
+            std::uniform_real_distribution<double> radius{0.0, 4.0};
+            for (int i = 0; i < 200; ++i) {
+                const double x0 = coord(random), y0 = coord(random), x1 = coord(random), y1 = coord(random);
+                const double r = radius(random);
+                const auto found = FindNear(grid, x0, y0, x1, y1, r);
+                for (const auto& item : items) {
+                    const bool inside = item.x >= std::min(x0, x1) - r && item.x <= std::max(x0, x1) + r
+                                        && item.y >= std::min(y0, y1) - r && item.y <= std::max(y0, y1) + r;
+                    const bool removed = item.id % 3 == 0;
+                    const bool reported = std::binary_search(found.begin(), found.end(), item.id);
+                    if (removed) {
+                        CHECK_FALSE(reported);
+                    } else if (inside) {
+                        CHECK(reported);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/static_bundle.h"
+#include "../src/static_cache.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void WriteFile(const fs::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+} // namespace
+
+SCENARIO("Static file bundle") {
+    const fs::path dir = fs::temp_directory_path() / ("static_bundle_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    const fs::path root = dir / "www";
+    const fs::path bundle_file = dir / "static.bundle";
+    fs::create_directories(root / "js");
+    const std::string page = "<html></html>";
+    const std::string script(20000, 'a');
+    WriteFile(root / "index.html", page);
+    WriteFile(root / "js" / "app.js", script);
+    WriteFile(root / "js" / "Logo.PNG", "png");
+
+    GIVEN("a bundle packed from the directory") {
+        static_bundle::Pack(root, bundle_file);
+        const auto bundle = static_bundle::Bundle::Open(bundle_file);
+
+        THEN("every file is found by its key") {
+            CHECK(bundle->GetCount() == 3);
+
+            const auto index = bundle->Find("index.html");
+            REQUIRE(index);
+            CHECK(index->content == page);
+            CHECK(index->content_type == "text/html");
+            CHECK(index->etag == static_cache::MakeEtag(page));
+            CHECK(index->gzip.empty());
+
+            const auto image = bundle->Find("js/Logo.PNG");
+            REQUIRE(image);
+            CHECK(image->content_type == "image/png");
+        }
+
+        THEN("compressible files carry a gzip variant with its own ETag") {
+            const auto app = bundle->Find("js/app.js");
+            REQUIRE(app);
+            CHECK(app->content == script);
+            CHECK_FALSE(app->gzip.empty());
+            CHECK(app->gzip.size() < script.size());
+            CHECK(app->gzip_etag != app->etag);
+        }
+
+        THEN("unknown keys and directories are not found") {
+            CHECK_FALSE(bundle->Find("js"));
+            CHECK_FALSE(bundle->Find("missing.html"));
+            CHECK_FALSE(bundle->Find(""));
+        }
+    }
+
+    GIVEN("a damaged bundle") {
+        static_bundle::Pack(root, bundle_file);
+        fs::resize_file(bundle_file, fs::file_size(bundle_file) - 1);
+
+        THEN("it is rejected on open") {
+            CHECK_THROWS_AS(static_bundle::Bundle::Open(bundle_file), std::runtime_error);
+        }
+    }
+
+    fs::remove_all(dir);
+}
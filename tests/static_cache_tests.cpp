@@ -0,0 +1,166 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/request_handler.h"
+#include "../src/static_cache.h"
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string Gunzip(const std::string& data) {
+    namespace io = boost::iostreams;
+    std::istringstream input(data);
+    io::filtering_istream stream;
+    stream.push(io::gzip_decompressor());
+    stream.push(input);
+    std::string result;
+    io::copy(stream, io::back_inserter(result));
+    return result;
+}
+
+void WriteFile(const fs::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+} // namespace
+
+SCENARIO("Conditional request headers") {
+    const std::string etag = static_cache::MakeEtag("hello");
+
+    THEN("the ETag is strong, quoted and depends on content") {
+        CHECK(etag.front() == '"');
+        CHECK(etag.back() == '"');
+        CHECK(etag == static_cache::MakeEtag("hello"));
+        CHECK(etag != static_cache::MakeEtag("hello!"));
+    }
+
+    THEN("If-None-Match lists are compared weakly") {
+        CHECK(static_cache::MatchesEtag(etag, etag));
+        CHECK(static_cache::MatchesEtag("\"other\", W/" + etag, etag));
+        CHECK(static_cache::MatchesEtag("*", etag));
+        CHECK_FALSE(static_cache::MatchesEtag("\"other\"", etag));
+    }
+
+    THEN("gzip is accepted unless refused with q=0") {
+        CHECK(static_cache::AcceptsGzip("gzip, deflate, br"));
+        CHECK(static_cache::AcceptsGzip("br;q=1.0, gzip;q=0.8"));
+        CHECK_FALSE(static_cache::AcceptsGzip("gzip;q=0, br"));
+        CHECK_FALSE(static_cache::AcceptsGzip("deflate"));
+    }
+}
+
+SCENARIO("Static file cache") {
+    const fs::path root = fs::temp_directory_path() / ("static_cache_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::remove_all(root);
+    fs::create_directories(root / "js");
+    const std::string script(20000, 'a');
+    WriteFile(root / "js" / "app.js", script);
+
+    GIVEN("a cache over the directory") {
+        static_cache::StaticCache cache{root, {}};
+
+        WHEN("a file is loaded") {
+            auto entry = cache.Load("js/app.js", root / "js" / "app.js", "text/javascript");
+            REQUIRE(entry);
+
+            THEN("it is found by key with a compressed variant") {
+                CHECK(cache.Find("js/app.js") == entry);
+                CHECK(*entry->content == script);
+                REQUIRE(entry->gzip);
+                CHECK(Gunzip(*entry->gzip) == script);
+                CHECK(entry->gzip_etag != entry->etag);
+                CHECK(cache.GetSize() == script.size() + entry->gzip->size());
+            }
+
+            THEN("invalidating its directory drops it") {
+                cache.InvalidateDirectory("js");
+                CHECK_FALSE(cache.Find("js/app.js"));
+                CHECK(cache.GetSize() == 0);
+            }
+        }
+
+        WHEN("a file is larger than the cache") {
+            static_cache::StaticCache small{root, {.max_size = 100, .max_file_size = 100}};
+
+            THEN("it is not cached") {
+                CHECK_FALSE(small.Load("js/app.js", root / "js" / "app.js", "text/javascript"));
+                CHECK_FALSE(small.Find("js/app.js"));
+            }
+        }
+
+#ifdef __linux__
+        WHEN("a watched file changes on disk") {
+            cache.StartWatching();
+            REQUIRE(cache.Load("js/app.js", root / "js" / "app.js", "text/javascript"));
+            WriteFile(root / "js" / "app.js", "changed");
+
+            THEN("it is dropped from the cache") {
+                bool dropped = false;
+                for (int i = 0; i < 100 && !dropped; ++i) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    dropped = !cache.Find("js/app.js");
+                }
+                CHECK(dropped);
+            }
+        }
+#endif
+    }
+
+    fs::remove_all(root);
+}
+
+SCENARIO("Directory index pages from the static cache") {
+    namespace http = http_handler::http;
+    const fs::path root = fs::temp_directory_path() / ("static_index_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::remove_all(root);
+    fs::create_directories(root / "docs");
+    const std::string root_page = "<html>" + std::string(5000, 'r') + "</html>";
+    const std::string docs_page = "<html>" + std::string(5000, 'd') + "</html>";
+    WriteFile(root / "index.html", root_page);
+    WriteFile(root / "docs" / "index.html", docs_page);
+
+    GIVEN("a file handler with the cache enabled") {
+        http_handler::FileHandler files;
+        files.EnableCache(root, {});
+        std::string root_path = root.string();
+        auto request = [&files, &root_path](std::string target, bool gzip) {
+            http_handler::StringRequest req{http::verb::get, target, 11};
+            if (gzip) {
+                req.set(http::field::accept_encoding, "gzip");
+            }
+            return std::get<http_handler::CachedResponse>(files(http::status::ok, root_path, target, req));
+        };
+
+        THEN("the root and a directory without a trailing slash get their index.html from the cache") {
+            for (const auto& [target, page] : {std::pair{std::string("/"), root_page}, std::pair{std::string("/docs"), docs_page}}) {
+                INFO("target: " << target);
+                const auto plain = request(target, false);
+                CHECK(*plain.body() == page);
+                CHECK(plain[http::field::etag] == static_cache::MakeEtag(page));
+                CHECK(plain[http::field::content_type] == "text/html");
+
+                // Повторный запрос отдаёт тот же буфер кэша, файл заново не читается
+                CHECK(request(target, false).body().get() == plain.body().get());
+
+                const auto zipped = request(target, true);
+                CHECK(zipped[http::field::content_encoding] == "gzip");
+                CHECK(Gunzip(*zipped.body()) == page);
+                CHECK(zipped[http::field::etag] != plain[http::field::etag]);
+                CHECK(request(target, true).body().get() == zipped.body().get());
+            }
+        }
+    }
+
+    fs::remove_all(root);
+}
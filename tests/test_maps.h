@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../src/model.h"
+
+#include <string>
+
+// Карта тестов сессий и API: одна горизонтальная дорога длиной 100 из (0, 0), без офисов
+inline Map MakeTestMap() {
+    using namespace std::literals;
+    Map map{Map::Id{"map"s}, "Map"s, 1.0, 3};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 100});
+    map.BuildIndexes(model::OFFICE_REACH);
+    return map;
+}
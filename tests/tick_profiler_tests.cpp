@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/tick_profiler.h"
+
+SCENARIO("Duration histogram") {
+    GIVEN("a histogram of tick durations") {
+        DurationHistogram histogram;
+        for (int i = 0; i < 98; ++i) {
+            histogram.Record(0.25);
+        }
+        histogram.Record(5.0);
+        histogram.Record(40.0);
+
+        THEN("count, mean and max are exact") {
+            CHECK(histogram.GetCount() == 100);
+            CHECK(histogram.GetMax() == 40.0);
+            CHECK(histogram.GetSum() == 98 * 0.25 + 45.0);
+        }
+
+        THEN("percentiles are upper bounds of buckets holding the rank") {
+            const double p50 = histogram.GetPercentile(0.5);
+            CHECK(p50 >= 0.25);
+            CHECK(p50 < 0.5);
+            const double p99 = histogram.GetPercentile(0.99);
+            CHECK(p99 >= 5.0);
+            CHECK(p99 < 10.0);
+            CHECK(histogram.GetPercentile(1.0) == 40.0);
+        }
+    }
+}
+
+SCENARIO("Rolling histogram") {
+    GIVEN("records spread over epochs") {
+        RollingHistogram rolling;
+        for (std::uint64_t epoch = 0; epoch < 20; ++epoch) {
+            rolling.Record(static_cast<double>(epoch + 1), epoch);
+        }
+
+        THEN("the window holds only the last SLOTS epochs") {
+            const DurationHistogram window = rolling.GetWindow(19);
+            CHECK(window.GetCount() == RollingHistogram::SLOTS);
+            CHECK(window.GetMax() == 20.0);
+        }
+
+        WHEN("time moves past the records") {
+            THEN("old epochs fall out of the window") {
+                CHECK(rolling.GetWindow(19 + RollingHistogram::SLOTS).GetCount() == 0);
+            }
+        }
+    }
+}
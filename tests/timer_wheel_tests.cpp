@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/timer_wheel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+SCENARIO("Timer wheel") {
+    GIVEN("a wheel with timers on different levels") {
+        TimerWheel wheel;
+        wheel.Schedule(0, 10.0);
+        wheel.Schedule(1, 10.5);
+        wheel.Schedule(2, 5000.0);
+        wheel.Schedule(3, 60000.0);
+        REQUIRE(wheel.Size() == 4);
+
+        std::vector<std::uint32_t> fired;
+        auto collect = [&fired](std::uint32_t id) {
+            fired.push_back(id);
+        };
+
+        WHEN("time advances up to the first deadline") {
+            wheel.Advance(10.0, collect);
+
+            THEN("only that timer fires") {
+                CHECK(fired == std::vector<std::uint32_t>{0});
+                CHECK(!wheel.IsScheduled(0));
+                CHECK(wheel.IsScheduled(1));
+            }
+        }
+
+        WHEN("a timer is cancelled or rescheduled") {
+            wheel.Cancel(2);
+            wheel.Schedule(3, 20.0);
+            wheel.Advance(100000.0, collect);
+
+            THEN("the cancelled one never fires and the rescheduled one fires at its new deadline") {
+                CHECK(fired == std::vector<std::uint32_t>{0, 1, 3});
+                CHECK(wheel.Size() == 0);
+            }
+        }
+
+        WHEN("time advances in small steps past far deadlines") {
+            for (double now = 0.0; now <= 60000.0; now += 50.0) {
+                wheel.Advance(now, collect);
+            }
+
+            THEN("every timer fires once and in deadline order") {
+                CHECK(fired == std::vector<std::uint32_t>{0, 1, 2, 3});
+            }
+        }
+
+        WHEN("a timer is scheduled in the past") {
+            wheel.Advance(1000.0, collect);
+            fired.clear();
+            wheel.Schedule(4, 500.0);
+            wheel.Advance(1001.0, collect);
+
+            THEN("it fires on the next step") {
+                CHECK(fired == std::vector<std::uint32_t>{4});
+            }
+        }
+    }
+}
+
+SCENARIO("Timer wheel jumps over empty slots") {
+    GIVEN("timers with random deadlines on every level") {
+        TimerWheel wheel;
+        std::mt19937 random{7};
+        std::uniform_real_distribution<double> deadline{0.0, 300000.0};
+        std::vector<double> deadlines(2000);
+        for (std::uint32_t id = 0; id < deadlines.size(); ++id) {
+            deadlines[id] = deadline(random);
+            wheel.Schedule(id, deadlines[id]);
+        }
+
+        WHEN("time advances in uneven steps") {
+            std::vector<double> fired_at(deadlines.size(), -1.0);
+            std::uniform_real_distribution<double> step{0.0, 5000.0};
+            double previous = 0.0;
+            bool early = false;
+            bool late = false;
+            for (double now = 0.0; now <= 310000.0; now += step(random)) {
+                wheel.Advance(now, [&](std::uint32_t id) {
+                    fired_at[id] = now;
+                    // Таймер срабатывает на первом продвижении, которое дошло до его срока
+                    early = early || std::ceil(deadlines[id]) > std::floor(now);
+                    late = late || std::ceil(deadlines[id]) <= std::floor(previous);
+                });
+                previous = now;
+            }
+
+            THEN("each timer fires exactly in the advance that reaches its deadline") {
+                CHECK(wheel.Size() == 0);
+                CHECK(std::find(fired_at.begin(), fired_at.end(), -1.0) == fired_at.end());
+                CHECK_FALSE(early);
+                CHECK_FALSE(late);
+            }
+        }
+    }
+}
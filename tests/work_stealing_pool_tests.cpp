@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/work_stealing_pool.h"
+
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+SCENARIO("Work stealing pool") {
+    GIVEN("a pool with several threads") {
+        WorkStealingPool pool{4};
+        REQUIRE(pool.GetThreadsCount() == 4);
+
+        WHEN("a range is processed in chunks") {
+            std::vector<int> visits(10007, 0);
+            std::atomic<int> chunks = 0;
+            // Проверки Catch2 не потокобезопасны: в потоках пула только запоминаем наибольший кусок
+            std::atomic<std::size_t> max_chunk = 0;
+            pool.ParallelFor(visits.size(), 64, [&](std::size_t begin, std::size_t end) {
+                std::size_t seen = max_chunk.load();
+                while (end - begin > seen && !max_chunk.compare_exchange_weak(seen, end - begin)) {
+                }
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+                ++chunks;
+            });
+
+            THEN("every index is visited exactly once") {
+                CHECK(std::accumulate(visits.begin(), visits.end(), 0) == 10007);
+                CHECK(std::count(visits.begin(), visits.end(), 1) == 10007);
+                CHECK(chunks == 157);
+                CHECK(max_chunk == 64);
+            }
+        }
+
+        WHEN("many short jobs are run from several threads at once") {
+            const int CALLERS = 4;
+            const int ROUNDS = 3000;
+            std::atomic<std::size_t> total = 0;
+            std::vector<std::jthread> callers;
+            for (int c = 0; c < CALLERS; ++c) {
+                callers.emplace_back([&pool, &total] {
+                    for (int round = 0; round < ROUNDS; ++round) {
+                        pool.ParallelFor(8, 1, [&total](std::size_t begin, std::size_t end) {
+                            total += end - begin;
+                        });
+                    }
+                });
+            }
+            callers.clear();
+
+            THEN("every job completes with all of its chunks") {
+                CHECK(total == static_cast<std::size_t>(CALLERS) * ROUNDS * 8);
+            }
+        }
+
+        WHEN("a chunk throws") {
+            THEN("the exception reaches the caller and the pool stays usable") {
+                CHECK_THROWS_AS(pool.ParallelFor(1000, 10, [](std::size_t begin, std::size_t) {
+                    if (begin == 500) {
+                        throw std::runtime_error("chunk failed");
+                    }
+                }), std::runtime_error);
+
+                std::atomic<std::size_t> total = 0;
+                pool.ParallelFor(1000, 10, [&](std::size_t begin, std::size_t end) {
+                    total += end - begin;
+                });
+                CHECK(total == 1000);
+            }
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#include "../src/static_bundle.h"
+
+#include <cstdlib>
+#include <iostream>
+
+/*
+ *  Собирает пакет статических файлов для запуска сервера с --www-bundle:
+ *      pack_static <www-root> <bundle-file>
+ *  Из CMake вызывается целью static_bundle.
+ */
+
+int main(int argc, const char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: pack_static <www-root> <bundle-file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        static_bundle::Pack(argv[1], argv[2]);
+        std::cout << "Packed " << static_bundle::Bundle::Open(argv[2])->GetCount() << " files into " << argv[2] << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}